@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <Graph.h>
+#include <Parsing.h>
+#include <Metrics.h>
+#include <Z3Tools.h>
+#include <ColouredGraph.h>
+#include <ColouringReduction.h>
+#include <ColouringResolution.h>
+
+void usage()
+{
+    printf("Usage: cg_bench [-k COLOURS] [-f FAILURES] file...\n");
+    printf(" Solves the colouring of the graphs given with the reduction, and prints one line per graph: whether it can be coloured, the time spent building the formula and the time spent solving it.\n");
+    printf(" -k COLOURS   Number of colours [if not present: 3].\n");
+    printf(" -f FAILURES  Also solves, for each graph, the variants without one of its first FAILURES edges, and those without the edges of one of its first FAILURES nodes, derived from the graph without copying it. Each variant is also solved with the brute force, and the lines where the reduction finds another answer are marked.\n");
+}
+
+/**
+ * @brief Solves the colouring of @p graph with @p numColours colours with the reduction.
+ *
+ * @param graph The graph.
+ * @param numColours The number of colours.
+ * @param formulaTime Returns the time spent building the formula.
+ * @param solveTime Returns the time spent solving it.
+ * @return Z3_lbool The answer of the solver.
+ */
+Z3_lbool bench_graph(ColouredGraph graph, int numColours, double *formulaTime, double *solveTime)
+{
+    Z3_context ctx = make_context();
+    double start = metrics_now();
+    Z3_ast formula = colouring_reduction(ctx, graph, numColours);
+    double built = metrics_now();
+    Z3_model model;
+    Z3_lbool isSat = solve_formula(ctx, formula, &model);
+    *formulaTime = built - start;
+    *solveTime = metrics_now() - built;
+    Z3_del_context(ctx);
+    return isSat;
+}
+
+int main(int argc, char *argv[])
+{
+    int numColours = 3;
+    int failures = 0;
+
+    int option;
+    while ((option = getopt(argc, argv, "hk:f:")) != -1)
+    {
+        switch (option)
+        {
+        case 'k':
+            numColours = atoi(optarg);
+            break;
+        case 'f':
+            failures = atoi(optarg);
+            break;
+        default:
+            usage();
+            return 0;
+        }
+    }
+    if (optind >= argc || numColours < 1)
+    {
+        usage();
+        return 0;
+    }
+
+    metrics_init();
+    printf("%-32s %6s %10s %10s\n", "graph", "colour", "formula", "solve");
+    int numDisagreements = 0;
+    for (int file = optind; file < argc; file++)
+    {
+        Graph graph = get_graph_from_file(argv[file]);
+        ColouredGraph coloured = cg_initialize(graph);
+        int numNodes = cg_get_num_nodes(coloured);
+
+        // The graph itself, then its edge and node failure variants.
+        ColouredGraph variants[1 + 2 * failures];
+        char labels[1 + 2 * failures][64];
+        int numVariants = 1;
+        variants[0] = coloured;
+        snprintf(labels[0], sizeof(labels[0]), "%s", graph_get_name(graph));
+        int numEdges = 0;
+        for (int node = 0; node < numNodes && numEdges < failures; node++)
+        {
+            int numSuccessors;
+            const int *successors = graph_get_successors(graph, node, &numSuccessors);
+            for (int i = 0; i < numSuccessors && successors[i] < node && numEdges < failures; i++, numEdges++)
+            {
+                variants[numVariants] = cg_derive(coloured);
+                cg_remove_edge(variants[numVariants], node, successors[i]);
+                snprintf(labels[numVariants++], sizeof(labels[0]), "%s-%s-%s", graph_get_name(graph), cg_get_node_name(coloured, node), cg_get_node_name(coloured, successors[i]));
+            }
+        }
+        for (int node = 0; node < numNodes && node < failures; node++)
+        {
+            variants[numVariants] = cg_derive(coloured);
+            cg_remove_node(variants[numVariants], node);
+            snprintf(labels[numVariants++], sizeof(labels[0]), "%s-%s", graph_get_name(graph), cg_get_node_name(coloured, node));
+        }
+
+        for (int variant = 0; variant < numVariants; variant++)
+        {
+            bool bruteColourable = failures > 0 && colouring_brute_force(variants[variant], numColours);
+            double formulaTime, solveTime;
+            Z3_lbool isSat = bench_graph(variants[variant], numColours, &formulaTime, &solveTime);
+            bool disagrees = failures > 0 && isSat != (bruteColourable ? Z3_L_TRUE : Z3_L_FALSE);
+            numDisagreements += disagrees;
+            printf("%-32s %6s %10.4f %10.4f", labels[variant], isSat == Z3_L_TRUE ? "yes" : isSat == Z3_L_FALSE ? "no" : "?", formulaTime, solveTime);
+            if (disagrees)
+                printf(" (brute force: %s)", bruteColourable ? "yes" : "no");
+            printf("\n");
+        }
+        for (int variant = 1; variant < numVariants; variant++)
+            cg_delete(variants[variant]);
+        cg_delete(coloured);
+        graph_delete(graph);
+    }
+    if (failures > 0)
+        printf("%d answers differ from the brute force\n", numDisagreements);
+    return 0;
+}
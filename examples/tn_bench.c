@@ -0,0 +1,264 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <Graph.h>
+#include <Parsing.h>
+#include <Metrics.h>
+#include <Z3Tools.h>
+#include <TunnelNetwork.h>
+#include <TunnelReduction.h>
+#include <TunnelBF.h>
+#include <TunnelPropagator.h>
+#include <TunnelCubes.h>
+
+void usage()
+{
+    printf("Usage: tn_bench [-c BOUND] [-e ENCODING]... [-l] [-p] [-s] [-w BUDGET] [-t] [-j THREADS] [-f FAILURES] file...\n");
+    printf(" Solves the tunnel networks given with the reduction, for each stack encoding, and prints one line per network and encoding: the length of the shortest path found (0 if none), the time spent building and solving the formulas of all the lengths tried, and the time spent solving the last one.\n");
+    printf(" -c BOUND     Tries the lengths 1 to BOUND [if not present: 10].\n");
+    printf(" -e ENCODING  Benchmarks this stack encoding (\"boolean\", \"bitvector\", \"nested\" or \"finite\"), can be repeated [if not present: all of them].\n");
+    printf(" -l           Leaves the simple path constraint out of the formulas, and enforces it with a propagator during the search (see --lazy-simple, only for the encodings supported).\n");
+    printf(" -p           Prunes the states and prefixes which cannot reach the final state in time with a propagator (see --prune-reach, only for the encodings supported).\n");
+    printf(" -s           Solves with the solver which keeps the SAT core when checked with assumptions (see make_hinted_solver), instead of the default one (without -l and -p, which need the simple solver).\n");
+    printf(" -w BUDGET    Gives the solver of each length a hint found by a brute force expanding at most BUDGET states (see --warm-start), counted in the solving time. The solver is not changed: the default one is slow with hints, so compare -s -w BUDGET with -s alone.\n");
+    printf(" -t           With -w, takes a hint of the whole length as the path found, and solves no formula for this length (see --hint-path).\n");
+    printf(" -j THREADS   Solves each length with cube-and-conquer on THREADS threads (see --cubes): the formulas are then built by the threads, and their time is counted in the solving time.\n");
+    printf(" -f FAILURES  Also solves, for each network, the variants without one of its first FAILURES links, those without one of its first FAILURES nodes (other than the initial and final ones), and those where one of its first FAILURES nodes loses its first action, derived from the network without copying it. Each variant is also solved with the brute force, and the lines where the reduction finds another length are marked.\n");
+}
+
+/**
+ * @brief Solves @p network with the reduction for the lengths 1 to @p bound, until a path is found.
+ *
+ * @param network The network.
+ * @param bound The maximal length.
+ * @param encoding The stack encoding.
+ * @param checks The tn_propagation flags of the propagator attached to the solver (none if 0).
+ * @param satCore Solves with the solver of make_hinted_solver instead of Z3_mk_solver (without a propagator).
+ * @param warmBudget The budget of the brute force finding the hints of the solver (no hints if 0).
+ * @param hintPath Takes a hint of the whole length as the path found, without solving the formula.
+ * @param numThreads The number of threads of the cube-and-conquer search of each length (none if 0).
+ * @param formulaTime Returns the time spent building the formulas.
+ * @param solveTime Returns the time spent solving them.
+ * @param lastTime Returns the time spent solving the last one.
+ * @param valid Returns false if the path decoded is not valid.
+ * @return int The length of the path found, 0 if there is none.
+ */
+int bench_network(TunnelNetwork network, int bound, tn_stack_encoding encoding, unsigned checks, bool satCore, long warmBudget, bool hintPath, int numThreads, double *formulaTime, double *solveTime, double *lastTime, bool *valid)
+{
+    Z3_context ctx = make_rc_context();
+    tn_step path[bound + 1];
+    int found = 0;
+    *formulaTime = 0;
+    *solveTime = 0;
+    *valid = true;
+
+    for (int length = 1; length <= bound && found == 0; length++)
+    {
+        if (numThreads > 0)
+        {
+            double start = metrics_now();
+            Z3_lbool isSat = tn_solve_cubes(network, length, encoding, checks, numThreads, path, NULL);
+            *lastTime = metrics_now() - start;
+            *solveTime += *lastTime;
+            if (isSat == Z3_L_TRUE)
+            {
+                found = length;
+                *valid = tn_validate_path(network, path, length);
+            }
+            continue;
+        }
+
+        double start = metrics_now();
+        tn_step hint[length];
+        int hintLength = warmBudget > 0 ? tn_brute_force_hint(network, length, warmBudget, hint) : 0;
+        double hintTime = metrics_now() - start;
+        if (hintPath && hintLength == length)
+        {
+            // A hint of the whole length is a path, checked step by step by the brute force: there is nothing left to solve.
+            *lastTime = hintTime;
+            *solveTime += *lastTime;
+            found = length;
+            for (int step = 0; step < length; step++)
+                path[step] = hint[step];
+            *valid = tn_validate_path(network, path, length);
+            continue;
+        }
+
+        Z3_model model = NULL;
+        Z3_solver solver = checks != 0 ? Z3_mk_simple_solver(ctx) : satCore ? make_hinted_solver(ctx, encoding != tn_finite_domain) : Z3_mk_solver(ctx);
+        Z3_solver_inc_ref(ctx, solver);
+        tn_propagator propagator = checks != 0 ? tn_propagator_attach(ctx, solver, network, length, encoding, checks) : NULL;
+        start = metrics_now();
+        tn_assert_reduction(ctx, solver, network, length, encoding, (checks & tn_propagate_simple) ? 1u << tn_simple : 0, NULL);
+        double built = metrics_now();
+        Z3_ast hints[length + 1];
+        int numHints = tn_hint_literals(ctx, hint, hintLength, encoding, hints);
+        Z3_lbool isSat = check_solver_with_hints(ctx, solver, numHints, hints, TnHintConflicts, &model, NULL);
+        for (int hint = 0; hint < numHints; hint++)
+            Z3_dec_ref(ctx, hints[hint]);
+        Z3_solver_dec_ref(ctx, solver);
+        if (propagator != NULL)
+            tn_propagator_delete(propagator);
+        *formulaTime += built - start;
+        *lastTime = metrics_now() - built + hintTime;
+        *solveTime += *lastTime;
+
+        if (isSat == Z3_L_TRUE)
+        {
+            found = length;
+            tn_get_path_from_model(ctx, model, network, length, encoding, path);
+            *valid = tn_validate_path(network, path, length);
+        }
+        if (model != NULL)
+            Z3_model_dec_ref(ctx, model);
+    }
+
+    Z3_del_context(ctx);
+    return found;
+}
+
+int main(int argc, char *argv[])
+{
+    int bound = 10;
+    tn_stack_encoding encodings[NumStackEncodings];
+    int numEncodings = 0;
+    unsigned checks = 0;
+    bool satCore = false;
+    long warmBudget = 0;
+    bool hintPath = false;
+    int numThreads = 0;
+    int failures = 0;
+
+    int option;
+    while ((option = getopt(argc, argv, "hc:e:lpsw:tj:f:")) != -1)
+    {
+        switch (option)
+        {
+        case 'c':
+            bound = atoi(optarg);
+            break;
+        case 'e':
+        {
+            tn_stack_encoding encoding;
+            bool repeated = false;
+            if (!tn_stack_encoding_of_name(optarg, &encoding))
+            {
+                printf("unknown encoding: %s\n", optarg);
+                break;
+            }
+            for (int i = 0; i < numEncodings; i++)
+                repeated |= encodings[i] == encoding;
+            if (repeated)
+                printf("repeated encoding: %s\n", optarg);
+            else
+                encodings[numEncodings++] = encoding;
+            break;
+        }
+        case 'l':
+            checks |= tn_propagate_simple;
+            break;
+        case 'p':
+            checks |= tn_propagate_reachability;
+            break;
+        case 's':
+            satCore = true;
+            break;
+        case 'w':
+            warmBudget = atol(optarg);
+            break;
+        case 't':
+            hintPath = true;
+            break;
+        case 'j':
+            numThreads = atoi(optarg);
+            break;
+        case 'f':
+            failures = atoi(optarg);
+            break;
+        default:
+            usage();
+            return 0;
+        }
+    }
+    if (optind >= argc || bound < 1)
+    {
+        usage();
+        return 0;
+    }
+    if (numEncodings == 0)
+        for (tn_stack_encoding encoding = 0; encoding < NumStackEncodings; encoding++)
+            encodings[numEncodings++] = encoding;
+
+    metrics_init();
+    printf("%-24s %-10s %6s %10s %10s %10s\n", "network", "encoding", "length", "formula", "solve", "last");
+    int numDisagreements = 0;
+    for (int file = optind; file < argc; file++)
+    {
+        Graph graph = get_graph_from_file(argv[file]);
+        TunnelNetwork network = tn_initialize(graph);
+        int numNodes = tn_get_num_nodes(network);
+
+        // The network itself, then its link failure, node failure and action change variants.
+        TunnelNetwork variants[1 + 3 * failures];
+        char labels[1 + 3 * failures][64];
+        int numVariants = 1;
+        variants[0] = network;
+        snprintf(labels[0], sizeof(labels[0]), "%s", tn_get_name(network));
+        int numLinks = 0;
+        for (int node = 0; node < numNodes && numLinks < failures; node++)
+        {
+            int numSuccessors;
+            const int *successors = tn_get_successors(network, node, &numSuccessors);
+            for (int i = 0; i < numSuccessors && numLinks < failures; i++, numLinks++)
+            {
+                variants[numVariants] = tn_derive(network);
+                tn_remove_edge(variants[numVariants], node, successors[i]);
+                snprintf(labels[numVariants++], sizeof(labels[0]), "%s-%s>%s", tn_get_name(network), tn_get_node_name(network, node), tn_get_node_name(network, successors[i]));
+            }
+        }
+        for (int node = 0, numRemoved = 0; node < numNodes && numRemoved < failures; node++)
+            if (node != tn_get_initial(network) && node != tn_get_final(network))
+            {
+                variants[numVariants] = tn_derive(network);
+                tn_remove_node(variants[numVariants], node);
+                snprintf(labels[numVariants++], sizeof(labels[0]), "%s-%s", tn_get_name(network), tn_get_node_name(network, node));
+                numRemoved++;
+            }
+        for (int node = 0, numChanged = 0; node < numNodes && numChanged < failures; node++)
+            for (stack_action action = 0; action < NumActions; action++)
+                if (tn_node_has_action(network, node, action))
+                {
+                    variants[numVariants] = tn_derive(network);
+                    tn_set_node_action(variants[numVariants], node, action, false);
+                    snprintf(labels[numVariants++], sizeof(labels[0]), "%s-%s/%s", tn_get_name(network), tn_get_node_name(network, node), tn_string_of_stack_action(action));
+                    numChanged++;
+                    break;
+                }
+
+        for (int variant = 0; variant < numVariants; variant++)
+        {
+            tn_step path[bound];
+            int bruteLength = failures > 0 ? tn_brute_force(variants[variant], bound, path) : 0;
+            for (int i = 0; i < numEncodings; i++)
+            {
+                double formulaTime, solveTime, lastTime;
+                bool valid;
+                int found = bench_network(variants[variant], bound, encodings[i], tn_propagator_supports(encodings[i]) ? checks : 0, satCore, warmBudget, hintPath, numThreads, &formulaTime, &solveTime, &lastTime, &valid);
+                bool disagrees = failures > 0 && found != bruteLength;
+                numDisagreements += disagrees;
+                printf("%-24s %-10s %6d %10.4f %10.4f %10.4f%s", labels[variant], tn_stack_encoding_name(encodings[i]), found, formulaTime, solveTime, lastTime, valid ? "" : " (invalid path)");
+                if (disagrees)
+                    printf(" (brute force: %d)", bruteLength);
+                printf("\n");
+            }
+        }
+        for (int variant = 1; variant < numVariants; variant++)
+            tn_delete(variants[variant]);
+        tn_delete(network);
+        graph_delete(graph);
+    }
+    if (failures > 0)
+        printf("%d lengths differ from the brute force\n", numDisagreements);
+    return 0;
+}
@@ -0,0 +1,43 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <Graph.h>
+#include <Parsing.h>
+#include <TunnelNetwork.h>
+
+void usage()
+{
+    printf("Usage: tn_convert file.dot [file.tnb]\n");
+    printf(" Converts the tunnel network described by file.dot into the binary format read by graphProblemSolver (written in file.tnb, or in the name of file.dot with extension .tnb if absent).\n");
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        usage();
+        return 0;
+    }
+
+    int length = strlen(argv[1]) + 5;
+    char defaultOutput[length];
+    snprintf(defaultOutput, length, "%s", argv[1]);
+    char *extension = strrchr(defaultOutput, '.');
+    if (extension != NULL && strchr(extension, '/') == NULL)
+        *extension = '\0';
+    strcat(defaultOutput, ".tnb");
+    char *output = argc > 2 ? argv[2] : defaultOutput;
+
+    Graph graph = get_graph_from_file(argv[1]);
+    TunnelNetwork network = tn_initialize(graph);
+
+    bool ok = tn_save_binary(network, output);
+    if (ok)
+        printf("Network %s (%d nodes, %d edges) written in %s.\n", tn_get_name(network), tn_get_num_nodes(network), tn_get_num_edges(network), output);
+    else
+        printf("Cannot write %s.\n", output);
+
+    tn_delete(network);
+    graph_delete(graph);
+    return ok ? 0 : 1;
+}
@@ -14,6 +14,7 @@
 
 #include <stdbool.h>
 #include "Graph.h"
+#include "BitMatrix.h"
 
 /**
  * @brief The struct containing a graph, and a colour for each node.
@@ -31,6 +32,32 @@ typedef struct ColouredGraph_s *ColouredGraph;
  */
 ColouredGraph cg_initialize(Graph graph);
 
+/**
+ * @brief Creates a variant of @p graph, to modify with cg_remove_node and cg_remove_edge without changing @p graph. The variant starts with the colours of @p graph.
+ * The Graph is shared, not copied: only the removed nodes and edges are stored, and the solvers read the variant as any ColouredGraph (cg_print still displays the shared Graph).
+ *
+ * @param graph A ColouredGraph.
+ * @return ColouredGraph The variant, to deallocate with cg_delete (its Graph must be deallocated after it).
+ */
+ColouredGraph cg_derive(ColouredGraph graph);
+
+/**
+ * @brief Removes all the edges of @p node in @p graph (the node keeps its number, and still has to be coloured).
+ *
+ * @param graph A ColouredGraph.
+ * @param node A node.
+ */
+void cg_remove_node(ColouredGraph graph, int node);
+
+/**
+ * @brief Removes the edge between @p source and @p target in @p graph, if it is an edge (in both directions).
+ *
+ * @param graph A ColouredGraph.
+ * @param source A node.
+ * @param target A node.
+ */
+void cg_remove_edge(ColouredGraph graph, int source, int target);
+
 /**
  * @brief Printer function to display information about @p graph in input.
  *
@@ -79,6 +106,14 @@ int cg_get_num_edges(ColouredGraph graph);
  */
 bool cg_is_edge(ColouredGraph graph, int source, int target);
 
+/**
+ * @brief Builds the adjacency matrix of @p graph, as a matrix of bits (cell (u,v) is set iff cg_is_edge(@p graph,u,v)). It takes N²/8 bytes for N nodes.
+ *
+ * @param graph A ColouredGraph.
+ * @return BitMatrix Its adjacency matrix, to deallocate with bit_matrix_delete.
+ */
+BitMatrix cg_get_adjacency_matrix(ColouredGraph graph);
+
 /**
  * @brief Gets the name of @p node in @p graph. The name is what appears in the .dot file, while its number is local to this program.
  *
@@ -0,0 +1,31 @@
+/**
+ * @file TunnelAStar.h
+ * @brief Best-first search of the Tunnel Network Routing problem. Partial paths are expanded by increasing g + h, where g is their length and h is a lower bound of the number of steps left: the largest of the distance to the final node and of the height of the stack (each step removes at most one cell, and the stack must end with only 4).
+ *        Since h never overestimates, the first complete path taken from the queue is a shortest one, and all the lengths up to the bound are handled by a single search.
+ * @version 1
+ * @date 2026-10-18
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef TUNNEL_ASTAR_H
+#define TUNNEL_ASTAR_H
+
+#include "TunnelNetwork.h"
+
+/**
+ * @brief Decides if there is a valid simple path of length at most @p length in @p network, with the same contract as tn_brute_force (the path found is a shortest one, but not necessarily the one tn_brute_force finds).
+ * Lengths whose stacks do not fit in a tn_packed_stack are delegated to tn_brute_force.
+ *
+ * @param network The network.
+ * @param length The max length of the path sought
+ * @param path Array to return a path if one is found.
+ * @return int The length of the path found. Returns 0 if no path has been found.
+ * @pre @p path must be an array of size at least @p length.
+ * @pre @p network must be an initialized TunnelNetwork.
+ * @post @p path contains the path found from cell 0 to returned value -1.
+ */
+int tn_astar_search(TunnelNetwork network, int length, tn_step *path);
+
+#endif
@@ -14,6 +14,30 @@
 
 #include "TunnelNetwork.h"
 
+/**
+ * @brief Counters describing the exploration performed by the last call to tn_brute_force.
+ * They are only gathered when the program is compiled with TN_BF_STATS defined (make BF_STATS=1), so that the search pays nothing for them otherwise (all counters then stay at 0).
+ *
+ */
+typedef struct
+{
+    long nodes_expanded;    ///< Number of search states whose successors have been explored.
+    long actions_tried;     ///< Number of (successor, action) pairs tried.
+    long actions_rejected;  ///< Number of actions rejected because the stack did not allow them.
+    long visited_prunes;    ///< Number of successors skipped because already on the current path.
+    int max_depth;          ///< Maximal path position reached.
+    int max_stack_height;   ///< Maximal stack height reached.
+    int num_lengths;        ///< Number of lengths explored.
+    double *length_seconds; ///< Exploration time of each length (cell i for length i+1).
+} tn_bf_stats;
+
+/**
+ * @brief Returns the counters of the last call to tn_brute_force. The returned structure is owned by the brute force and overwritten by the next call.
+ *
+ * @return const tn_bf_stats* The counters.
+ */
+const tn_bf_stats *tn_brute_force_stats(void);
+
 /**
  * @brief Brute force that decides if there is a valid simple path of length at most @p length in @p network. If there is such a path, it will be present in @p path after the call, otherwise, path is not modified.
  *
@@ -27,4 +51,18 @@
  */
 int tn_brute_force(TunnelNetwork network, int length, tn_step *path);
 
+/**
+ * @brief Bounded brute force looking for a valid simple path of exactly @p length steps, to hint a solver (see --warm-start). It only follows the steps after which the final node can still be reached in time (by its distance and by the height of the stack), and stops after expanding @p budget states.
+ * If no path is found, @p path holds the longest valid simple prefix met: the best partial path.
+ *
+ * @param network The network.
+ * @param length The length of the path sought.
+ * @param budget The maximal number of states expanded.
+ * @param path Array to return the path or prefix found.
+ * @return int @p length if a path has been found, otherwise the length of the prefix in @p path (0 if none).
+ * @pre @p path must be an array of size at least @p length.
+ * @pre @p network must be an initialized TunnelNetwork.
+ */
+int tn_brute_force_hint(TunnelNetwork network, int length, long budget, tn_step *path);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,32 @@
+/**
+ * @file TunnelBidir.h
+ * @brief Meet-in-the-middle search of the Tunnel Network Routing problem. For a length L, the simple paths of ceil(L/2) steps from the initial state (initial node, stack 4) are stored in a hash table by their last state (node, stack).
+ *        The last floor(L/2) steps are then enumerated backward from the final state, following the edges in reverse and undoing the actions, and each state reached is joined with the table. Two halves form a solution when they visit disjoint nodes.
+ *        This explores about 2·b^(L/2) partial paths instead of b^L, at the price of the memory of the first halves.
+ * @version 1
+ * @date 2026-10-18
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef TUNNEL_BIDIR_H
+#define TUNNEL_BIDIR_H
+
+#include "TunnelNetwork.h"
+
+/**
+ * @brief Decides if there is a valid simple path of length at most @p length in @p network, with the same contract as tn_brute_force (the path found is a shortest one, but not necessarily the one tn_brute_force finds).
+ * Lengths whose stacks do not fit in a tn_packed_stack are delegated to tn_brute_force.
+ *
+ * @param network The network.
+ * @param length The max length of the path sought
+ * @param path Array to return a path if one is found.
+ * @return int The length of the path found. Returns 0 if no path has been found.
+ * @pre @p path must be an array of size at least @p length.
+ * @pre @p network must be an initialized TunnelNetwork.
+ * @post @p path contains the path found from cell 0 to returned value -1.
+ */
+int tn_bidir_search(TunnelNetwork network, int length, tn_step *path);
+
+#endif
@@ -0,0 +1,46 @@
+/**
+ * @file TunnelCubes.h
+ * @brief Cube-and-conquer solving of the Tunnel reduction on several threads. The search space of a length is split on the node at the middle position of the path (one cube per node). Each worker thread builds the formula in its own Z3 context, then solves cubes as assumptions until there are none left: the first model found ends the search, and the formula is unsatisfiable once every cube is refuted.
+ * @version 1
+ * @date 2026-10-18
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef TUNNEL_CUBES_H
+#define TUNNEL_CUBES_H
+
+#include "TunnelNetwork.h"
+#include "TunnelReduction.h"
+#include <z3.h>
+
+/**
+ * @brief What a cube-and-conquer search did.
+ *
+ */
+typedef struct
+{
+    int num_cubes;   ///< The number of cubes (the number of nodes).
+    int num_refuted; ///< The number of cubes shown unsatisfiable.
+    int num_workers; ///< The number of threads started.
+} tn_cube_stats;
+
+/**
+ * @brief Decides with cube-and-conquer on @p num_threads threads whether there is a path of length @p length in @p network.
+ * Each thread has its own context, solver and formula (built by tn_assert_reduction), and, if @p checks is not 0, its own propagator (see TunnelPropagator.h). When a thread finds a model, the checks of the others are interrupted.
+ *
+ * @param network A Tunnel Network.
+ * @param length The size of the target path.
+ * @param encoding The encoding of the stack.
+ * @param checks The tn_propagation flags of the propagator attached to the solver of each thread (none if 0).
+ * @param num_threads The number of threads (at most one per cube, at least one: the calling thread also solves cubes).
+ * @param path Array to return the path found.
+ * @param stats The statistics to fill. If NULL, nothing is returned.
+ * @return Z3_lbool Z3_L_TRUE if there is such a path (it is then in @p path), Z3_L_FALSE if there is none, and Z3_L_UNDEF if a cube could not be decided.
+ * @pre @p path must be an array of size at least @p length.
+ * @pre If @p checks is not 0, @p encoding must be supported by the propagator (see tn_propagator_supports).
+ */
+Z3_lbool tn_solve_cubes(const TunnelNetwork network, int length, tn_stack_encoding encoding, unsigned checks, int num_threads, tn_step *path, tn_cube_stats *stats);
+
+#endif
@@ -0,0 +1,31 @@
+/**
+ * @file TunnelFrontier.h
+ * @brief Exact search of the Tunnel Network Routing problem by levels. All the states (node, stack) reachable at a path position are computed at once: for each content of the stack, the reachable nodes are a bitset, and a whole level is advanced with word-wide operations on the adjacency matrix.
+ *        The levels only describe walks. A walk ending in the final node with the initial stack is then refined into a simple path by a search restricted to the states which lie on such a walk.
+ * @version 1
+ * @date 2026-10-18
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef TUNNEL_FRONTIER_H
+#define TUNNEL_FRONTIER_H
+
+#include "TunnelNetwork.h"
+
+/**
+ * @brief Decides if there is a valid simple path of length at most @p length in @p network, with the same contract as tn_brute_force (the path found is a shortest one).
+ * Networks too large for an adjacency matrix (more than 16384 nodes), and lengths whose stacks do not fit in 64 bits, are delegated to tn_brute_force.
+ *
+ * @param network The network.
+ * @param length The max length of the path sought
+ * @param path Array to return a path if one is found.
+ * @return int The length of the path found. Returns 0 if no path has been found.
+ * @pre @p path must be an array of size at least @p length.
+ * @pre @p network must be an initialized TunnelNetwork.
+ * @post @p path contains the path found from cell 0 to returned value -1.
+ */
+int tn_frontier_search(TunnelNetwork network, int length, tn_step *path);
+
+#endif
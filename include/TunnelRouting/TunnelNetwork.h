@@ -13,6 +13,7 @@
 #define COCA_TUNNEL_NETWORK_H
 
 #include "Graph.h"
+#include <stdint.h>
 
 /**
  * @brief The struct containing the network (an oriented graph, whose nodes can perform stack action, with initial and final nodes of the problem).
@@ -44,6 +45,114 @@ typedef enum
  */
 #define NumActions 10
 
+/**
+ * @brief Contents of a cell of the stack. symbol_none stands for the cell below the bottom of the stack (when the stack has height 0).
+ *
+ */
+typedef enum
+{
+    symbol_4,
+    symbol_6,
+    symbol_none
+} stack_symbol;
+
+/**
+ * @brief Number of symbols that can be stored in the stack (symbol_none excluded).
+ *
+ */
+#define NumStackSymbols 2
+
+/**
+ * @brief The rule of an action: the top it requires, the cell it requires below (symbol_none if it does not read it), its effect on the height, and the top it leaves.
+ *
+ */
+typedef struct
+{
+    stack_symbol top;     ///< The symbol required on top of the stack.
+    stack_symbol below;   ///< The symbol required just below the top (symbol_none if any content is accepted).
+    int height_delta;     ///< Variation of the height of the stack (-1, 0 or 1).
+    stack_symbol new_top; ///< The symbol on top of the stack after the action.
+} tn_action_rule;
+
+/**
+ * @brief Result of applying an action to a stack, given its top and the cell below.
+ *
+ */
+typedef struct
+{
+    bool valid;           ///< True if the action can be applied.
+    int height_delta;     ///< Variation of the height of the stack.
+    stack_symbol new_top; ///< The symbol on top of the stack after the action (the pushed symbol, or the uncovered one).
+} tn_transition;
+
+/**
+ * @brief The rule of each action. This is the only description of the semantics of the actions: every solver reads it, directly or through tn_transition_table.
+ *
+ */
+extern const tn_action_rule tn_action_rules[NumActions];
+
+/**
+ * @brief The transitions of the stack, indexed by action, top of the stack and cell below the top (symbol_none if the stack has height 0). Computed at compile time from the same rules as tn_action_rules.
+ *
+ */
+extern const tn_transition tn_transition_table[NumActions][NumStackSymbols][NumStackSymbols + 1];
+
+/**
+ * @brief A stack packed in an integer, for the solvers storing many stacks: the cells 1 to height (bit 1 for a 6), below a leading 1 bit marking the height.
+ * The cell 0 is not stored, since it always holds 4 (no action can pop or rewrite it): the initial stack is TnInitialStack. Stacks of at most TnMaxPackedHeight cells above the bottom fit.
+ *
+ */
+typedef uint64_t tn_packed_stack;
+
+#define TnInitialStack ((tn_packed_stack)1)
+#define TnMaxPackedHeight 63
+
+/**
+ * @brief Returns the height of @p stack (0 for the initial stack).
+ *
+ * @param stack A packed stack.
+ * @return int
+ */
+int tn_packed_height(tn_packed_stack stack);
+
+/**
+ * @brief Returns the symbol on top of @p stack.
+ *
+ * @param stack A packed stack.
+ * @return stack_symbol
+ */
+stack_symbol tn_packed_top(tn_packed_stack stack);
+
+/**
+ * @brief Returns the transition of @p action on @p stack (see tn_transition_table).
+ *
+ * @param stack A packed stack.
+ * @param action An action.
+ * @return const tn_transition*
+ */
+const tn_transition *tn_packed_transition(tn_packed_stack stack, stack_action action);
+
+/**
+ * @brief Returns the stack obtained by applying @p transition to @p stack.
+ *
+ * @param stack A packed stack.
+ * @param transition A valid transition of @p stack.
+ * @return tn_packed_stack
+ * @pre The height of the result must be at most TnMaxPackedHeight.
+ */
+tn_packed_stack tn_packed_apply(tn_packed_stack stack, const tn_transition *transition);
+
+/**
+ * @brief Computes the stack from which @p action leads to @p stack, for the solvers searching backward from the final state.
+ *
+ * @param stack A packed stack, reached by @p action.
+ * @param action An action.
+ * @param previous Returns the stack before @p action.
+ * @return true if @p stack can be reached by @p action (the stack before is then unique).
+ * @pre The height of @p stack must be less than TnMaxPackedHeight.
+ */
+bool tn_packed_unapply(tn_packed_stack stack, stack_action action, tn_packed_stack *previous);
+
 /**
  * @brief Structure to store a step of an execution path over a tunnel network.
  *
@@ -65,13 +174,91 @@ typedef struct tn_step
  */
 TunnelNetwork tn_initialize(Graph graph);
 
+/**
+ * @brief Writes @p network in the binary file @p path (format .tnb), which can then be loaded with tn_load_binary instead of parsing the dot file.
+ * The file contains the names of the network and of its nodes, its adjacency in compressed sparse rows, the action mask of each node and the initial and final nodes.
+ * Integers are written in the byte order of the machine, so the file can only be read on machines with the same byte order (it is rejected otherwise).
+ *
+ * @param network A network.
+ * @param path The name of the file to write.
+ * @return true If the file has been written.
+ * @return false Otherwise.
+ */
+bool tn_save_binary(TunnelNetwork network, const char *path);
+
+/**
+ * @brief Loads a network from the binary file @p path written by tn_save_binary. The file is mapped in memory and used in place: nothing is allocated per node.
+ * The network has no supporting Graph: printing it or writing it in dot only uses its nodes, edges, actions and initial and final nodes.
+ *
+ * @param path The name of a .tnb file.
+ * @return TunnelNetwork The network, or NULL (with a message) if the file cannot be read or is not a valid .tnb file of a supported version.
+ */
+TunnelNetwork tn_load_binary(const char *path);
+
+/**
+ * @brief Tells whether @p path is a binary network file (by checking its header, not its extension).
+ *
+ * @param path The name of a file.
+ * @return true If @p path starts like a .tnb file.
+ * @return false Otherwise (including if it cannot be read, or is not a regular file).
+ */
+bool tn_is_binary_file(const char *path);
+
 /**
  * @brief Deallocates memory used by @p network. Does NOT deallocates the graph.
+ * The memory shared with the networks derived from the same network is freed with the last of them.
  *
  * @param network
  */
 void tn_delete(TunnelNetwork network);
 
+/**
+ * @brief Creates a variant of @p network, to modify with tn_remove_node, tn_remove_edge, tn_set_node_action, tn_set_initial and tn_set_final without changing @p network.
+ * The variant shares the nodes, edges, names and actions of @p network (and its graph, which must be deallocated after the variant): only what is modified is stored, so deriving takes constant time if @p network has not been modified itself.
+ * Both solvers read a variant as any network (tn_bench -f solves link failure, node failure and action change variants). Rows without removed edges are rebuilt on the first read after a modification, so a modified variant must be refreshed (see tn_refresh) before being read by several threads.
+ *
+ * @param network A network.
+ * @return TunnelNetwork The variant, to deallocate with tn_delete (in any order with respect to @p network).
+ */
+TunnelNetwork tn_derive(TunnelNetwork network);
+
+/**
+ * @brief Removes @p node from @p network, with its incoming and outgoing edges. Nodes keep their numbers (a removed node is only isolated).
+ *
+ * @param network A network.
+ * @param node A node.
+ * @pre @p node must be between 0 and tn_get_num_nodes(@p network)-1.
+ */
+void tn_remove_node(TunnelNetwork network, int node);
+
+/**
+ * @brief Removes the edge (@p source, @p target) from @p network, if it is an edge.
+ *
+ * @param network A network.
+ * @param source The source of the edge.
+ * @param target The target of the edge.
+ * @pre @p source and @p target must be between 0 and tn_get_num_nodes(@p network)-1.
+ */
+void tn_remove_edge(TunnelNetwork network, int source, int target);
+
+/**
+ * @brief Allows or forbids @p action on @p node in @p network. The actions of the core are copied on the first change, and are never modified.
+ *
+ * @param network A network.
+ * @param node A node.
+ * @param action An action.
+ * @param allowed True to allow @p action on @p node, false to forbid it.
+ * @pre @p node must be between 0 and tn_get_num_nodes(@p network)-1.
+ */
+void tn_set_node_action(TunnelNetwork network, int node, stack_action action, bool allowed);
+
+/**
+ * @brief Rebuilds the rows of @p network without its removed nodes and edges, if they have changed since they were last built. The other functions do it when needed, but a network read by several threads must be refreshed before.
+ *
+ * @param network A network.
+ */
+void tn_refresh(TunnelNetwork network);
+
 /**
  * @brief Gets the textual representation of @p action.
  *
@@ -114,6 +301,17 @@ int tn_get_num_edges(TunnelNetwork network);
  */
 bool tn_is_edge(TunnelNetwork network, int source, int target);
 
+/**
+ * @brief Returns the successors of @p node in @p network, in increasing order.
+ *
+ * @pre @p node must be between 0 and tn_get_num_nodes(@p network)-1.
+ * @param network
+ * @param node
+ * @param num_successors Filled with the number of successors of @p node.
+ * @return const int* The array of the successors of @p node (owned by @p network).
+ */
+const int *tn_get_successors(TunnelNetwork network, int node, int *num_successors);
+
 /**
  * @brief Returns the name of @p node in @p network.
  *
@@ -136,6 +334,17 @@ char *tn_get_node_name(TunnelNetwork network, int node);
  */
 bool tn_node_has_action(TunnelNetwork network, int node, stack_action action);
 
+/**
+ * @brief Returns the actions of @p node that can be applied when @p top is on top of the stack, as a mask (bit i is set for action i).
+ *
+ * @pre @p node must be between 0 and tn_get_num_nodes(@p network)-1.
+ * @param network
+ * @param node
+ * @param top The symbol on top of the stack (symbol_4 or symbol_6).
+ * @return int
+ */
+int tn_get_enabled_actions(TunnelNetwork network, int node, stack_symbol top);
+
 /**
  * @brief Gets the initial node of @p network.
  *
@@ -187,6 +396,16 @@ char *tn_get_name(TunnelNetwork network);
  */
 void tn_print_path(TunnelNetwork network, tn_step *path, int size_path);
 
+/**
+ * @brief Checks that @p path is a solution of @p network, in one pass over @p path: it is a simple path from the initial node to the final node, following edges of the network, each step performs an action of its source applicable to the stack, and the stack ends with only 4.
+ *
+ * @param network
+ * @param path
+ * @param size_path
+ * @return bool True iff @p path is a valid path.
+ */
+bool tn_validate_path(TunnelNetwork network, const tn_step *path, int size_path);
+
 /**
  * @brief Generates a dot file representing the path described by @p path (in red) over network @p network. The file will have name <@p name>.dot
  *
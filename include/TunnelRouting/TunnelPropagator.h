@@ -0,0 +1,74 @@
+/**
+ * @file TunnelPropagator.h
+ * @brief A Z3 user propagator bringing graph reasoning to the search of the Tunnel reduction. It watches the variables n(u,pos) (and x(u,pos,h) for the boolean encoding) and raises conflicts when they are made true:
+ *        - the simple path constraint, lazily: instead of the binary clauses of φ_simple (one per node and pair of positions), a conflict as soon as two positions hold the same node. It is meant for a formula asserted by tn_assert_reduction with the family tn_simple left out: most of the clauses of φ_simple never take part in the search, and are then never created;
+ *        - reachability: a state too far from the initial state or from the final one (by BFS distances, and by its height, each step changing the height by at most one), and a node from which the final node cannot be reached in the steps left without the nodes of the positions before it (a dead prefix).
+ * @version 1
+ * @date 2026-10-18
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef TUNNEL_PROPAGATOR_H
+#define TUNNEL_PROPAGATOR_H
+
+#include "TunnelNetwork.h"
+#include "TunnelReduction.h"
+#include <z3.h>
+
+/**
+ * @brief The checks performed by a propagator (flags).
+ *
+ */
+typedef enum
+{
+    tn_propagate_simple = 1,      ///< No node at two positions.
+    tn_propagate_reachability = 2 ///< No state or prefix from which the final state cannot be reached in time.
+} tn_propagation;
+
+/**
+ * @brief A propagator attached to a solver.
+ *
+ */
+typedef struct tn_propagator_s *tn_propagator;
+
+/**
+ * @brief Tells whether a propagator can be attached to the solver of formulas using @p encoding.
+ * They must define the variables n(u,pos) (tn_finite_domain does not), and be propositional: with the Z3 4.8 series, a solver with a user propagator can answer sat on unsatisfiable bit-vector formulas.
+ *
+ * @param encoding A stack encoding.
+ * @return true if @p encoding is tn_boolean_stack or tn_nested_stack.
+ */
+bool tn_propagator_supports(tn_stack_encoding encoding);
+
+/**
+ * @brief Attaches to @p solver a propagator performing @p checks on paths of length @p length, and registers the variables it watches.
+ *
+ * @param ctx The solver context.
+ * @param solver The solver. It must be an SMT solver (made by Z3_mk_simple_solver: the one of Z3_mk_solver runs the SAT core on propositional formulas, which does not support user propagators), without another user propagator.
+ * @param network A Tunnel Network.
+ * @param length The size of the target path.
+ * @param encoding The stack encoding of the formula solved.
+ * @param checks The tn_propagation flags of the checks to perform.
+ * @return tn_propagator The propagator. It must be kept until the solver is not used anymore, then deleted with tn_propagator_delete.
+ * @pre @p encoding must be supported (see tn_propagator_supports).
+ */
+tn_propagator tn_propagator_attach(Z3_context ctx, Z3_solver solver, const TunnelNetwork network, int length, tn_stack_encoding encoding, unsigned checks);
+
+/**
+ * @brief Returns the number of conflicts raised by @p propagator so far.
+ *
+ * @param propagator A propagator.
+ * @return long The number of conflicts.
+ */
+long tn_propagator_num_conflicts(const tn_propagator propagator);
+
+/**
+ * @brief Frees @p propagator.
+ *
+ * @param propagator A propagator, whose solver is not used anymore.
+ */
+void tn_propagator_delete(tn_propagator propagator);
+
+#endif
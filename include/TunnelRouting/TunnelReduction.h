@@ -16,6 +16,83 @@
 #include "TunnelNetwork.h"
 #include <z3.h>
 
+/**
+ * @brief The families of constraints composing the formula of the reduction.
+ *
+ */
+typedef enum
+{
+    tn_unicity,        ///< Exactly one pair (node,height) per position.
+    tn_stack_validity, ///< The stack is well formed at each position.
+    tn_init,           ///< Initial node and initial stack.
+    tn_final,          ///< Final node and final stack.
+    tn_projection,     ///< The node of each position, whatever the height.
+    tn_edges,          ///< Consecutive nodes are linked by an edge.
+    tn_simple,         ///< No node is visited twice.
+    tn_stack_frame,    ///< The height of the stack is the one of the state, and the cells below both tops are kept by a step.
+    tn_transitions     ///< Stack evolution follows the actions of the nodes.
+} tn_constraint_family;
+
+/**
+ * @brief Number of constraint families.
+ *
+ */
+#define NumConstraintFamilies 9
+
+/**
+ * @brief The encodings of the stack available to the reduction.
+ *
+ */
+typedef enum
+{
+    tn_boolean_stack,   ///< Two Boolean variables per cell and position (4 and 6), with no gap and not both.
+    tn_bitvector_stack, ///< A bit-vector per position, with the top in bit 0 (1 for a 6): a push is a shift left, a pop a shift right.
+    tn_nested_stack,    ///< No stack: the action of each step, the top of each position, and the matching of each push with its pop (a path is a well-nested word).
+    tn_finite_domain    ///< No one-hot variables: the node and the height of each position are integer terms (a single distinct for simplicity), and the stack is the bit-vector one.
+} tn_stack_encoding;
+
+/**
+ * @brief Number of stack encodings.
+ *
+ */
+#define NumStackEncodings 4
+
+/**
+ * @brief Returns the name of @p encoding (as accepted by tn_stack_encoding_of_name).
+ *
+ * @param encoding A stack encoding.
+ * @return const char* Its name.
+ */
+const char *tn_stack_encoding_name(tn_stack_encoding encoding);
+
+/**
+ * @brief Finds the encoding named @p name.
+ *
+ * @param name A name ("boolean", "bitvector", "nested" or "finite").
+ * @param encoding Returns the encoding.
+ * @return true if @p name is the name of an encoding.
+ */
+bool tn_stack_encoding_of_name(const char *name, tn_stack_encoding *encoding);
+
+/**
+ * @brief Size and build time of each constraint family of a formula generated by the reduction.
+ *
+ */
+typedef struct
+{
+    int clauses[NumConstraintFamilies];     ///< Number of constraints (top-level conjuncts) of each family.
+    long literals[NumConstraintFamilies];   ///< Number of variable occurrences in the constraints of each family.
+    double seconds[NumConstraintFamilies];  ///< Time spent building each family, in seconds.
+} tn_reduction_stats;
+
+/**
+ * @brief Returns the name of @p family (as used in printed statistics).
+ *
+ * @param family A constraint family.
+ * @return const char* Its name.
+ */
+const char *tn_constraint_family_name(tn_constraint_family family);
+
 /**
  * @brief Generates a propositional formula satisfiable if and only if there is a well-formed simple path of size @p bound from the initial node of @p network to its final node.
  *
@@ -27,6 +104,81 @@
  */
 Z3_ast tn_reduction(Z3_context ctx, const TunnelNetwork network, int length);
 
+/**
+ * @brief Asserts in @p solver the constraints of the formula of tn_reduction, with the stack encoded as @p encoding, and leaving out the constraint families whose bit (1 << family) is set in @p omitted (their statistics are 0).
+ * The formula may then have models which are not paths: the caller must enforce the omitted families by other means (see TunnelPropagator.h for tn_simple).
+ * Each constraint is asserted as soon as it is built, and its literals are counted then: neither the constraints nor their conjunction are kept. In a context created by make_rc_context, the terms built along the way are released as soon as the constraints using them are asserted.
+ *
+ * @param ctx The solver context.
+ * @param solver The solver receiving the constraints.
+ * @param network A Tunnel Network.
+ * @param length The size of the target path.
+ * @param encoding The encoding of the stack.
+ * @param omitted The families left out.
+ * @param stats The statistics to fill with the size and build time of each constraint family (counting literals requires a traversal of each constraint, so only ask for it when needed). If NULL, nothing is measured.
+ * @pre @p network must be initialized.
+ */
+void tn_assert_reduction(Z3_context ctx, Z3_solver solver, const TunnelNetwork network, int length, tn_stack_encoding encoding, unsigned omitted, tn_reduction_stats *stats);
+
+/**
+ * @brief Creates the variable "x_{node,pos,stack_height}" of the boolean encoding: the state at position @p pos is (@p node, @p stack_height).
+ *
+ * @param ctx The solver context.
+ * @param node A node.
+ * @param pos The path position.
+ * @param stack_height The highest cell occupied of the stack at that position.
+ * @return Z3_ast
+ */
+Z3_ast tn_path_variable(Z3_context ctx, int node, int pos, int stack_height);
+
+/**
+ * @brief The number of cells of the stack in a formula for a path of length @p length (the heights are 0 to get_stack_size(length)-1).
+ *
+ * @param length The size of the target path.
+ * @return int
+ */
+int get_stack_size(int length);
+
+/**
+ * @brief Creates the variable "n_{node,pos}" of the reduction: the state at position @p pos has node @p node, whatever its height. It is defined by every encoding but tn_finite_domain.
+ *
+ * @param ctx The solver context.
+ * @param node A node.
+ * @param pos The path position.
+ * @return Z3_ast
+ */
+Z3_ast tn_node_variable(Z3_context ctx, int node, int pos);
+
+/**
+ * @brief Creates the literal "the node at position @p pos is @p node" of a formula using @p encoding: n(@p node,@p pos), or for tn_finite_domain the equality of the node term of @p pos with @p node.
+ *
+ * @param ctx The solver context.
+ * @param node A node.
+ * @param pos The path position.
+ * @param encoding The stack encoding of the formula.
+ * @return Z3_ast
+ */
+Z3_ast tn_node_literal(Z3_context ctx, int node, int pos, tn_stack_encoding encoding);
+
+/**
+ * @brief Number of conflicts the solver may spend on the hints of tn_hint_literals before they are dropped (see check_solver_with_hints).
+ *
+ */
+#define TnHintConflicts 1000
+
+/**
+ * @brief Translates the steps @p path[0..size_path-1] of a path or prefix into literals of a formula using @p encoding: the node of each position 0 to @p size_path. They are meant as hints to the solver (see check_solver_with_hints and tn_brute_force_hint).
+ *
+ * @param ctx The solver context.
+ * @param path The steps.
+ * @param size_path The number of steps.
+ * @param encoding The stack encoding of the formula.
+ * @param literals Array to return the literals. Each one is held by Z3_inc_ref (so that it outlives the terms built afterwards in a context created by make_rc_context): release them with Z3_dec_ref once checked.
+ * @return int The number of literals: @p size_path + 1, or 0 if @p size_path is 0.
+ * @pre @p literals must be an array of size at least @p size_path + 1.
+ */
+int tn_hint_literals(Z3_context ctx, const tn_step *path, int size_path, tn_stack_encoding encoding, Z3_ast *literals);
+
 /**
  * @brief Gets the well-formed path from the model @p model.
  *
@@ -34,10 +186,11 @@ Z3_ast tn_reduction(Z3_context ctx, const TunnelNetwork network, int length);
  * @param model A variable assignment.
  * @param network A Tunnel Network.
  * @param bound The size of the path.
+ * @param encoding The encoding of the stack in the formula solved.
  * @param path The path
  * @pre @p path must be an array of size @p bound+1.
  */
-void tn_get_path_from_model(Z3_context ctx, Z3_model model, TunnelNetwork network, int bound, tn_step *path);
+void tn_get_path_from_model(Z3_context ctx, Z3_model model, TunnelNetwork network, int bound, tn_stack_encoding encoding, tn_step *path);
 
 /**
  * @brief Prints (in pretty format) which variables used by the tunnel reduction are true in @p model.
@@ -46,7 +199,8 @@ void tn_get_path_from_model(Z3_context ctx, Z3_model model, TunnelNetwork networ
  * @param model A variable assignment.
  * @param network A tunnel network.
  * @param bound The size of the path.
+ * @param encoding The encoding of the stack in the formula solved.
  */
-void tn_print_model(Z3_context ctx, Z3_model model, TunnelNetwork network, int bound);
+void tn_print_model(Z3_context ctx, Z3_model model, TunnelNetwork network, int bound, tn_stack_encoding encoding);
 
 #endif
\ No newline at end of file
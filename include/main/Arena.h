@@ -0,0 +1,83 @@
+/**
+ * @file Arena.h
+ * @brief Region allocator. Memory is taken from large chunks by moving a pointer, and is only freed all at once, when the arena is deleted.
+ *        An arena is reference counted, so that several owners (for instance a graph and its copies) can share the memory it contains: it is freed when the last of them deletes it.
+ * @version 1
+ * @date 2026-10-18
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef COCA_ARENA_H_
+#define COCA_ARENA_H_
+
+#include <stddef.h>
+
+/**
+ * @brief An arena. This is an opaque pointer.
+ *
+ */
+typedef struct Arena_s *Arena;
+
+/**
+ * @brief Creates an empty arena, with one reference.
+ *
+ * @return Arena The arena.
+ */
+Arena arena_create(void);
+
+/**
+ * @brief Allocates @p size bytes in @p arena. The memory is suitably aligned for any type, and is not initialised.
+ *
+ * @param arena An arena.
+ * @param size The number of bytes.
+ * @return void* The memory, valid until @p arena is freed.
+ */
+void *arena_alloc(Arena arena, size_t size);
+
+/**
+ * @brief Allocates @p size bytes set to zero in @p arena.
+ *
+ * @param arena An arena.
+ * @param size The number of bytes.
+ * @return void* The memory, valid until @p arena is freed.
+ */
+void *arena_calloc(Arena arena, size_t size);
+
+/**
+ * @brief Copies @p size bytes of @p data in @p arena.
+ *
+ * @param arena An arena.
+ * @param data The bytes to copy.
+ * @param size Their number.
+ * @return void* The copy, valid until @p arena is freed.
+ */
+void *arena_memdup(Arena arena, const void *data, size_t size);
+
+/**
+ * @brief Copies the @p length characters of @p string in @p arena, followed by a null character (characters are not aligned, so that short strings are packed).
+ *
+ * @param arena An arena.
+ * @param string The characters to copy (which need not be null-terminated).
+ * @param length Their number.
+ * @return char* The copy, valid until @p arena is freed.
+ */
+char *arena_strndup(Arena arena, const char *string, size_t length);
+
+/**
+ * @brief Adds a reference to @p arena.
+ *
+ * @param arena An arena.
+ * @return Arena @p arena.
+ */
+Arena arena_share(Arena arena);
+
+/**
+ * @brief Removes a reference to @p arena, and frees it with all the memory allocated in it if it was the last one. The time taken depends on the number of chunks, not on the number of allocations.
+ *
+ * @param arena An arena (NULL is allowed).
+ */
+void arena_delete(Arena arena);
+
+#endif
@@ -0,0 +1,157 @@
+/**
+ * @file BitMatrix.h
+ * @brief Bit-packed boolean matrices and bitsets. Each row of a matrix is a bitset of 64-bit words, so that rows can be combined a word at a time.
+ *        The kernels combining bitsets (intersection, union, counting) use AVX2 when the processor supports it, and portable code otherwise: the choice is made once, at run time.
+ * @version 1
+ * @date 2026-10-18
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef COCA_BITMATRIX_H_
+#define COCA_BITMATRIX_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Number of words of a bitset of @p num_bits bits.
+ *
+ */
+#define BitsetWords(num_bits) (((num_bits) + 63) / 64)
+
+/**
+ * @brief Reads, sets and clears the bit @p bit of the bitset @p set (an array of uint64_t).
+ *
+ */
+#define BitsetTest(set, bit) ((((set)[(bit) >> 6]) >> ((bit) & 63)) & 1)
+#define BitsetSet(set, bit) ((set)[(bit) >> 6] |= (uint64_t)1 << ((bit) & 63))
+#define BitsetClear(set, bit) ((set)[(bit) >> 6] &= ~((uint64_t)1 << ((bit) & 63)))
+
+/**
+ * @brief A matrix of bits. This is an opaque pointer.
+ *
+ */
+typedef struct BitMatrix_s *BitMatrix;
+
+/**
+ * @brief Creates a matrix of @p num_rows rows of @p num_columns bits, all 0.
+ *
+ * @param num_rows The number of rows.
+ * @param num_columns The number of columns.
+ * @return BitMatrix The matrix, to deallocate with bit_matrix_delete.
+ */
+BitMatrix bit_matrix_create(int num_rows, int num_columns);
+
+/**
+ * @brief Deallocates @p matrix.
+ *
+ * @param matrix A matrix (NULL is allowed).
+ */
+void bit_matrix_delete(BitMatrix matrix);
+
+/**
+ * @brief Returns the number of words of the rows of @p matrix (BitsetWords of its number of columns). Bitsets combined with its rows must have that size.
+ *
+ * @param matrix A matrix.
+ * @return int The number of words of a row.
+ */
+int bit_matrix_row_words(BitMatrix matrix);
+
+/**
+ * @brief Sets the bit (@p row, @p column) of @p matrix.
+ *
+ * @param matrix A matrix.
+ * @param row A row.
+ * @param column A column.
+ */
+void bit_matrix_set(BitMatrix matrix, int row, int column);
+
+/**
+ * @brief Returns the bit (@p row, @p column) of @p matrix.
+ *
+ * @param matrix A matrix.
+ * @param row A row.
+ * @param column A column.
+ * @return bool The bit.
+ */
+bool bit_matrix_get(BitMatrix matrix, int row, int column);
+
+/**
+ * @brief Returns the row @p row of @p matrix, as a bitset of bit_matrix_row_words(@p matrix) words.
+ *
+ * @param matrix A matrix.
+ * @param row A row.
+ * @return const uint64_t* The row, valid until @p matrix is deallocated.
+ */
+const uint64_t *bit_matrix_row(BitMatrix matrix, int row);
+
+/**
+ * @brief Adds to @p result the union of the rows of @p matrix selected by @p rows (for an adjacency matrix, the successors of a set of nodes).
+ *
+ * @param matrix A matrix.
+ * @param rows A bitset of rows of @p matrix.
+ * @param result A bitset of bit_matrix_row_words(@p matrix) words.
+ */
+void bit_matrix_or_rows(BitMatrix matrix, const uint64_t *rows, uint64_t *result);
+
+/**
+ * @brief Computes @p result = @p first & @p second.
+ *
+ * @param result A bitset of @p num_words words (which may be @p first or @p second).
+ * @param first A bitset of @p num_words words.
+ * @param second A bitset of @p num_words words.
+ * @param num_words The number of words.
+ * @return bool True iff @p result is not empty.
+ */
+bool bitset_and(uint64_t *result, const uint64_t *first, const uint64_t *second, int num_words);
+
+/**
+ * @brief Computes @p result = @p set & ~@p removed (for instance the successors of a node which are not visited).
+ *
+ * @param result A bitset of @p num_words words (which may be @p set or @p removed).
+ * @param set A bitset of @p num_words words.
+ * @param removed A bitset of @p num_words words.
+ * @param num_words The number of words.
+ * @return bool True iff @p result is not empty.
+ */
+bool bitset_and_not(uint64_t *result, const uint64_t *set, const uint64_t *removed, int num_words);
+
+/**
+ * @brief Tells whether two bitsets share a bit (for instance, whether a node has a neighbour in a set of nodes).
+ *
+ * @param first A bitset of @p num_words words.
+ * @param second A bitset of @p num_words words.
+ * @param num_words The number of words.
+ * @return bool True iff @p first & @p second is not empty.
+ */
+bool bitset_intersects(const uint64_t *first, const uint64_t *second, int num_words);
+
+/**
+ * @brief Adds @p set to @p result (@p result |= @p set).
+ *
+ * @param result A bitset of @p num_words words.
+ * @param set A bitset of @p num_words words.
+ * @param num_words The number of words.
+ */
+void bitset_or(uint64_t *result, const uint64_t *set, int num_words);
+
+/**
+ * @brief Counts the bits set in @p set.
+ *
+ * @param set A bitset of @p num_words words.
+ * @param num_words The number of words.
+ * @return long The number of bits set.
+ */
+long bitset_count(const uint64_t *set, int num_words);
+
+/**
+ * @brief Chooses between the AVX2 kernels and the portable ones (the AVX2 ones are used by default when the processor supports them).
+ *
+ * @param enabled False to use the portable kernels.
+ * @return bool True iff the AVX2 kernels are used after the call.
+ */
+bool bitset_use_simd(bool enabled);
+
+#endif
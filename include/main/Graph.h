@@ -15,73 +15,43 @@
 
 #include <stdbool.h>
 #include <stdio.h>
+#include "Arena.h"
+#include "StringPool.h"
 
 /**
- * @brief List of arbitrary parameters
+ * @brief An attribute of a node or an edge (key=value in the dot file). Keys and values are interned in the strings of the graph, so two keys are equal if and only if they are the same pointer.
  *
  */
-typedef struct tag_paramList
+typedef struct
 {
-	char *name;					///< The name (key) of the parameter.
-	char *value;				///< The value of the parameter.
-	struct tag_paramList *next; ///< Pointer to the next parameter (NULL if last).
-} parameterList;
-
-/**
- * @brief Adds a parameter if not already present
- *
- */
-parameterList *parameter_list_add_parameter(parameterList *list, char *name, char *value);
-
-/**
- * @brief Appends tail to head and returns a pointer to the result.
- *
- * @param head A parameter list.
- * @param tail A parameter list.
- */
-parameterList *parameter_lists_merge(parameterList *head, parameterList *tail);
-
-/**
- * @brief Copies a parameter list. Every inner field is copied.
- *
- * @param source the list to copy.
- * @return parameterList* A copy of source.
- */
-parameterList *parameter_list_copy(parameterList *source);
+	const char *key;   ///< The name (key) of the attribute.
+	const char *value; ///< The value of the attribute.
+} graphAttribute;
 
-/**
- * @brief Get the value associated with name within a list of parameters. Exits the program if not present.
- *
- * @param list A list of parameters.
- * @param name The name of the field to search.
- * @return char* The value associated with name in list.
- */
-char *parameter_list_get_value(parameterList *list, char *name);
-
-/**
- * @brief Frees a list of parameters
- *
- */
-void parameter_list_delete(parameterList *list);
-
-/** @brief: the graph type. The first four fields are needed to represent a directed graph. The rest depends on needs. Here, the rest represents initial and final states of an automaton.*/
+/** @brief: the graph type. The first five fields are needed to represent a directed graph. The rest depends on needs. Here, the rest represents initial and final states of an automaton.
+ * Edges are stored in compressed sparse rows: the successors of node u are successors[edgeOffsets[u]] to successors[edgeOffsets[u+1]-1], in increasing order. Edges of undirected graphs are stored in both directions.*/
 typedef struct
 {
-	char *name;	  ///< The name of the graph/automaton
-	int numNodes; ///< The number of nodes of the graph.
-	int numEdges; ///< The number of edges of the graph.
-	char **nodes; ///< The names of nodes of the graph.
-	bool *edges;  ///< The edges of the graph.
-
-	parameterList **parameters;		 ///< Parameters of the nodes.
-	parameterList **edge_parameters; ///< Parameters of the edges
+	char *name;		  ///< The name of the graph/automaton
+	int numNodes;	  ///< The number of nodes of the graph.
+	int numEdges;	  ///< The number of edges of the graph (an undirected edge counts once).
+	char **nodes;	  ///< The names of nodes of the graph.
+	int *edgeOffsets; ///< Position of the successors of each node in successors (numNodes+1 cells).
+	int *successors;  ///< The successors of the nodes.
+
+	Arena arena;					///< Holds all the memory of the graph (names, arrays and strings), shared with its copies.
+	StringPool strings;				///< Strings of the graph (names of the graph and of the nodes, keys and values of the attributes), in arena.
+	int *attributeOffsets;			///< The attributes of node u are attributes[attributeOffsets[u]] to attributes[attributeOffsets[u+1]-1] (numNodes+1 cells).
+	graphAttribute *attributes;		///< Attributes of the nodes, in the order they were given.
+	int *edgeAttributeOffsets;		///< Same as attributeOffsets for the edges, indexed by their position in successors.
+	graphAttribute *edgeAttributes; ///< Attributes of the edges, in the order they were given.
 } Graph;
 
 /**
- * @brief Creates a copy of the graph passed in argument.
+ * @brief Creates a copy of the graph passed in argument. Graphs are not modified once built, so the copy shares the memory of @p graph (which is freed when both have been deleted): this takes constant time.
  *
  * @param graph A graph.
- * @return graph A copy of graph.
+ * @return graph A copy of graph, to delete with graph_delete.
  * @pre @p graph must be a valid graph.
  */
 Graph graph_copy(Graph graph);
@@ -96,7 +66,7 @@ Graph graph_copy(Graph graph);
 void graph_print(Graph graph);
 
 /**
- * @brief Frees all memory occupied by a graph.
+ * @brief Frees all memory occupied by a graph (unless it is shared with copies not yet deleted). This takes a time proportional to the number of chunks of its arena.
  *
  * @param graph The graph to delete.
  *
@@ -147,27 +117,76 @@ int graph_num_edges(Graph graph);
 bool graph_is_edge(Graph graph, int source, int target);
 
 /**
- * @brief Returns the parameter list associated to edge (@p source, @p target). Returns NULL if no parameter exists (or the edge doesn't exist).
+ * @brief Returns the successors of @p node in @p graph, in increasing order.
+ *
+ * @param graph A graph.
+ * @param node A node.
+ * @param num_successors Filled with the number of successors of @p node.
+ * @return const int* The successors of @p node (owned by @p graph).
+ * @pre @p graph must be a valid graph.
+ * @pre 0 <= @p node < @p graph.numNodes
+ */
+const int *graph_get_successors(Graph graph, int node, int *num_successors);
+
+/**
+ * @brief Returns the position of edge (@p source, @p target) in the successors of @p graph (which numbers the edges from 0 to edgeOffsets[numNodes]-1, an undirected edge having one position in each direction).
  *
  * @param graph A graph.
  * @param source The source of the edge.
  * @param target The target of the edge.
+ * @return int The position of the edge, or -1 if it is not an edge.
  * @pre @p graph must be a valid graph.
  * @pre 0 <= @p source < @p graph.numNodes
  * @pre 0 <= @p target < @p graph.numNodes
  */
-parameterList *graph_get_edge_parameter(Graph graph, int source, int target);
+int graph_get_edge_index(Graph graph, int source, int target);
+
+/**
+ * @brief Returns the attributes of edge (@p source, @p target), in the order they were given. There are none if the edge doesn't exist.
+ *
+ * @param graph A graph.
+ * @param source The source of the edge.
+ * @param target The target of the edge.
+ * @param num_attributes Filled with the number of attributes of the edge.
+ * @return const graphAttribute* The attributes (owned by @p graph).
+ * @pre @p graph must be a valid graph.
+ * @pre 0 <= @p source < @p graph.numNodes
+ * @pre 0 <= @p target < @p graph.numNodes
+ */
+const graphAttribute *graph_get_edge_attributes(Graph graph, int source, int target, int *num_attributes);
+
+/**
+ * @brief Returns the attributes of node @p node, in the order they were given.
+ *
+ * @param graph A graph.
+ * @param node Its node.
+ * @param num_attributes Filled with the number of attributes of @p node.
+ * @return const graphAttribute* The attributes (owned by @p graph).
+ * @pre @p graph must be a valid graph.
+ * @pre 0 <= @p node < @p graph.numNodes.
+ */
+const graphAttribute *graph_get_node_attributes(Graph graph, int node, int *num_attributes);
+
+/**
+ * @brief Returns the interned copy of @p string in @p graph, to compare it by pointer with the keys and values of the attributes.
+ *
+ * @param graph A graph.
+ * @param string A string.
+ * @return const char* The interned string, or NULL if it is not among the strings of @p graph (in which case no key or value is equal to @p string).
+ */
+const char *graph_find_string(Graph graph, const char *string);
 
 /**
- * @brief Return the parameter list associated to node @p node. Returns NULL if no parameter exists.
+ * @brief Returns the value of the first attribute of @p node whose key is @p key.
  *
  * @param graph A graph.
  * @param node Its node.
- * @return parameterList* The parameters of @p node.
+ * @param key The key to search.
+ * @return const char* The value associated with @p key, or NULL if @p node has no such attribute.
  * @pre @p graph must be a valid graph.
  * @pre 0 <= @p node < @p graph.numNodes.
  */
-parameterList *graph_get_node_parameter(Graph graph, int node);
+const char *graph_get_node_attribute(Graph graph, int node, const char *key);
 
 /**
  * @brief Returns the name of a node given its identifier.
@@ -181,7 +200,7 @@ parameterList *graph_get_node_parameter(Graph graph, int node);
 char *graph_get_node_name(Graph graph, int node);
 
 /**
- * @brief Writes in @p file the content of @p graph (with parameters) in dot format. For undirected graphs only.
+ * @brief Writes in @p file the content of @p graph (with node attributes) in dot format. For undirected graphs only.
  *
  * @param graph A graph.
  * @param file A file.
@@ -190,7 +209,7 @@ char *graph_get_node_name(Graph graph, int node);
 void graph_fill_dot_content(Graph graph, FILE *file);
 
 /**
- * @brief Writes in @p file the content of @p graph (with parameters) in dot format. For directed graphs only.
+ * @brief Writes in @p file the content of @p graph (with node attributes) in dot format. For directed graphs only.
  *
  * @param graph A graph.
  * @param file A file.
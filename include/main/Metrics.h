@@ -0,0 +1,137 @@
+/**
+ * @file Metrics.h
+ * @brief Wall-clock timing of the phases of a run and peak memory reporting.
+ *        Times are measured with a monotonic clock, so they stay meaningful when the program waits on I/O or uses several threads.
+ *        Each phase accumulates the duration and the number of its spans over the whole run, and the result can be printed as text or as a JSON block.
+ *        Solvers can also attach records of named values (sizes, counters) that are printed with the phases.
+ *        All functions can be called from several threads. Spans are timed per thread, so when several threads run the same phase (e.g. parsing files in parallel), its total adds their spans and can exceed the wall time.
+ * @version 1
+ * @date 2026-10-18
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef COCA_METRICS_H_
+#define COCA_METRICS_H_
+
+#include <stdio.h>
+
+/**
+ * @brief The phases of a run that are timed.
+ *
+ */
+typedef enum
+{
+    metrics_parse,         ///< Reading and parsing the input files.
+    metrics_create_graph,  ///< Building the Graph from the parsed structure.
+    metrics_initialize,    ///< Building the problem instance from the Graph (tn_initialize, cg_initialize).
+    metrics_preprocessing, ///< Precomputations done on the instance before building the formula (distances of the propagators, brute force hints of the warm start).
+    metrics_formula,       ///< Building the formula of a reduction.
+    metrics_solve,         ///< Solving (SAT solver or brute force).
+    metrics_decode,        ///< Decoding a solution from a model.
+    metrics_output         ///< Printing solutions and writing output files.
+} metrics_phase;
+
+/**
+ * @brief Number of timed phases.
+ *
+ */
+#define NumMetricsPhases 8
+
+/**
+ * @brief Output formats of the statistics.
+ *
+ */
+typedef enum
+{
+    metrics_format_none, ///< Statistics are not printed.
+    metrics_format_text, ///< Human readable lines.
+    metrics_format_json  ///< A single JSON object.
+} metrics_format;
+
+/**
+ * @brief Returns the current time of the monotonic clock, in seconds. Only differences between two values are meaningful.
+ *
+ * @return double The current time.
+ */
+double metrics_now(void);
+
+/**
+ * @brief Resets every accumulated measure and takes the current time as the start of the run.
+ *
+ */
+void metrics_init(void);
+
+/**
+ * @brief Starts a span of @p phase.
+ *
+ * @param phase A phase.
+ * @pre No span of @p phase is currently running.
+ */
+void metrics_phase_start(metrics_phase phase);
+
+/**
+ * @brief Ends the running span of @p phase and adds its duration to the total of @p phase.
+ *
+ * @param phase A phase.
+ * @return double The duration of the span that just ended, in seconds.
+ * @pre metrics_phase_start(@p phase) has been called before.
+ */
+double metrics_phase_stop(metrics_phase phase);
+
+/**
+ * @brief Returns the total time spent in @p phase so far, in seconds.
+ *
+ * @param phase A phase.
+ * @return double Its total duration.
+ */
+double metrics_phase_total(metrics_phase phase);
+
+/**
+ * @brief Returns the name of @p phase (as used in the printed statistics).
+ *
+ * @param phase A phase.
+ * @return const char* Its name.
+ */
+const char *metrics_phase_name(metrics_phase phase);
+
+/**
+ * @brief Returns the peak resident set size of the process, in kilobytes.
+ *
+ * @return long The peak memory used so far.
+ */
+long metrics_peak_rss_kb(void);
+
+/**
+ * @brief Starts a new record of named values, printed after the phases (one line per record in text format, one object of the "records" array in JSON format).
+ *        The values given by the following calls to metrics_record_value are attached to this record.
+ *
+ * @param kind The kind of the record (e.g. "tn_length").
+ */
+void metrics_record_start(const char *kind);
+
+/**
+ * @brief Adds the value @p value named @p key to the last record started (by any thread: a record should be filled by a single thread at a time).
+ *
+ * @param key The name of the value (copied).
+ * @param value The value.
+ * @pre metrics_record_start has been called before.
+ */
+void metrics_record_value(const char *key, double value);
+
+/**
+ * @brief Frees the memory used by the records.
+ *
+ */
+void metrics_release(void);
+
+/**
+ * @brief Prints the accumulated statistics in @p file, in format @p format. Does nothing if @p format is metrics_format_none.
+ *
+ * @param file A file.
+ * @param format The output format.
+ */
+void metrics_print(FILE *file, metrics_format format);
+
+#endif
@@ -1,7 +1,7 @@
 /**
  * @file Parsing.h
  * @author Vincent Penelle (vincent.penelle@u-bordeaux.fr)
- * @brief Contains function to convert graphviz files to the GraphList structure. Needs first to compile Lexer.l and Parser.y with bison.
+ * @brief Contains function to convert graphviz files to the Graph structure. Needs first to compile Lexer.l and Parser.y with bison.
  * @version 1
  * @date 2019-07-31
  * 
@@ -12,16 +12,35 @@
 #ifndef COCA_PARSING_H_
 #define COCA_PARSING_H_
 
-#include "GraphList.h"
 #include "Graph.h"
 
 /**
  * @brief Parses a file and return the Graph described by it. If the file with the name given in argument does not exists, it displays an error message and exits the program.
  * 
  * @param toRead the name of a file in graphviz format.
- * @return GraphList The parsed GraphList.
+ * @return Graph The parsed Graph.
  * @pre @p toRead must be an existing file in graphviz format.
  */
 Graph get_graph_from_file(char *toRead);
 
+/**
+ * @brief Parses a string and return the Graph described by it.
+ *
+ * @param expr A string in graphviz format.
+ * @return Graph The parsed Graph.
+ */
+Graph get_graph_from_string(const char *expr);
+
+/**
+ * @brief Parses the files @p toRead on a pool of @p num_threads threads, and stores the Graph of each file toRead[i] in @p graphs[i]. Entries of @p toRead that are NULL are skipped (the corresponding graphs are not modified).
+ * Parsing is reentrant (each file has its own scanner and strings), so the files are parsed independently. Files are distributed dynamically, so large and small files can be mixed.
+ *
+ * @param toRead The names of @p num_files files in graphviz format (or NULL).
+ * @param num_files The number of files.
+ * @param graphs An array of @p num_files graphs, filled with the parsed graphs.
+ * @param num_threads The number of threads to use (at most @p num_files are created; 1 parses the files in the calling thread).
+ * @pre Each non NULL @p toRead must be an existing file in graphviz format (otherwise the program exits, as for get_graph_from_file).
+ */
+void get_graphs_from_files(char **toRead, int num_files, Graph *graphs, int num_threads);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,75 @@
+/**
+ * @file StringPool.h
+ * @brief Pool of interned strings. Each distinct string is copied once into an arena, and interning the same characters again returns the same pointer.
+ *        Interned strings can thus be compared by pointer, and are all freed at once with the pool.
+ * @version 1
+ * @date 2026-10-18
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef COCA_STRINGPOOL_H_
+#define COCA_STRINGPOOL_H_
+
+#include <stddef.h>
+#include "Arena.h"
+
+/**
+ * @brief A pool of interned strings. This is an opaque pointer.
+ *
+ */
+typedef struct StringPool_s *StringPool;
+
+/**
+ * @brief Creates an empty pool, in an arena of its own.
+ *
+ * @return StringPool The pool.
+ */
+StringPool string_pool_create(void);
+
+/**
+ * @brief Creates an empty pool in @p arena: the pool, its table and its strings are allocated in @p arena, and are freed with it.
+ *
+ * @param arena An arena.
+ * @return StringPool The pool (string_pool_delete does nothing on it).
+ */
+StringPool string_pool_create_in(Arena arena);
+
+/**
+ * @brief Returns the interned copy of the @p length characters starting at @p string (which need not be null-terminated).
+ *        The first call with given characters copies them in the pool, the following ones return the same pointer.
+ *
+ * @param pool A pool.
+ * @param string The characters to intern.
+ * @param length Their number.
+ * @return const char* The interned null-terminated string, valid until the pool is deleted.
+ */
+const char *string_pool_intern(StringPool pool, const char *string, size_t length);
+
+/**
+ * @brief Returns the interned copy of the @p length characters starting at @p string if they have been interned in @p pool, without interning them otherwise.
+ *
+ * @param pool A pool (NULL is allowed, and contains no string).
+ * @param string The characters to look for.
+ * @param length Their number.
+ * @return const char* The interned string, or NULL if it is not in @p pool.
+ */
+const char *string_pool_find(StringPool pool, const char *string, size_t length);
+
+/**
+ * @brief Returns the number of distinct strings in @p pool.
+ *
+ * @param pool A pool.
+ * @return int Its number of strings.
+ */
+int string_pool_num_strings(StringPool pool);
+
+/**
+ * @brief Frees @p pool and every string interned in it, if it has been created by string_pool_create.
+ *
+ * @param pool A pool (NULL is allowed).
+ */
+void string_pool_delete(StringPool pool);
+
+#endif
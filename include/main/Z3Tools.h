@@ -24,6 +24,14 @@
  */
 Z3_context make_context(void);
 
+/**
+ * @brief Creates a Z3 context whose terms are reference counted (Z3_mk_context_rc): a term is freed as soon as nothing holds it, instead of with the context. Must be freed with Z3_del_context.
+ * A term returned by the API is only held until the next call returning a term: it must be held by Z3_inc_ref, or by a term, vector or solver using it, to outlive that call.
+ *
+ * @return Z3_context The created context
+ */
+Z3_context make_rc_context(void);
+
 /**
  * @brief Creates a formula containing a single variable whose name is given in parameter. Example mk_bool_var(ctx,"toto") will create the formula «toto». Each call with
  *        same name will produce the same formula (so it can be used to have the same variable in different formulae.)
@@ -83,6 +91,85 @@ Z3_model get_model_from_sat_formula(Z3_context ctx, Z3_ast formula);
  */
 Z3_lbool solve_formula(Z3_context ctx, Z3_ast formula, Z3_model *model);
 
+/**
+ * @brief Search statistics reported by the solver after a check.
+ *
+ */
+typedef struct
+{
+    double conflicts;    ///< Number of conflicts.
+    double decisions;    ///< Number of decisions.
+    double propagations; ///< Number of propagations of the SMT core ("propagations") or of the SAT core ("sat propagations 2ary", "3ary" and "nary").
+    double memory;       ///< Maximum memory used by the solver, in megabytes.
+} solver_statistics;
+
+/**
+ * @brief Same as solve_formula, but also fills @p stats with the statistics of the solver after the check.
+ *
+ * @param ctx The context of the solver.
+ * @param formula The formula to check.
+ * @param model A pointer towards a model. Will contain a model of @p formula if it is satisfiable (otherwise, will not be modified).
+ * @param stats The statistics to fill. If NULL, nothing is collected.
+ * @return Z3_lbool Z3_L_FALSE if @p formula is unsatisfiable, Z3_L_TRUE if @p formula is satisfiable and Z3_L_UNDEF if the solver cannot decide if @p formula is satisfiable or not.
+ */
+Z3_lbool solve_formula_with_statistics(Z3_context ctx, Z3_ast formula, Z3_model *model, solver_statistics *stats);
+
+/**
+ * @brief Same as solve_formula_with_statistics, but asserts @p formula in the solver @p s given by the caller, which can have been configured beforehand (parameters, user propagator...).
+ *
+ * @param ctx The context of the solver.
+ * @param s The solver.
+ * @param formula The formula to check.
+ * @param model A pointer towards a model. Will contain a model of @p formula if it is satisfiable (otherwise, will not be modified).
+ * @param stats The statistics to fill. If NULL, nothing is collected.
+ * @return Z3_lbool Z3_L_FALSE if @p formula is unsatisfiable, Z3_L_TRUE if @p formula is satisfiable and Z3_L_UNDEF if the solver cannot decide if @p formula is satisfiable or not.
+ */
+Z3_lbool solve_formula_in_solver(Z3_context ctx, Z3_solver s, Z3_ast formula, Z3_model *model, solver_statistics *stats);
+
+/**
+ * @brief Checks the constraints already asserted in the solver @p s (see solve_formula_in_solver).
+ *
+ * @param ctx The context of the solver.
+ * @param s The solver.
+ * @param model A pointer towards a model. Will contain a model of the assertions of @p s if they are satisfiable (otherwise, will not be modified).
+ * @param stats The statistics to fill. If NULL, nothing is collected.
+ * @return Z3_lbool Z3_L_FALSE if the assertions of @p s are unsatisfiable, Z3_L_TRUE if they are satisfiable and Z3_L_UNDEF if the solver cannot decide.
+ */
+Z3_lbool check_solver(Z3_context ctx, Z3_solver s, Z3_model *model, solver_statistics *stats);
+
+/**
+ * @brief Creates a solver for check_solver_with_hints (to inc_ref and dec_ref as the one of Z3_mk_solver).
+ *
+ * @param ctx The context of the solver.
+ * @param finite_domain True if the formulas asserted only have boolean and bit-vector variables: the checks with hints are then made by the SAT core. Otherwise, the solver is the one of Z3_mk_solver.
+ * @return Z3_solver The solver.
+ */
+Z3_solver make_hinted_solver(Z3_context ctx, bool finite_domain);
+
+/**
+ * @brief Same as check_solver, but first tries the literals @p hints as assumptions, with at most @p max_conflicts conflicts: a warm start, when they are likely to be part of a model.
+ * If this check is not conclusive (the hints contradict the assertions of @p s, or the conflicts run out), @p s is checked again without them: the result does not depend on the hints, only the time spent.
+ *
+ * @param ctx The context of the solver.
+ * @param s The solver.
+ * @param num_hints The number of hints (check_solver is called if 0).
+ * @param hints The hints.
+ * @param max_conflicts The maximal number of conflicts of the check with the hints.
+ * @param model A pointer towards a model. Will contain a model of the assertions of @p s if they are satisfiable (otherwise, will not be modified).
+ * @param stats The statistics to fill. If NULL, nothing is collected.
+ * @return Z3_lbool Z3_L_FALSE if the assertions of @p s are unsatisfiable, Z3_L_TRUE if they are satisfiable and Z3_L_UNDEF if the solver cannot decide.
+ */
+Z3_lbool check_solver_with_hints(Z3_context ctx, Z3_solver s, int num_hints, Z3_ast *hints, unsigned max_conflicts, Z3_model *model, solver_statistics *stats);
+
+/**
+ * @brief Fills @p stats with the statistics of solver @p s (the key names differ between the SAT and SMT cores of Z3, both are handled).
+ *
+ * @param ctx The context of the solver.
+ * @param s A solver on which a check has been performed.
+ * @param stats The statistics to fill.
+ */
+void get_solver_statistics(Z3_context ctx, Z3_solver s, solver_statistics *stats);
+
 /**
  * @brief Returns the truth value of the formula @p variable in the variable assignment @p model. Very usefull if @p variable is a formula containing a single variable.
  * 
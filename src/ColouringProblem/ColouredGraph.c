@@ -8,8 +8,11 @@
 
 struct ColouredGraph_s
 {
-    Graph graph;  ///< The graph.
-    int *colours; ///< The colours associated to each node.
+    Graph graph;          ///< The graph.
+    int *colours;         ///< The colours associated to each node.
+    bool *removed_nodes;  ///< True for the nodes of graph removed by cg_remove_node (NULL if none).
+    bool *removed_edges;  ///< True for the edges of graph removed by cg_remove_edge, indexed by graph_get_edge_index (NULL if none).
+    int num_edges;        ///< Number of edges not removed.
 };
 
 ColouredGraph cg_initialize(Graph graph)
@@ -20,9 +23,62 @@ ColouredGraph cg_initialize(Graph graph)
     result->colours = (int *)malloc(num_nodes * sizeof(int));
     for (int node = 0; node < num_nodes; node++)
         result->colours[node] = -1;
+    result->removed_nodes = NULL;
+    result->removed_edges = NULL;
+    result->num_edges = graph_num_edges(graph);
     return result;
 }
 
+/**
+ * @brief Returns a copy of the @p size booleans of @p mask (or NULL if @p mask is NULL).
+ *
+ */
+static bool *cg_copy_mask(const bool *mask, int size)
+{
+    if (mask == NULL)
+        return NULL;
+    bool *copy = (bool *)malloc(size * sizeof(bool));
+    memcpy(copy, mask, size * sizeof(bool));
+    return copy;
+}
+
+ColouredGraph cg_derive(ColouredGraph graph)
+{
+    ColouredGraph result = (ColouredGraph)malloc(sizeof(*result));
+    int num_nodes = graph_num_nodes(graph->graph);
+    *result = *graph;
+    result->colours = (int *)malloc(num_nodes * sizeof(int));
+    memcpy(result->colours, graph->colours, num_nodes * sizeof(int));
+    result->removed_nodes = cg_copy_mask(graph->removed_nodes, num_nodes);
+    result->removed_edges = cg_copy_mask(graph->removed_edges, graph->graph.edgeOffsets[num_nodes]);
+    return result;
+}
+
+void cg_remove_node(ColouredGraph graph, int node)
+{
+    int num_successors;
+    const int *successors = graph_get_successors(graph->graph, node, &num_successors);
+    for (int i = 0; i < num_successors; i++)
+        if (cg_is_edge(graph, node, successors[i]))
+            graph->num_edges--;
+    if (graph->removed_nodes == NULL)
+        graph->removed_nodes = (bool *)calloc(graph_num_nodes(graph->graph), sizeof(bool));
+    graph->removed_nodes[node] = true;
+}
+
+void cg_remove_edge(ColouredGraph graph, int source, int target)
+{
+    if (!cg_is_edge(graph, source, target))
+        return;
+    if (graph->removed_edges == NULL)
+        graph->removed_edges = (bool *)calloc(graph->graph.edgeOffsets[graph_num_nodes(graph->graph)], sizeof(bool));
+    graph->removed_edges[graph_get_edge_index(graph->graph, source, target)] = true;
+    int reverse = graph_get_edge_index(graph->graph, target, source);
+    if (reverse >= 0)
+        graph->removed_edges[reverse] = true;
+    graph->num_edges--;
+}
+
 void cg_print(ColouredGraph graph)
 {
     graph_print(graph->graph);
@@ -41,6 +97,8 @@ void cg_print_colors(ColouredGraph graph)
 void cg_delete(ColouredGraph graph)
 {
     free(graph->colours);
+    free(graph->removed_nodes);
+    free(graph->removed_edges);
     free(graph);
 }
 
@@ -51,12 +109,32 @@ int cg_get_num_nodes(ColouredGraph graph)
 
 int cg_get_num_edges(ColouredGraph graph)
 {
-    return graph_num_edges(graph->graph);
+    return graph->num_edges;
 }
 
 bool cg_is_edge(ColouredGraph graph, int source, int target)
 {
-    return (graph_is_edge(graph->graph, source, target));
+    int edge = graph_get_edge_index(graph->graph, source, target);
+    if (edge < 0)
+        return false;
+    if (graph->removed_nodes != NULL && (graph->removed_nodes[source] || graph->removed_nodes[target]))
+        return false;
+    return graph->removed_edges == NULL || !graph->removed_edges[edge];
+}
+
+BitMatrix cg_get_adjacency_matrix(ColouredGraph graph)
+{
+    int num_nodes = graph_num_nodes(graph->graph);
+    BitMatrix matrix = bit_matrix_create(num_nodes, num_nodes);
+    for (int node = 0; node < num_nodes; node++)
+    {
+        int num_successors;
+        const int *successors = graph_get_successors(graph->graph, node, &num_successors);
+        for (int i = 0; i < num_successors; i++)
+            if (cg_is_edge(graph, node, successors[i]))
+                bit_matrix_set(matrix, node, successors[i]);
+    }
+    return matrix;
 }
 
 char *cg_get_node_name(ColouredGraph graph, int node)
@@ -154,13 +232,15 @@ void cg_create_dot(ColouredGraph graph, char *name)
 
     for (int node = 0; node < num_nodes; node++)
     {
-        for (int node2 = 0; node2 < node; node2++)
+        int num_successors;
+        const int *successors = graph_get_successors(graph->graph, node, &num_successors);
+        for (int edge = 0; edge < num_successors && successors[edge] < node; edge++)
         {
-            if (graph_is_edge(graph->graph, node, node2))
-            {
-                fprintf(file, "%s -- %s", graph_get_node_name(graph->graph, node), graph_get_node_name(graph->graph, node2));
-                fprintf(file, ";\n");
-            }
+            int node2 = successors[edge];
+            if (!cg_is_edge(graph, node, node2))
+                continue;
+            fprintf(file, "%s -- %s", graph_get_node_name(graph->graph, node), graph_get_node_name(graph->graph, node2));
+            fprintf(file, ";\n");
         }
     }
 
@@ -2,44 +2,70 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+/**
+ * @brief Largest number of nodes for which the brute force builds the adjacency matrix of the graph (which takes N²/8 bytes, 32MB at that size). Above it, neighbours are checked one by one.
+ *
+ */
+#define ColouringMatrixMaxNodes 16384
+
+/**
+ * @brief Tells whether @p node has a neighbour smaller than itself coloured with @p col.
+ *
+ * @param graph A ColouredGraph.
+ * @param adjacency The adjacency matrix of @p graph (NULL if it has not been built).
+ * @param colour_sets For each colour, the bitset of the nodes having it (NULL if @p adjacency is NULL).
+ * @param node A node.
+ * @param col A colour.
+ * @return true If @p col conflicts with a neighbour of @p node.
+ */
+static bool colour_conflicts(ColouredGraph graph, BitMatrix adjacency, uint64_t **colour_sets, int node, int col)
+{
+    if (adjacency != NULL)
+        return bitset_intersects(bit_matrix_row(adjacency, node), colour_sets[col], bit_matrix_row_words(adjacency));
+
+    for (int n = 0; n < node; n++)
+    {
+        if (!cg_is_edge(graph, node, n))
+            continue;
+        if (cg_get_node_colour(graph, n) == col)
+            return true;
+    }
+    return false;
+}
+
 /**
  * @brief Recursive implementation of a brute force. Performs a depth-first search of a colouring, and prunes branches as soon as an inconsistency is detected. As such, if a full colouring is reached, it is a correct one.
  * Puts the colouring inside @p graph if a valid one exists, otherwise sets all colours to -1.
- * 
+ * A conflict with the neighbours is checked with one intersection of the row of the node in @p adjacency with the set of nodes having the colour tried, a word of 64 nodes at a time.
+ *
  * @param graph A ColouredGraph.
+ * @param adjacency The adjacency matrix of @p graph (NULL to check neighbours one by one).
+ * @param colour_sets For each colour, the bitset of the nodes smaller than @p node having it (NULL if @p adjacency is NULL).
  * @param num_colours The expected number of colours.
  * @param node The node we are trying to colour.
  * @return true If there exist a colouring starting with the partial colouring given.
  * @return false Otherwise.
  * @pre All nodes smaller than @p node are already coloured without contradiction.
  */
-bool recursive_bf(ColouredGraph graph, int num_colours, int node)
+bool recursive_bf(ColouredGraph graph, BitMatrix adjacency, uint64_t **colour_sets, int num_colours, int node)
 {
     int num_nodes = cg_get_num_nodes(graph);
     if (node == num_nodes)
         return true;
     for (int col = 0; col < num_colours; col++)
     {
-        cg_set_node_colour(graph, node, col);
-        bool same_colour_as_neighbour = false;
-        for (int n = 0; n < node; n++)
-        {
-            if (!cg_is_edge(graph, node, n))
-                continue;
-            int col_n = cg_get_node_colour(graph, n);
-            if (col_n == col)
-            {
-                same_colour_as_neighbour = true;
-                break;
-            }
-        }
-        if (same_colour_as_neighbour)
+        if (colour_conflicts(graph, adjacency, colour_sets, node, col))
             continue;
-        bool res = recursive_bf(graph, num_colours, node + 1);
+        cg_set_node_colour(graph, node, col);
+        if (colour_sets != NULL)
+            BitsetSet(colour_sets[col], node);
+        bool res = recursive_bf(graph, adjacency, colour_sets, num_colours, node + 1);
         if (res)
             return true;
+        if (colour_sets != NULL)
+            BitsetClear(colour_sets[col], node);
         if (node == 0)
-            return false;
+            break;
     }
     cg_set_node_colour(graph, node, -1);
     return false;
@@ -47,5 +73,21 @@ bool recursive_bf(ColouredGraph graph, int num_colours, int node)
 
 bool colouring_brute_force(ColouredGraph graph, int num_colours)
 {
-    return recursive_bf(graph, num_colours, 0);
-}
\ No newline at end of file
+    int num_nodes = cg_get_num_nodes(graph);
+    if (num_nodes > ColouringMatrixMaxNodes || num_colours <= 0)
+        return recursive_bf(graph, NULL, NULL, num_colours, 0);
+
+    BitMatrix adjacency = cg_get_adjacency_matrix(graph);
+    int num_words = bit_matrix_row_words(adjacency);
+    uint64_t **colour_sets = (uint64_t **)malloc(num_colours * sizeof(uint64_t *));
+    for (int col = 0; col < num_colours; col++)
+        colour_sets[col] = (uint64_t *)calloc(num_words, sizeof(uint64_t));
+
+    bool res = recursive_bf(graph, adjacency, colour_sets, num_colours, 0);
+
+    for (int col = 0; col < num_colours; col++)
+        free(colour_sets[col]);
+    free(colour_sets);
+    bit_matrix_delete(adjacency);
+    return res;
+}
@@ -0,0 +1,217 @@
+#include "TunnelAStar.h"
+#include "TunnelBF.h"
+#include "Arena.h"
+#include <stdlib.h>
+
+/**
+ * @brief A partial path, stored as its last step and the partial path before it.
+ *
+ */
+typedef struct astar_path
+{
+    const struct astar_path *parent; ///< The path without its last step (NULL for the empty path).
+    int node;                        ///< The node reached.
+    int length;                      ///< g: the number of steps.
+    int estimate;                    ///< g + h.
+    long order;                      ///< Creation order, to break ties.
+    stack_action action;             ///< The action of the last step.
+    tn_packed_stack stack;           ///< The stack reached.
+} astar_path;
+
+/**
+ * @brief The queue of partial paths to expand (a binary heap).
+ *
+ */
+typedef struct
+{
+    astar_path **paths;
+    int count;
+    int capacity;
+} astar_queue;
+
+/**
+ * @brief Tells whether @p first must be expanded before @p second: smaller estimate first, then longer path (closer to a goal), then older path.
+ *
+ */
+static bool astar_before(const astar_path *first, const astar_path *second)
+{
+    if (first->estimate != second->estimate)
+        return first->estimate < second->estimate;
+    if (first->length != second->length)
+        return first->length > second->length;
+    return first->order < second->order;
+}
+
+static void astar_push(astar_queue *queue, astar_path *path)
+{
+    if (queue->count == queue->capacity)
+    {
+        queue->capacity = queue->capacity == 0 ? 256 : 2 * queue->capacity;
+        queue->paths = (astar_path **)realloc(queue->paths, queue->capacity * sizeof(astar_path *));
+    }
+    int i = queue->count++;
+    while (i > 0 && astar_before(path, queue->paths[(i - 1) / 2]))
+    {
+        queue->paths[i] = queue->paths[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    queue->paths[i] = path;
+}
+
+static astar_path *astar_pop(astar_queue *queue)
+{
+    astar_path *first = queue->paths[0];
+    astar_path *last = queue->paths[--queue->count];
+    int i = 0;
+    while (2 * i + 1 < queue->count)
+    {
+        int child = 2 * i + 1;
+        if (child + 1 < queue->count && astar_before(queue->paths[child + 1], queue->paths[child]))
+            child++;
+        if (!astar_before(queue->paths[child], last))
+            break;
+        queue->paths[i] = queue->paths[child];
+        i = child;
+    }
+    queue->paths[i] = last;
+    return first;
+}
+
+/**
+ * @brief Computes, for each node of @p network, the number of edges of a shortest path to the final node (-1 if it cannot be reached), by a breadth-first search over the reversed edges.
+ *
+ * @return int* The distances (num_nodes cells), to free.
+ */
+static int *astar_distances_to_final(TunnelNetwork network)
+{
+    int num_nodes = tn_get_num_nodes(network);
+
+    // predecessors of each node, in compressed sparse rows.
+    int *offsets = (int *)calloc(num_nodes + 1, sizeof(int));
+    for (int node = 0; node < num_nodes; node++)
+    {
+        int num_successors;
+        const int *successors = tn_get_successors(network, node, &num_successors);
+        for (int i = 0; i < num_successors; i++)
+            offsets[successors[i] + 1]++;
+    }
+    for (int node = 0; node < num_nodes; node++)
+        offsets[node + 1] += offsets[node];
+    int *fill = (int *)malloc(num_nodes * sizeof(int));
+    for (int node = 0; node < num_nodes; node++)
+        fill[node] = offsets[node];
+    int *predecessors = (int *)malloc(offsets[num_nodes] * sizeof(int));
+    for (int node = 0; node < num_nodes; node++)
+    {
+        int num_successors;
+        const int *successors = tn_get_successors(network, node, &num_successors);
+        for (int i = 0; i < num_successors; i++)
+            predecessors[fill[successors[i]]++] = node;
+    }
+
+    int *distances = (int *)malloc(num_nodes * sizeof(int));
+    for (int node = 0; node < num_nodes; node++)
+        distances[node] = -1;
+    int *queue = fill;
+    int head = 0, tail = 0;
+    distances[tn_get_final(network)] = 0;
+    queue[tail++] = tn_get_final(network);
+    while (head < tail)
+    {
+        int node = queue[head++];
+        for (int i = offsets[node]; i < offsets[node + 1]; i++)
+            if (distances[predecessors[i]] == -1)
+            {
+                distances[predecessors[i]] = distances[node] + 1;
+                queue[tail++] = predecessors[i];
+            }
+    }
+
+    free(queue);
+    free(predecessors);
+    free(offsets);
+    return distances;
+}
+
+/**
+ * @brief Tells whether @p node is visited by @p path.
+ *
+ */
+static bool astar_visits(const astar_path *path, int node)
+{
+    for (; path != NULL; path = path->parent)
+        if (path->node == node)
+            return true;
+    return false;
+}
+
+int tn_astar_search(TunnelNetwork network, int length, tn_step *path)
+{
+    if (length > 2 * TnMaxPackedHeight)
+        return tn_brute_force(network, length, path);
+
+    int *distances = astar_distances_to_final(network);
+    int initial = tn_get_initial(network);
+    int final = tn_get_final(network);
+    if (distances[initial] < 0 || distances[initial] > length)
+    {
+        free(distances);
+        return 0;
+    }
+
+    Arena arena = arena_create();
+    astar_queue queue = {NULL, 0, 0};
+    long order = 0;
+
+    astar_path *start = (astar_path *)arena_alloc(arena, sizeof(astar_path));
+    *start = (astar_path){NULL, initial, 0, distances[initial], order++, transmit_4, TnInitialStack};
+    astar_push(&queue, start);
+
+    int found = 0;
+    while (queue.count > 0)
+    {
+        astar_path *current = astar_pop(&queue);
+        if (current->node == final && current->stack == TnInitialStack && current->length > 0)
+        {
+            found = current->length;
+            for (const astar_path *step = current; step->parent != NULL; step = step->parent)
+                path[step->length - 1] = tn_step_create(step->action, step->parent->node, step->node);
+            break;
+        }
+        // as in tn_brute_force, a path stops at the final node once the stack is back to its initial content.
+        if (current->node == final && current->stack == TnInitialStack)
+            continue;
+
+        int enabled = tn_get_enabled_actions(network, current->node, tn_packed_top(current->stack));
+        int num_successors;
+        const int *successors = tn_get_successors(network, current->node, &num_successors);
+        for (int i = 0; i < num_successors; i++)
+        {
+            int next = successors[i];
+            if (distances[next] < 0 || astar_visits(current, next))
+                continue;
+            for (stack_action act = 0; act < NumActions; act++)
+            {
+                if (!(enabled & (1 << act)))
+                    continue;
+                const tn_transition *transition = tn_packed_transition(current->stack, act);
+                if (!transition->valid)
+                    continue;
+                tn_packed_stack next_stack = tn_packed_apply(current->stack, transition);
+                int height = tn_packed_height(next_stack);
+                int estimate = current->length + 1 + (distances[next] > height ? distances[next] : height);
+                if (estimate > length)
+                    continue;
+
+                astar_path *child = (astar_path *)arena_alloc(arena, sizeof(astar_path));
+                *child = (astar_path){current, next, current->length + 1, estimate, order++, act, next_stack};
+                astar_push(&queue, child);
+            }
+        }
+    }
+
+    free(queue.paths);
+    arena_delete(arena);
+    free(distances);
+    return found;
+}
@@ -1,114 +1,27 @@
 #include "TunnelBF.h"
+#include "Metrics.h"
 #include <stdlib.h>
 #include <stdio.h>
 
 /**
- * @brief Applique une action sur la pile courante.
+ * @brief Compteurs de la dernière exploration.
  *
- * Cette fonction modélise exactement les règles définies dans l'épisode I :
- *  - @b transmit_a : le sommet doit être égal à a, la pile reste identique.
- *  - @b push_b_a   : le sommet doit être égal à a, on ajoute b au sommet.
- *  - @b pop_b_a    : la hauteur doit être >= 1, le sommet doit être b et l'élément en dessous doit être a.
- *
- * @param act        L'action à appliquer (transmit, push ou pop).
- * @param height     Hauteur actuelle de la pile.
- * @param stack      Pile courante.
- * @param new_height Hauteur après l'action (sortie).
- * @param next_stack Copie modifiée de la pile après l'action (sortie).
- *
- * @return 1 si l'action est applicable, 0 sinon.
  */
-static int apply_action(stack_action act,
-                        int height,
-                        int *stack,
-                        int *new_height,
-                        int *next_stack)
-{
-    int top = stack[height];
-
-    // Copier la pile courante dans next_stack
-    for (int i = 0; i <= height; i++)
-        next_stack[i] = stack[i];
-
-    *new_height = height;
+static tn_bf_stats bf_stats = {0};
 
-    switch (act)
-    {
-    /* ---------- TRANSMIT ---------- */
-    case transmit_4:
-        if (top != 4)
-            return 0;
-        return 1;
-
-    case transmit_6:
-        if (top != 6)
-            return 0;
-        return 1;
-
-    /* ------------ PUSH ------------ */
-    case push_4_4:
-        if (top != 4)
-            return 0;
-        *new_height = height + 1;
-        next_stack[*new_height] = 4;
-        return 1;
-
-    case push_4_6:
-        if (top != 4)
-            return 0;
-        *new_height = height + 1;
-        next_stack[*new_height] = 6;
-        return 1;
-
-    case push_6_4:
-        if (top != 6)
-            return 0;
-        *new_height = height + 1;
-        next_stack[*new_height] = 4;
-        return 1;
-
-    case push_6_6:
-        if (top != 6)
-            return 0;
-        *new_height = height + 1;
-        next_stack[*new_height] = 6;
-        return 1;
-
-    /* ------------ POP ------------ */
-    case pop_4_4:
-        if (height < 1)
-            return 0;
-        if (stack[height] != 4 || stack[height - 1] != 4)
-            return 0;
-        *new_height = height - 1;
-        return 1;
-
-    case pop_4_6:
-        if (height < 1)
-            return 0;
-        if (stack[height] != 6 || stack[height - 1] != 4)
-            return 0;
-        *new_height = height - 1;
-        return 1;
-
-    case pop_6_4:
-        if (height < 1)
-            return 0;
-        if (stack[height] != 4 || stack[height - 1] != 6)
-            return 0;
-        *new_height = height - 1;
-        return 1;
-
-    case pop_6_6:
-        if (height < 1)
-            return 0;
-        if (stack[height] != 6 || stack[height - 1] != 6)
-            return 0;
-        *new_height = height - 1;
-        return 1;
-    }
+/**
+ * @brief Exécute @p statement uniquement si la télémétrie est compilée (TN_BF_STATS), pour ne rien coûter sinon.
+ *
+ */
+#ifdef TN_BF_STATS
+#define BF_STAT(statement) statement
+#else
+#define BF_STAT(statement)
+#endif
 
-    return 0;
+const tn_bf_stats *tn_brute_force_stats(void)
+{
+    return &bf_stats;
 }
 
 /**
@@ -123,7 +36,7 @@ static int apply_action(stack_action act,
  * @param pos         Profondeur actuelle (nombre d'arêtes déjà parcourues).
  * @param max_length  Longueur maximale autorisée du chemin.
  * @param height      Hauteur actuelle de la pile.
- * @param stack       Pile courante.
+ * @param stack       Pile courante (modifiée pendant l'exploration, restaurée au retour).
  * @param visited     Tableau indiquant quels noeuds ont déjà été visités.
  * @param path        Tableau dans lequel stocker le chemin trouvé.
  *
@@ -134,42 +47,68 @@ static int dfs(TunnelNetwork net,
                int pos,
                int max_length,
                int height,
-               int *stack,
+               stack_symbol *stack,
                int *visited,
                tn_step *path)
 {
-    if (node == tn_get_final(net) && height == 0 && stack[0] == 4)
+    if (node == tn_get_final(net) && height == 0 && stack[0] == symbol_4)
         return pos;
 
     if (pos == max_length)
         return 0;
 
+    BF_STAT(bf_stats.nodes_expanded++);
+    BF_STAT(if (pos > bf_stats.max_depth) bf_stats.max_depth = pos);
+    BF_STAT(if (height > bf_stats.max_stack_height) bf_stats.max_stack_height = height);
+
     visited[node] = 1;
 
-    int N = tn_get_num_nodes(net);
+    int num_successors;
+    const int *successors = tn_get_successors(net, node, &num_successors);
 
-    for (int next = 0; next < N; next++)
+    /* Seules les actions du nœud compatibles avec le sommet sont essayées ; la table donne l'effet de chacune. */
+    int enabled = tn_get_enabled_actions(net, node, stack[height]);
+    const tn_transition *transitions[NumActions];
+    for (stack_action act = 0; act < NumActions; act++)
+        transitions[act] = &tn_transition_table[act][stack[height]][height > 0 ? stack[height - 1] : symbol_none];
+
+    for (int i = 0; i < num_successors; i++)
     {
-        if (!tn_is_edge(net, node, next))
-            continue;
+        int next = successors[i];
 
         if (visited[next])
+        {
+            BF_STAT(bf_stats.visited_prunes++);
             continue;
+        }
 
         for (stack_action act = 0; act < NumActions; act++)
         {
-            if (!tn_node_has_action(net, node, act))
+            if (!(enabled & (1 << act)))
+            {
+                /* Une action du nœud écartée par le masque compte quand même comme essayée puis rejetée. */
+                BF_STAT(if (tn_node_has_action(net, node, act)) { bf_stats.actions_tried++; bf_stats.actions_rejected++; });
                 continue;
+            }
 
-            int next_height;
-            int next_stack[256];
+            const tn_transition *transition = transitions[act];
 
-            if (!apply_action(act, height, stack, &next_height, next_stack))
+            BF_STAT(bf_stats.actions_tried++);
+            if (!transition->valid)
+            {
+                BF_STAT(bf_stats.actions_rejected++);
                 continue;
+            }
 
             path[pos] = tn_step_create(act, node, next);
 
-            int res = dfs(net, next, pos + 1, max_length, next_height, next_stack, visited, path);
+            /* La pile est partagée : on écrit le nouveau sommet en place et on restaure la case au retour. */
+            int next_height = height + transition->height_delta;
+            stack_symbol saved = stack[next_height];
+            stack[next_height] = transition->new_top;
+
+            int res = dfs(net, next, pos + 1, max_length, next_height, stack, visited, path);
+            stack[next_height] = saved;
             if (res > 0)
             {
                 visited[node] = 0;
@@ -197,30 +136,204 @@ static int dfs(TunnelNetwork net,
  */
 int tn_brute_force(TunnelNetwork network, int length, tn_step *path)
 {
-    int visited[256];
-    int stack[256];
+    /* Une case par nœud, et au plus une case empilée par pas. */
+    int *visited = (int *)calloc(tn_get_num_nodes(network), sizeof(int));
+    stack_symbol *stack = (stack_symbol *)malloc((length + 1) * sizeof(stack_symbol));
 
     int start = tn_get_initial(network);
 
+    free(bf_stats.length_seconds);
+    bf_stats = (tn_bf_stats){0};
+    BF_STAT(bf_stats.length_seconds = (double *)calloc(length, sizeof(double)));
+
     for (int L = 1; L <= length; L++)
     {
-        stack[0] = 4;
-
-        for (int i = 0; i < 256; i++)
-            visited[i] = 0;
+        BF_STAT(double length_start = metrics_now());
+        BF_STAT(bf_stats.num_lengths = L);
+        stack[0] = symbol_4;
 
         tn_step temp[L];
 
         int res = dfs(network, start, 0, L, 0, stack, visited, temp);
 
+        BF_STAT(bf_stats.length_seconds[L - 1] = metrics_now() - length_start);
+
         if (res == L)
         {
             for (int i = 0; i < L; i++)
                 path[i] = temp[i];
 
+            free(visited);
+            free(stack);
             return L;
         }
     }
 
+    free(visited);
+    free(stack);
     return 0;
 }
+
+/**
+ * @brief État de la recherche bornée de tn_brute_force_hint.
+ *
+ */
+typedef struct
+{
+    TunnelNetwork net;
+    int length;          ///< Longueur exacte du chemin cherché.
+    long budget;         ///< Nombre d'états qu'il reste à développer.
+    int *to_final;       ///< Distance de chaque noeud au noeud final (-1 s'il ne l'atteint pas).
+    int *visited;        ///< Noeuds du préfixe courant.
+    stack_symbol *stack; ///< Pile courante.
+    tn_step *current;    ///< Préfixe courant.
+    tn_step *best;       ///< Plus long préfixe rencontré.
+    int best_length;     ///< Longueur de best.
+} bf_hint_search;
+
+/**
+ * @brief Calcule la distance (en nombre d'arêtes) de chaque noeud au noeud final, par un parcours en largeur des arêtes inversées.
+ *
+ * @return int* Les distances (-1 pour un noeud qui n'atteint pas le noeud final), à libérer.
+ */
+static int *bf_distances_to_final(TunnelNetwork net)
+{
+    int num_nodes = tn_get_num_nodes(net);
+
+    /* Prédécesseurs de chaque noeud, en lignes compressées. */
+    int *offsets = (int *)calloc(num_nodes + 1, sizeof(int));
+    for (int node = 0; node < num_nodes; node++)
+    {
+        int num_successors;
+        const int *successors = tn_get_successors(net, node, &num_successors);
+        for (int i = 0; i < num_successors; i++)
+            offsets[successors[i] + 1]++;
+    }
+    for (int node = 0; node < num_nodes; node++)
+        offsets[node + 1] += offsets[node];
+    int *queue = (int *)malloc(num_nodes * sizeof(int));
+    for (int node = 0; node < num_nodes; node++)
+        queue[node] = offsets[node];
+    int *predecessors = (int *)malloc((offsets[num_nodes] + 1) * sizeof(int));
+    for (int node = 0; node < num_nodes; node++)
+    {
+        int num_successors;
+        const int *successors = tn_get_successors(net, node, &num_successors);
+        for (int i = 0; i < num_successors; i++)
+            predecessors[queue[successors[i]]++] = node;
+    }
+
+    int *distances = (int *)malloc(num_nodes * sizeof(int));
+    for (int node = 0; node < num_nodes; node++)
+        distances[node] = -1;
+    int head = 0, tail = 0;
+    distances[tn_get_final(net)] = 0;
+    queue[tail++] = tn_get_final(net);
+    while (head < tail)
+    {
+        int node = queue[head++];
+        for (int i = offsets[node]; i < offsets[node + 1]; i++)
+            if (distances[predecessors[i]] == -1)
+            {
+                distances[predecessors[i]] = distances[node] + 1;
+                queue[tail++] = predecessors[i];
+            }
+    }
+
+    free(queue);
+    free(predecessors);
+    free(offsets);
+    return distances;
+}
+
+/**
+ * @brief Recherche récursive (DFS) bornée d'un chemin simple valide de longueur exactement search->length, qui garde le plus long préfixe rencontré.
+ * Un noeud n'est développé que s'il peut encore atteindre le noeud final dans les pas restants (par sa distance, et par la hauteur de la pile, qui diminue d'au plus un par pas).
+ *
+ * @param search État de la recherche.
+ * @param node   Noeud courant.
+ * @param pos    Nombre de pas du préfixe courant.
+ * @param height Hauteur actuelle de la pile.
+ * @return true si un chemin a été trouvé (il est alors dans search->best).
+ */
+static bool hint_dfs(bf_hint_search *search, int node, int pos, int height)
+{
+    if (pos > search->best_length)
+    {
+        for (int i = 0; i < pos; i++)
+            search->best[i] = search->current[i];
+        search->best_length = pos;
+    }
+
+    int remaining = search->length - pos;
+    if (remaining == 0)
+        return node == tn_get_final(search->net) && height == 0;
+    if (search->budget == 0 || node == tn_get_final(search->net))
+        return false;
+    search->budget--;
+
+    search->visited[node] = 1;
+
+    int num_successors;
+    const int *successors = tn_get_successors(search->net, node, &num_successors);
+    stack_symbol *stack = search->stack;
+    int enabled = tn_get_enabled_actions(search->net, node, stack[height]);
+
+    for (int i = 0; i < num_successors; i++)
+    {
+        int next = successors[i];
+        int distance = search->to_final[next];
+        if (search->visited[next] || distance == -1 || distance > remaining - 1)
+            continue;
+
+        for (stack_action act = 0; act < NumActions; act++)
+        {
+            if (!(enabled & (1 << act)))
+                continue;
+
+            const tn_transition *transition = &tn_transition_table[act][stack[height]][height > 0 ? stack[height - 1] : symbol_none];
+            int next_height = height + transition->height_delta;
+            if (!transition->valid || next_height > remaining - 1)
+                continue;
+
+            search->current[pos] = tn_step_create(act, node, next);
+
+            stack_symbol saved = stack[next_height];
+            stack[next_height] = transition->new_top;
+            bool found = hint_dfs(search, next, pos + 1, next_height);
+            stack[next_height] = saved;
+            if (found)
+            {
+                search->visited[node] = 0;
+                return true;
+            }
+        }
+    }
+
+    search->visited[node] = 0;
+    return false;
+}
+
+int tn_brute_force_hint(TunnelNetwork network, int length, long budget, tn_step *path)
+{
+    bf_hint_search search;
+    search.net = network;
+    search.length = length;
+    search.budget = budget;
+    search.to_final = bf_distances_to_final(network);
+    search.visited = (int *)calloc(tn_get_num_nodes(network), sizeof(int));
+    search.stack = (stack_symbol *)malloc((length + 1) * sizeof(stack_symbol));
+    search.current = (tn_step *)malloc(length * sizeof(tn_step));
+    search.best = path;
+    search.best_length = 0;
+
+    search.stack[0] = symbol_4;
+    if (search.to_final[tn_get_initial(network)] != -1 && search.to_final[tn_get_initial(network)] <= length)
+        hint_dfs(&search, tn_get_initial(network), 0, 0);
+
+    free(search.to_final);
+    free(search.visited);
+    free(search.stack);
+    free(search.current);
+    return search.best_length;
+}
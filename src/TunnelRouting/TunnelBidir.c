@@ -0,0 +1,273 @@
+#include "TunnelBidir.h"
+#include "TunnelBF.h"
+#include "Arena.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief A first half: a simple path from the initial state, stored in the table by its last state.
+ *
+ */
+typedef struct
+{
+    int node;              ///< The last node.
+    tn_packed_stack stack; ///< The last stack.
+    int next;              ///< The next half of the same bucket (-1 for the last one).
+    int *nodes;            ///< The nodes visited (half_length + 1 cells, in the arena).
+    stack_action *actions; ///< The actions performed (half_length cells, in the arena).
+} bidir_half;
+
+/**
+ * @brief A search over a network.
+ *
+ */
+typedef struct
+{
+    TunnelNetwork network;
+    int initial;
+    int final;
+    int *predecessor_offsets; ///< The predecessors of u are predecessors[predecessor_offsets[u]] to predecessors[predecessor_offsets[u+1]-1].
+    int *predecessors;
+    int half_length;          ///< Number of steps of the first halves stored.
+    bidir_half *halves;       ///< The first halves.
+    int count;                ///< Number of halves.
+    int capacity;             ///< Size of halves.
+    int *buckets;             ///< First half of each bucket (-1 if none).
+    int num_buckets;          ///< Size of buckets (a power of 2).
+    Arena arena;              ///< The memory of the nodes and actions of the halves.
+    bool *visited;            ///< The nodes of the partial path being enumerated.
+    int *nodes;               ///< The nodes of the partial path being enumerated, by position.
+    stack_action *actions;    ///< The actions of the partial path being enumerated, by position.
+} bidir_search;
+
+static int bidir_bucket(const bidir_search *search, int node, tn_packed_stack stack)
+{
+    uint64_t key = (stack * 0x9E3779B97F4A7C15ull) ^ ((uint64_t)node * 0xC2B2AE3D27D4EB4Full);
+    return (int)((key ^ (key >> 29)) & (uint64_t)(search->num_buckets - 1));
+}
+
+/**
+ * @brief Adds the partial path of search->nodes and search->actions (of search->half_length steps) to the table.
+ *
+ */
+static void bidir_store(bidir_search *search, tn_packed_stack stack)
+{
+    if (search->count == search->capacity)
+    {
+        search->capacity = search->capacity == 0 ? 256 : 2 * search->capacity;
+        search->halves = (bidir_half *)realloc(search->halves, search->capacity * sizeof(bidir_half));
+    }
+    if (search->count >= search->num_buckets)
+    {
+        search->num_buckets *= 2;
+        search->buckets = (int *)realloc(search->buckets, search->num_buckets * sizeof(int));
+        memset(search->buckets, -1, search->num_buckets * sizeof(int));
+        for (int i = 0; i < search->count; i++)
+        {
+            int bucket = bidir_bucket(search, search->halves[i].node, search->halves[i].stack);
+            search->halves[i].next = search->buckets[bucket];
+            search->buckets[bucket] = i;
+        }
+    }
+
+    int length = search->half_length;
+    bidir_half *half = &search->halves[search->count];
+    half->node = search->nodes[length];
+    half->stack = stack;
+    half->nodes = (int *)arena_alloc(search->arena, (length + 1) * sizeof(int));
+    memcpy(half->nodes, search->nodes, (length + 1) * sizeof(int));
+    half->actions = (stack_action *)arena_alloc(search->arena, length * sizeof(stack_action));
+    memcpy(half->actions, search->actions, length * sizeof(stack_action));
+    int bucket = bidir_bucket(search, half->node, stack);
+    half->next = search->buckets[bucket];
+    search->buckets[bucket] = search->count++;
+}
+
+/**
+ * @brief Stores all the simple paths of search->half_length steps which extend the partial path ending in (@p node, @p stack) at position @p pos. The stack must be emptied by position @p max_length.
+ *
+ */
+static void bidir_forward(bidir_search *search, int node, tn_packed_stack stack, int pos, int max_length)
+{
+    search->nodes[pos] = node;
+    if (pos == search->half_length)
+    {
+        bidir_store(search, stack);
+        return;
+    }
+    // the final node ends the second half, so a first half cannot pass through it.
+    if (node == search->final)
+        return;
+
+    search->visited[node] = true;
+    int enabled = tn_get_enabled_actions(search->network, node, tn_packed_top(stack));
+    int num_successors;
+    const int *successors = tn_get_successors(search->network, node, &num_successors);
+    for (int i = 0; i < num_successors; i++)
+    {
+        int next = successors[i];
+        if (search->visited[next])
+            continue;
+        for (stack_action act = 0; act < NumActions; act++)
+        {
+            const tn_transition *transition = tn_packed_transition(stack, act);
+            if (!(enabled & (1 << act)) || !transition->valid)
+                continue;
+            tn_packed_stack next_stack = tn_packed_apply(stack, transition);
+            if (tn_packed_height(next_stack) > max_length - (pos + 1))
+                continue;
+            search->actions[pos] = act;
+            bidir_forward(search, next, next_stack, pos + 1, max_length);
+        }
+    }
+    search->visited[node] = false;
+}
+
+/**
+ * @brief Looks for a first half ending in (@p node, @p stack) and disjoint from the second half of search->nodes, which starts at position search->half_length.
+ *
+ * @return bool True iff one has been found (the whole path is then in @p path).
+ */
+static bool bidir_join(bidir_search *search, int node, tn_packed_stack stack, int length, tn_step *path)
+{
+    int half_length = search->half_length;
+    for (int i = search->buckets[bidir_bucket(search, node, stack)]; i != -1; i = search->halves[i].next)
+    {
+        const bidir_half *half = &search->halves[i];
+        if (half->node != node || half->stack != stack)
+            continue;
+        bool disjoint = true;
+        for (int pos = 0; pos < half_length && disjoint; pos++)
+            disjoint = !search->visited[half->nodes[pos]];
+        if (!disjoint)
+            continue;
+
+        for (int pos = 0; pos < half_length; pos++)
+            path[pos] = tn_step_create(half->actions[pos], half->nodes[pos], half->nodes[pos + 1]);
+        for (int pos = half_length; pos < length; pos++)
+            path[pos] = tn_step_create(search->actions[pos], search->nodes[pos], search->nodes[pos + 1]);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Enumerates backward the second halves which end in the final state at position @p length and reach (@p node, @p stack) at position @p pos, and joins them with the first halves.
+ *
+ * @return bool True iff a path has been found (it is then in @p path).
+ */
+static bool bidir_backward(bidir_search *search, int node, tn_packed_stack stack, int pos, int length, tn_step *path)
+{
+    search->nodes[pos] = node;
+    if (pos == search->half_length)
+        return bidir_join(search, node, stack, length, path);
+
+    search->visited[node] = true;
+    for (int i = search->predecessor_offsets[node]; i < search->predecessor_offsets[node + 1]; i++)
+    {
+        int previous = search->predecessors[i];
+        // the initial node is at position 0, which belongs to the first half.
+        if (search->visited[previous] || previous == search->initial)
+            continue;
+        for (stack_action act = 0; act < NumActions; act++)
+        {
+            tn_packed_stack previous_stack;
+            if (!tn_node_has_action(search->network, previous, act) || !tn_packed_unapply(stack, act, &previous_stack))
+                continue;
+            // the initial stack cannot grow higher than this in pos - 1 steps.
+            if (tn_packed_height(previous_stack) > pos - 1)
+                continue;
+            search->actions[pos - 1] = act;
+            if (bidir_backward(search, previous, previous_stack, pos - 1, length, path))
+            {
+                search->visited[node] = false;
+                return true;
+            }
+        }
+    }
+    search->visited[node] = false;
+    return false;
+}
+
+/**
+ * @brief Builds the predecessors of each node of search->network, in compressed sparse rows.
+ *
+ */
+static void bidir_build_predecessors(bidir_search *search, int num_nodes)
+{
+    search->predecessor_offsets = (int *)calloc(num_nodes + 1, sizeof(int));
+    for (int node = 0; node < num_nodes; node++)
+    {
+        int num_successors;
+        const int *successors = tn_get_successors(search->network, node, &num_successors);
+        for (int i = 0; i < num_successors; i++)
+            search->predecessor_offsets[successors[i] + 1]++;
+    }
+    for (int node = 0; node < num_nodes; node++)
+        search->predecessor_offsets[node + 1] += search->predecessor_offsets[node];
+
+    int *fill = (int *)malloc(num_nodes * sizeof(int));
+    memcpy(fill, search->predecessor_offsets, num_nodes * sizeof(int));
+    search->predecessors = (int *)malloc(search->predecessor_offsets[num_nodes] * sizeof(int));
+    for (int node = 0; node < num_nodes; node++)
+    {
+        int num_successors;
+        const int *successors = tn_get_successors(search->network, node, &num_successors);
+        for (int i = 0; i < num_successors; i++)
+            search->predecessors[fill[successors[i]]++] = node;
+    }
+    free(fill);
+}
+
+int tn_bidir_search(TunnelNetwork network, int length, tn_step *path)
+{
+    if (length > 2 * TnMaxPackedHeight)
+        return tn_brute_force(network, length, path);
+    if (length <= 0)
+        return 0;
+
+    int num_nodes = tn_get_num_nodes(network);
+    bidir_search search;
+    search.network = network;
+    search.initial = tn_get_initial(network);
+    search.final = tn_get_final(network);
+    bidir_build_predecessors(&search, num_nodes);
+    search.half_length = 0;
+    search.halves = NULL;
+    search.count = 0;
+    search.capacity = 0;
+    search.num_buckets = 256;
+    search.buckets = (int *)malloc(search.num_buckets * sizeof(int));
+    search.arena = NULL;
+    search.visited = (bool *)calloc(num_nodes, sizeof(bool));
+    search.nodes = (int *)malloc((length + 1) * sizeof(int));
+    search.actions = (stack_action *)malloc(length * sizeof(stack_action));
+
+    // the lengths 2k-1 and 2k share their first halves (of k steps), which are built once, for the larger length.
+    int found = 0;
+    for (int L = 1; L <= length && found == 0; L++)
+    {
+        int half_length = (L + 1) / 2;
+        if (half_length != search.half_length)
+        {
+            search.half_length = half_length;
+            search.count = 0;
+            memset(search.buckets, -1, search.num_buckets * sizeof(int));
+            arena_delete(search.arena);
+            search.arena = arena_create();
+            bidir_forward(&search, search.initial, TnInitialStack, 0, 2 * half_length);
+        }
+        if (search.count > 0 && bidir_backward(&search, search.final, TnInitialStack, L, L, path))
+            found = L;
+    }
+
+    free(search.actions);
+    free(search.nodes);
+    free(search.visited);
+    arena_delete(search.arena);
+    free(search.buckets);
+    free(search.halves);
+    free(search.predecessors);
+    free(search.predecessor_offsets);
+    return found;
+}
@@ -0,0 +1,167 @@
+#include "TunnelCubes.h"
+#include "TunnelPropagator.h"
+#include "Z3Tools.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+/**
+ * @brief The work shared by the threads of tn_solve_cubes.
+ *
+ */
+typedef struct
+{
+    TunnelNetwork network;
+    int length;
+    tn_stack_encoding encoding;
+    unsigned checks;
+    int num_cubes;
+    atomic_int next;        ///< The next cube to solve.
+    atomic_int num_workers; ///< The number of threads started, to number them.
+    atomic_int num_refuted; ///< The number of cubes shown unsatisfiable.
+    atomic_bool done;       ///< Set once the result is known: a model has been found, or the formula is unsatisfiable whatever the cube.
+    pthread_mutex_t mutex;  ///< Protects the fields below.
+    Z3_context *checking;   ///< The context of each thread while it checks a cube, NULL otherwise.
+    Z3_lbool result;        ///< The result, if done.
+    tn_step *path;          ///< The path found, if the result is Z3_L_TRUE.
+} tn_cube_work;
+
+/**
+ * @brief Ends the search of @p work with @p result (and @p path if it is Z3_L_TRUE), and interrupts the checks of the other threads. Only the first call has an effect.
+ *
+ */
+static void tn_cube_finish(tn_cube_work *work, Z3_lbool result, const tn_step *path)
+{
+    pthread_mutex_lock(&work->mutex);
+    if (!atomic_load(&work->done))
+    {
+        work->result = result;
+        if (result == Z3_L_TRUE)
+            for (int i = 0; i < work->length; i++)
+                work->path[i] = path[i];
+        atomic_store(&work->done, true);
+        for (int worker = 0; worker < atomic_load(&work->num_workers); worker++)
+            if (work->checking[worker] != NULL)
+                Z3_interrupt(work->checking[worker]);
+    }
+    pthread_mutex_unlock(&work->mutex);
+}
+
+/**
+ * @brief Builds the formula of @p work in a new context, then solves cubes until there are none left or the result is known.
+ *
+ * @param shared A tn_cube_work.
+ * @return void* NULL.
+ */
+static void *tn_cube_worker(void *shared)
+{
+    tn_cube_work *work = (tn_cube_work *)shared;
+    int worker = atomic_fetch_add(&work->num_workers, 1);
+    if (atomic_load(&work->done))
+        return NULL;
+    Z3_context ctx = make_rc_context();
+
+    // The cubes are assumptions: the solver must keep the SAT core when checked with them (see make_hinted_solver).
+    Z3_solver solver = work->checks != 0 ? Z3_mk_simple_solver(ctx) : make_hinted_solver(ctx, work->encoding != tn_finite_domain);
+    Z3_solver_inc_ref(ctx, solver);
+    tn_propagator propagator = work->checks != 0 ? tn_propagator_attach(ctx, solver, work->network, work->length, work->encoding, work->checks) : NULL;
+    tn_assert_reduction(ctx, solver, work->network, work->length, work->encoding, (work->checks & tn_propagate_simple) ? 1u << tn_simple : 0, NULL);
+
+    int cube;
+    while (!atomic_load(&work->done) && (cube = atomic_fetch_add(&work->next, 1)) < work->num_cubes)
+    {
+        Z3_ast literal = tn_node_literal(ctx, cube, work->length / 2, work->encoding);
+
+        // Only a check may be interrupted: the other calls (asserting, getting the model) fail when interrupted. An interrupt coming just after the check makes the next calls fail too, but the result is then known.
+        pthread_mutex_lock(&work->mutex);
+        bool done = atomic_load(&work->done);
+        if (!done)
+            work->checking[worker] = ctx;
+        pthread_mutex_unlock(&work->mutex);
+        if (done)
+            break;
+        Z3_lbool result = Z3_solver_check_assumptions(ctx, solver, 1, &literal);
+        pthread_mutex_lock(&work->mutex);
+        work->checking[worker] = NULL;
+        done = atomic_load(&work->done);
+        pthread_mutex_unlock(&work->mutex);
+        if (done)
+            break;
+
+        if (result == Z3_L_TRUE)
+        {
+            Z3_model model = Z3_solver_get_model(ctx, solver);
+            Z3_model_inc_ref(ctx, model);
+            tn_step path[work->length];
+            tn_get_path_from_model(ctx, model, work->network, work->length, work->encoding, path);
+            Z3_model_dec_ref(ctx, model);
+            tn_cube_finish(work, Z3_L_TRUE, path);
+        }
+        else if (result == Z3_L_FALSE)
+        {
+            atomic_fetch_add(&work->num_refuted, 1);
+            // An empty core refutes every cube at once.
+            Z3_ast_vector core = Z3_solver_get_unsat_core(ctx, solver);
+            Z3_ast_vector_inc_ref(ctx, core);
+            if (Z3_ast_vector_size(ctx, core) == 0)
+                tn_cube_finish(work, Z3_L_FALSE, NULL);
+            Z3_ast_vector_dec_ref(ctx, core);
+        }
+    }
+
+    Z3_solver_dec_ref(ctx, solver);
+    if (propagator != NULL)
+        tn_propagator_delete(propagator);
+    Z3_del_context(ctx);
+    return NULL;
+}
+
+Z3_lbool tn_solve_cubes(const TunnelNetwork network, int length, tn_stack_encoding encoding, unsigned checks, int num_threads, tn_step *path, tn_cube_stats *stats)
+{
+    // The rows of a modified network are rebuilt on their first read: they must be before the threads read them.
+    tn_refresh(network);
+
+    tn_cube_work work;
+    work.network = network;
+    work.length = length;
+    work.encoding = encoding;
+    work.checks = checks;
+    work.num_cubes = tn_get_num_nodes(network);
+    atomic_init(&work.next, 0);
+    atomic_init(&work.num_workers, 0);
+    atomic_init(&work.num_refuted, 0);
+    atomic_init(&work.done, false);
+    pthread_mutex_init(&work.mutex, NULL);
+    work.result = Z3_L_UNDEF;
+    work.path = path;
+
+    if (num_threads > work.num_cubes)
+        num_threads = work.num_cubes;
+    if (num_threads < 1)
+        num_threads = 1;
+    work.checking = (Z3_context *)calloc(num_threads, sizeof(Z3_context));
+
+    pthread_t threads[num_threads];
+    int started = 0;
+    while (started < num_threads - 1 && pthread_create(&threads[started], NULL, tn_cube_worker, &work) == 0)
+        started++;
+    tn_cube_worker(&work);
+    for (int thread = 0; thread < started; thread++)
+        pthread_join(threads[thread], NULL);
+
+    // Without a model nor an empty core, the formula is unsatisfiable only if every cube has been refuted.
+    Z3_lbool result = work.result;
+    if (!atomic_load(&work.done) && atomic_load(&work.num_refuted) == work.num_cubes)
+        result = Z3_L_FALSE;
+
+    if (stats != NULL)
+    {
+        stats->num_cubes = work.num_cubes;
+        stats->num_refuted = atomic_load(&work.num_refuted);
+        stats->num_workers = atomic_load(&work.num_workers);
+    }
+
+    free(work.checking);
+    pthread_mutex_destroy(&work.mutex);
+    return result;
+}
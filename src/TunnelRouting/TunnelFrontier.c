@@ -0,0 +1,318 @@
+#include "TunnelFrontier.h"
+#include "TunnelBF.h"
+#include "BitMatrix.h"
+#include "Arena.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Largest network searched with adjacency matrices (two matrices of N²/8 bytes, 32MB each at that size).
+ *
+ */
+#define FrontierMaxNodes 16384
+
+/**
+ * @brief Largest length searched: the height of the stack never exceeds half of it, and a stack must fit in a tn_packed_stack.
+ *
+ */
+#define FrontierMaxLength (2 * TnMaxPackedHeight)
+
+/**
+ * @brief The states of a path position: a set of nodes for each stack reached. Stacks are found with an open addressing table.
+ *
+ */
+typedef struct
+{
+    int count;               ///< Number of stacks.
+    int capacity;            ///< Size of stacks and sets.
+    tn_packed_stack *stacks; ///< The stacks, in the order they were reached.
+    uint64_t **sets;         ///< The nodes of each stack (allocated in the arena of the search).
+    int *slots;              ///< Table from stacks to their index (-1 for empty slots).
+    int num_slots;           ///< Size of slots (a power of 2).
+} frontier_level;
+
+/**
+ * @brief A search over a network.
+ *
+ */
+typedef struct
+{
+    TunnelNetwork network;
+    int num_nodes;
+    int num_words;                       ///< Words of a set of nodes.
+    BitMatrix successors;                ///< Adjacency matrix.
+    BitMatrix predecessors;              ///< Transposed adjacency matrix.
+    uint64_t *lacking_action[NumActions]; ///< For each action, the nodes which cannot perform it.
+    frontier_level *forward;             ///< The states reachable from the initial state, for each position.
+    frontier_level *backward;            ///< The states of forward from which the final state is reachable at the length tried.
+    uint64_t *scratch;                   ///< A set of nodes.
+    Arena arena;                         ///< The memory of the sets.
+} frontier_search;
+
+static void level_init(frontier_level *level)
+{
+    level->count = 0;
+    level->capacity = 0;
+    level->stacks = NULL;
+    level->sets = NULL;
+    level->num_slots = 16;
+    level->slots = (int *)malloc(level->num_slots * sizeof(int));
+    memset(level->slots, -1, level->num_slots * sizeof(int));
+}
+
+static void level_clear(frontier_level *level)
+{
+    level->count = 0;
+    memset(level->slots, -1, level->num_slots * sizeof(int));
+}
+
+static void level_free(frontier_level *level)
+{
+    free(level->stacks);
+    free(level->sets);
+    free(level->slots);
+}
+
+static int level_slot(const frontier_level *level, tn_packed_stack stack)
+{
+    int mask = level->num_slots - 1;
+    int slot = (int)((stack * 0x9E3779B97F4A7C15ull) >> 40) & mask;
+    while (level->slots[slot] != -1 && level->stacks[level->slots[slot]] != stack)
+        slot = (slot + 1) & mask;
+    return slot;
+}
+
+/**
+ * @brief Returns the nodes of @p level with stack @p stack, or NULL if there are none.
+ *
+ */
+static uint64_t *level_find(const frontier_level *level, tn_packed_stack stack)
+{
+    int index = level->slots[level_slot(level, stack)];
+    return index == -1 ? NULL : level->sets[index];
+}
+
+/**
+ * @brief Returns the nodes of @p level with stack @p stack, adding the stack (with no node) if it is not present.
+ *
+ */
+static uint64_t *level_add(frontier_search *search, frontier_level *level, tn_packed_stack stack)
+{
+    int slot = level_slot(level, stack);
+    if (level->slots[slot] != -1)
+        return level->sets[level->slots[slot]];
+
+    if (level->count == level->capacity)
+    {
+        level->capacity = level->capacity == 0 ? 16 : 2 * level->capacity;
+        level->stacks = (tn_packed_stack *)realloc(level->stacks, level->capacity * sizeof(tn_packed_stack));
+        level->sets = (uint64_t **)realloc(level->sets, level->capacity * sizeof(uint64_t *));
+    }
+    int index = level->count++;
+    level->stacks[index] = stack;
+    level->sets[index] = (uint64_t *)arena_calloc(search->arena, search->num_words * sizeof(uint64_t));
+    level->slots[slot] = index;
+
+    if (2 * level->count > level->num_slots)
+    {
+        level->num_slots *= 2;
+        level->slots = (int *)realloc(level->slots, level->num_slots * sizeof(int));
+        memset(level->slots, -1, level->num_slots * sizeof(int));
+        for (int i = 0; i < level->count; i++)
+            level->slots[level_slot(level, level->stacks[i])] = i;
+    }
+    return level->sets[index];
+}
+
+/**
+ * @brief Computes the states of position @p pos+1 from those of position @p pos. Stacks too high to be emptied before position @p length are dropped, and so is the initial node, which a simple path cannot visit again.
+ *
+ * @return bool True iff some state is reached.
+ */
+static bool frontier_advance(frontier_search *search, int pos, int length)
+{
+    frontier_level *level = &search->forward[pos];
+    frontier_level *next = &search->forward[pos + 1];
+    int max_height = length - (pos + 1);
+
+    for (int i = 0; i < level->count; i++)
+    {
+        tn_packed_stack stack = level->stacks[i];
+        for (stack_action act = 0; act < NumActions; act++)
+        {
+            const tn_transition *transition = tn_packed_transition(stack, act);
+            if (!transition->valid)
+                continue;
+            tn_packed_stack next_stack = tn_packed_apply(stack, transition);
+            if (tn_packed_height(next_stack) > max_height)
+                continue;
+            if (!bitset_and_not(search->scratch, level->sets[i], search->lacking_action[act], search->num_words))
+                continue;
+            bit_matrix_or_rows(search->successors, search->scratch, level_add(search, next, next_stack));
+        }
+    }
+
+    int initial = tn_get_initial(search->network);
+    bool reached = false;
+    for (int i = 0; i < next->count; i++)
+    {
+        BitsetClear(next->sets[i], initial);
+        reached = reached || bitset_count(next->sets[i], search->num_words) > 0;
+    }
+    return reached;
+}
+
+/**
+ * @brief Keeps in search->backward the states of the forward levels from which the final state (final node, initial stack) is reached at position @p length.
+ *
+ * @return bool True iff the initial state is one of them.
+ */
+static bool frontier_restrict(frontier_search *search, int length)
+{
+    for (int pos = 0; pos <= length; pos++)
+        level_clear(&search->backward[pos]);
+
+    int final = tn_get_final(search->network);
+    uint64_t *last = level_find(&search->forward[length], TnInitialStack);
+    if (last == NULL || !BitsetTest(last, final))
+        return false;
+    BitsetSet(level_add(search, &search->backward[length], TnInitialStack), final);
+
+    for (int pos = length - 1; pos >= 0; pos--)
+    {
+        frontier_level *level = &search->forward[pos];
+        for (int i = 0; i < level->count; i++)
+        {
+            tn_packed_stack stack = level->stacks[i];
+            for (stack_action act = 0; act < NumActions; act++)
+            {
+                const tn_transition *transition = tn_packed_transition(stack, act);
+                if (!transition->valid)
+                    continue;
+                const uint64_t *targets = level_find(&search->backward[pos + 1], tn_packed_apply(stack, transition));
+                if (targets == NULL)
+                    continue;
+                memset(search->scratch, 0, search->num_words * sizeof(uint64_t));
+                bit_matrix_or_rows(search->predecessors, targets, search->scratch);
+                if (!bitset_and(search->scratch, search->scratch, level->sets[i], search->num_words))
+                    continue;
+                if (!bitset_and_not(search->scratch, search->scratch, search->lacking_action[act], search->num_words))
+                    continue;
+                bitset_or(level_add(search, &search->backward[pos], stack), search->scratch, search->num_words);
+            }
+        }
+    }
+
+    uint64_t *first = level_find(&search->backward[0], TnInitialStack);
+    return first != NULL && BitsetTest(first, tn_get_initial(search->network));
+}
+
+/**
+ * @brief Searches a simple path from state (@p node, @p stack) at position @p pos to the final state at position @p length, through the states of search->backward only. Successors and actions are tried in the same order as tn_brute_force.
+ *
+ * @return bool True iff a path has been found (it is then in @p path).
+ */
+static bool frontier_refine(frontier_search *search, int node, tn_packed_stack stack, int pos, int length, bool *visited, tn_step *path)
+{
+    if (pos == length)
+        return true;
+
+    visited[node] = true;
+    int enabled = tn_get_enabled_actions(search->network, node, tn_packed_top(stack));
+    int num_successors;
+    const int *successors = tn_get_successors(search->network, node, &num_successors);
+
+    for (int i = 0; i < num_successors; i++)
+    {
+        int next = successors[i];
+        if (visited[next])
+            continue;
+        for (stack_action act = 0; act < NumActions; act++)
+        {
+            const tn_transition *transition = tn_packed_transition(stack, act);
+            if (!(enabled & (1 << act)) || !transition->valid)
+                continue;
+            tn_packed_stack next_stack = tn_packed_apply(stack, transition);
+            const uint64_t *states = level_find(&search->backward[pos + 1], next_stack);
+            if (states == NULL || !BitsetTest(states, next))
+                continue;
+            path[pos] = tn_step_create(act, node, next);
+            if (frontier_refine(search, next, next_stack, pos + 1, length, visited, path))
+            {
+                visited[node] = false;
+                return true;
+            }
+        }
+    }
+
+    visited[node] = false;
+    return false;
+}
+
+int tn_frontier_search(TunnelNetwork network, int length, tn_step *path)
+{
+    int num_nodes = tn_get_num_nodes(network);
+    if (num_nodes > FrontierMaxNodes || length > FrontierMaxLength)
+        return tn_brute_force(network, length, path);
+    if (length <= 0)
+        return 0;
+
+    frontier_search search;
+    search.network = network;
+    search.num_nodes = num_nodes;
+    search.num_words = BitsetWords(num_nodes);
+    search.arena = arena_create();
+    search.successors = bit_matrix_create(num_nodes, num_nodes);
+    search.predecessors = bit_matrix_create(num_nodes, num_nodes);
+    for (int node = 0; node < num_nodes; node++)
+    {
+        int num_successors;
+        const int *successors = tn_get_successors(network, node, &num_successors);
+        for (int i = 0; i < num_successors; i++)
+        {
+            bit_matrix_set(search.successors, node, successors[i]);
+            bit_matrix_set(search.predecessors, successors[i], node);
+        }
+    }
+    for (stack_action act = 0; act < NumActions; act++)
+    {
+        search.lacking_action[act] = (uint64_t *)arena_calloc(search.arena, search.num_words * sizeof(uint64_t));
+        for (int node = 0; node < num_nodes; node++)
+            if (!tn_node_has_action(network, node, act))
+                BitsetSet(search.lacking_action[act], node);
+    }
+    search.scratch = (uint64_t *)arena_alloc(search.arena, search.num_words * sizeof(uint64_t));
+    search.forward = (frontier_level *)malloc((length + 1) * sizeof(frontier_level));
+    search.backward = (frontier_level *)malloc((length + 1) * sizeof(frontier_level));
+    for (int pos = 0; pos <= length; pos++)
+    {
+        level_init(&search.forward[pos]);
+        level_init(&search.backward[pos]);
+    }
+
+    bool *visited = (bool *)calloc(num_nodes, sizeof(bool));
+    BitsetSet(level_add(&search, &search.forward[0], TnInitialStack), tn_get_initial(network));
+
+    // the forward levels do not depend on the length tried: each length only adds one level.
+    int found = 0;
+    for (int L = 1; L <= length && found == 0; L++)
+    {
+        if (!frontier_advance(&search, L - 1, length))
+            break;
+        if (frontier_restrict(&search, L) && frontier_refine(&search, tn_get_initial(network), TnInitialStack, 0, L, visited, path))
+            found = L;
+    }
+
+    free(visited);
+    for (int pos = 0; pos <= length; pos++)
+    {
+        level_free(&search.forward[pos]);
+        level_free(&search.backward[pos]);
+    }
+    free(search.forward);
+    free(search.backward);
+    bit_matrix_delete(search.successors);
+    bit_matrix_delete(search.predecessors);
+    arena_delete(search.arena);
+    return found;
+}
@@ -5,80 +5,715 @@
 #include <sys/stat.h>
 #include <string.h>
 #include <assert.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <stdatomic.h>
 
+/**
+ * @brief The memory of a network, shared by the networks derived from it, and freed with the last of them. It is never modified.
+ *
+ */
+typedef struct
+{
+    atomic_int references;   ///< Number of networks using the core.
+    int num_edges;           ///< Number of edges.
+    const int *row_offsets;  ///< Rows of the edges (see TunnelNetwork_s).
+    const int *successors;   ///< Successors of the nodes.
+    const int *node_actions; ///< Actions of the nodes.
+    void *mapping;           ///< Mapping of the binary file the network has been loaded from (NULL if the arrays are allocated).
+    size_t mapping_size;     ///< Size of the mapping.
+    void *allocated[5];      ///< The arrays to free (if not mapped).
+} tn_core;
+
+/**
+ * @brief A network. Its arrays are those of its core, unless it has been modified by tn_remove_node, tn_remove_edge or tn_set_node_action: the changes are kept as masks and as a copy of the actions, and the rows without the removed edges are rebuilt when they are next read.
+ *
+ */
 struct TunnelNetwork_s
 {
-    Graph graph;       ///< The graph supporting the network.
-    int initial;       ///< The starting node of the network.
-    int final;         ///< The target node of the network.
-    int *node_actions; ///< The actions associated with nodes (uses a mask encoding).
+    tn_core *core;            ///< The shared memory of the network.
+    Graph graph;              ///< The graph supporting the network (empty if loaded from a binary file).
+    bool has_graph;           ///< False if the network has been loaded from a binary file.
+    int num_nodes;            ///< Number of nodes.
+    int num_edges;            ///< Number of edges.
+    int initial;              ///< The starting node of the network.
+    int final;                ///< The target node of the network.
+    const int *row_offsets;   ///< The successors of u are successors[row_offsets[u]] to successors[row_offsets[u+1]-1] (num_nodes+1 cells).
+    const int *successors;    ///< Successors of each node, in increasing order (num_edges cells).
+    const int *node_actions;  ///< The actions associated with nodes (uses a mask encoding).
+    const int *name_offsets;  ///< Offset of the name of each node in strings.
+    const char *strings;      ///< Names of the nodes and of the network, null-terminated.
+    int name_offset;          ///< Offset of the name of the network in strings.
+    int strings_size;         ///< Size of strings.
+    bool *removed_nodes;      ///< True for the nodes removed from the core (NULL if none).
+    bool *removed_edges;      ///< True for the edges of the core removed, indexed by their position in core->successors (NULL if none).
+    bool stale_rows;          ///< True if row_offsets and successors must be rebuilt from the masks.
+};
+
+/**
+ * @brief Creates the core of @p network, owning the arrays @p network points to (or @p mapping, if not NULL).
+ *
+ */
+static void tn_create_core(TunnelNetwork network, void *mapping, size_t mapping_size)
+{
+    tn_core *core = (tn_core *)malloc(sizeof(tn_core));
+    atomic_init(&core->references, 1);
+    core->num_edges = network->num_edges;
+    core->row_offsets = network->row_offsets;
+    core->successors = network->successors;
+    core->node_actions = network->node_actions;
+    core->mapping = mapping;
+    core->mapping_size = mapping_size;
+    void *allocated[5] = {(void *)network->row_offsets, (void *)network->successors, (void *)network->node_actions, (void *)network->name_offsets, (void *)network->strings};
+    memcpy(core->allocated, allocated, sizeof(allocated));
+    network->core = core;
+    network->removed_nodes = NULL;
+    network->removed_edges = NULL;
+    network->stale_rows = false;
+}
+
+void tn_refresh(TunnelNetwork network)
+{
+    if (!network->stale_rows)
+        return;
+    tn_core *core = network->core;
+    if (network->row_offsets != core->row_offsets)
+    {
+        free((void *)network->row_offsets);
+        free((void *)network->successors);
+    }
+    int num_nodes = network->num_nodes;
+    int *row_offsets = (int *)malloc((num_nodes + 1) * sizeof(int));
+    int *successors = (int *)malloc(core->num_edges * sizeof(int));
+    int num_edges = 0;
+    for (int node = 0; node < num_nodes; node++)
+    {
+        row_offsets[node] = num_edges;
+        if (network->removed_nodes != NULL && network->removed_nodes[node])
+            continue;
+        for (int edge = core->row_offsets[node]; edge < core->row_offsets[node + 1]; edge++)
+        {
+            int target = core->successors[edge];
+            if ((network->removed_edges == NULL || !network->removed_edges[edge]) &&
+                (network->removed_nodes == NULL || !network->removed_nodes[target]))
+                successors[num_edges++] = target;
+        }
+    }
+    row_offsets[num_nodes] = num_edges;
+    network->row_offsets = row_offsets;
+    network->successors = successors;
+    network->num_edges = num_edges;
+    network->stale_rows = false;
+}
+
+/**
+ * @brief Identifies .tnb files.
+ *
+ */
+static const char tnb_magic[8] = "COCATNB";
+
+/**
+ * @brief Version of the .tnb format written. Files of other versions are rejected.
+ *
+ */
+#define TnbVersion 1
+
+/**
+ * @brief Header of a .tnb file. It is followed by the arrays of the network, whose positions it gives (each aligned on 8 bytes).
+ *
+ */
+typedef struct
+{
+    char magic[8];               ///< tnb_magic.
+    uint32_t version;            ///< TnbVersion.
+    uint32_t header_size;        ///< sizeof(tnb_header).
+    int32_t num_nodes;           ///< Number of nodes.
+    int32_t num_edges;           ///< Number of edges.
+    int32_t initial;             ///< Initial node.
+    int32_t final;               ///< Final node.
+    int32_t name_offset;         ///< Offset of the name of the network in the strings.
+    int32_t strings_size;        ///< Size of the strings.
+    uint64_t row_offsets_offset; ///< Position of row_offsets (num_nodes+1 int32).
+    uint64_t successors_offset;  ///< Position of successors (num_edges int32).
+    uint64_t actions_offset;     ///< Position of node_actions (num_nodes int32).
+    uint64_t names_offset;       ///< Position of name_offsets (num_nodes int32).
+    uint64_t strings_offset;     ///< Position of the strings (strings_size bytes).
+} tnb_header;
+
+_Static_assert(sizeof(int) == sizeof(int32_t), "the arrays of .tnb files are used in place as int arrays");
+
+/**
+ * @brief Classes of the bytes of a label, for decoding actions. Symbols are numbered from 1, so that keys of tokens of different lengths differ.
+ *
+ */
+enum
+{
+    label_other,      ///< A byte that cannot appear in an action.
+    label_4,          ///< '4'.
+    label_6,          ///< '6'.
+    label_transmit,   ///< '→' (decoded from its 3 bytes).
+    label_push,       ///< '↑' (decoded from its 3 bytes).
+    label_pop,        ///< '↓' (decoded from its 3 bytes).
+    label_arrow,      ///< First byte of an arrow.
+    label_separator   ///< A byte ending a token (including the end of the label).
 };
 
+/**
+ * @brief Number of symbols of actions (plus one).
+ *
+ */
+#define LabelBase 6
+
+/**
+ * @brief Key of the token made of the symbols @p a, @p b, @p c (and @p d).
+ *
+ */
+#define ActionKey3(a, b, c) (((a) * LabelBase + (b)) * LabelBase + (c))
+#define ActionKey4(a, b, c, d) (ActionKey3(a, b, c) * LabelBase + (d))
+
+/**
+ * @brief Number of keys of tokens of at most 4 symbols.
+ *
+ */
+#define NumActionKeys (LabelBase * LabelBase * LabelBase * LabelBase)
+
+/**
+ * @brief Class of each byte of a label. The separators are those of the labels of the dot files ("\n" is split on both of its characters, and the quotes of the string are separators).
+ *
+ */
+static const unsigned char label_byte_class[256] = {
+    ['4'] = label_4, ['6'] = label_6, [0xE2] = label_arrow,
+    ['\0'] = label_separator, ['\\'] = label_separator, ['n'] = label_separator, ['"'] = label_separator};
+
+/**
+ * @brief Action of each key (plus one, 0 if the key is not an action).
+ *
+ */
+static const unsigned char action_of_key[NumActionKeys] = {
+    [ActionKey3(label_4, label_transmit, label_4)] = transmit_4 + 1,
+    [ActionKey3(label_6, label_transmit, label_6)] = transmit_6 + 1,
+    [ActionKey4(label_4, label_push, label_4, label_4)] = push_4_4 + 1,
+    [ActionKey4(label_4, label_push, label_4, label_6)] = push_4_6 + 1,
+    [ActionKey4(label_6, label_push, label_6, label_4)] = push_6_4 + 1,
+    [ActionKey4(label_6, label_push, label_6, label_6)] = push_6_6 + 1,
+    [ActionKey4(label_4, label_4, label_pop, label_4)] = pop_4_4 + 1,
+    [ActionKey4(label_4, label_6, label_pop, label_4)] = pop_4_6 + 1,
+    [ActionKey4(label_6, label_4, label_pop, label_6)] = pop_6_4 + 1,
+    [ActionKey4(label_6, label_6, label_pop, label_6)] = pop_6_6 + 1};
+
+/**
+ * @brief Returns the mask of the actions in @p label, one per token (tokens that are not actions are ignored).
+ * Each byte is read once: its class gives the symbol, which extends the key of the current token, and the key of a complete token gives its action.
+ *
+ */
+static int tn_decode_actions(const char *label)
+{
+    int node_actions = 0;
+    int key = 0; // key of the current token, -1 if it is not an action.
+    for (const unsigned char *c = (const unsigned char *)label;; c++)
+    {
+        int symbol = label_byte_class[*c];
+        if (symbol == label_separator)
+        {
+            if (key > 0 && action_of_key[key] != 0)
+                node_actions |= 1 << (action_of_key[key] - 1);
+            if (*c == '\0')
+                return node_actions;
+            key = 0;
+            continue;
+        }
+        if (symbol == label_arrow)
+        {
+            // → ↑ ↓ are U+2192, U+2191, U+2193: E2 86 92, E2 86 91, E2 86 93.
+            if (c[1] == 0x86 && c[2] >= 0x91 && c[2] <= 0x93)
+            {
+                static const unsigned char arrows[3] = {label_push, label_transmit, label_pop};
+                symbol = arrows[c[2] - 0x91];
+                c += 2;
+            }
+            else
+                symbol = label_other;
+        }
+        if (symbol == label_other || key < 0 || key >= NumActionKeys / LabelBase)
+            key = -1;
+        else
+            key = key * LabelBase + symbol;
+    }
+}
+
+/**
+ * @brief The strings of a graph used by the attributes of the nodes of a network (NULL if the graph does not contain them).
+ *
+ */
+typedef struct
+{
+    const char *shape;       ///< Key of the shape of a node.
+    const char *label;       ///< Key of the actions of a node.
+    const char *square;      ///< Shape of the initial node.
+    const char *invtriangle; ///< Shape of the final node.
+} tn_keys;
+
+/**
+ * @brief Fills the action mask of @p node from its attributes, and sets it as initial or final according to its shape.
+ * Only the first shape and the first label of @p node are considered.
+ *
+ */
+static int tn_parse_node(TunnelNetwork result, Graph graph, int node, const tn_keys *keys)
+{
+    int num_attributes;
+    const graphAttribute *attributes = graph_get_node_attributes(graph, node, &num_attributes);
+    const char *shape = NULL, *label = NULL;
+    for (int attr = 0; attr < num_attributes; attr++)
+    {
+        if (attributes[attr].key == keys->shape && shape == NULL)
+            shape = attributes[attr].value;
+        if (attributes[attr].key == keys->label && label == NULL)
+            label = attributes[attr].value;
+    }
+    if (shape != NULL)
+    {
+        if (shape == keys->square)
+            result->initial = node;
+        if (shape == keys->invtriangle)
+            result->final = node;
+    }
+    return label == NULL ? 0 : tn_decode_actions(label);
+}
+
 TunnelNetwork tn_initialize(Graph graph)
 {
     TunnelNetwork result = (TunnelNetwork)malloc(sizeof(*result));
     result->graph = graph;
+    result->has_graph = true;
     int num_nodes = graph_num_nodes(graph);
-    result->node_actions = (int *)malloc(num_nodes * sizeof(int));
+    result->num_nodes = num_nodes;
     result->initial = 0; // dummy value
     result->final = 0;   // dummy value
+
+    tn_keys keys = {graph_find_string(graph, "shape"), graph_find_string(graph, "label"),
+                    graph_find_string(graph, "square"), graph_find_string(graph, "invtriangle")};
+
+    // the graph is already in compressed sparse rows: one pass over the nodes fills every array.
+    int num_edges = num_nodes == 0 ? 0 : graph.edgeOffsets[num_nodes];
+    int *node_actions = (int *)malloc(num_nodes * sizeof(int));
+    int *row_offsets = (int *)malloc((num_nodes + 1) * sizeof(int));
+    int *successors = (int *)malloc(num_edges * sizeof(int));
+    int *name_offsets = (int *)malloc(num_nodes * sizeof(int));
+    char *name = graph_get_name(graph);
+    int strings_size = (name == NULL ? 0 : strlen(name)) + 1;
+    int strings_capacity = strings_size + 16 * num_nodes;
+    char *strings = (char *)malloc(strings_capacity);
+    strcpy(strings, name == NULL ? "" : name);
+
+    row_offsets[0] = 0;
     for (int node = 0; node < num_nodes; node++)
     {
-        char *param = parameter_list_get_value(graph_get_node_parameter(graph, node), "shape");
-        if (param != NULL)
-        {
-            if (strcmp("square", param) == 0)
-                result->initial = node;
-            if (strcmp("invtriangle", param) == 0)
-                result->final = node;
-        }
-        char *actions = parameter_list_get_value(graph_get_node_parameter(graph, node), "label");
-        if (actions == NULL)
-            continue;
-        char work[strlen(actions) + 1];
-        strcpy(work, actions);
-        const char delim[] = "\\n\"";
-        char *lex = NULL;
-        char *token = strtok_r(work, delim, &lex);
-        result->node_actions[node] = 0;
-        while (token != NULL)
+        node_actions[node] = tn_parse_node(result, graph, node, &keys);
+
+        int num_successors;
+        const int *graph_successors = graph_get_successors(graph, node, &num_successors);
+        memcpy(successors + row_offsets[node], graph_successors, num_successors * sizeof(int));
+        row_offsets[node + 1] = row_offsets[node] + num_successors;
+
+        const char *node_name = graph_get_node_name(graph, node);
+        int length = strlen(node_name) + 1;
+        if (strings_size + length > strings_capacity)
         {
-            if (strcmp(token, "4→4") == 0)
-                result->node_actions[node] += 1 << transmit_4;
-            if (strcmp(token, "6→6") == 0)
-                result->node_actions[node] += 1 << transmit_6;
-            if (strcmp(token, "4↑44") == 0)
-                result->node_actions[node] += 1 << push_4_4;
-            if (strcmp(token, "4↑46") == 0)
-                result->node_actions[node] += 1 << push_4_6;
-            if (strcmp(token, "6↑64") == 0)
-                result->node_actions[node] += 1 << push_6_4;
-            if (strcmp(token, "6↑66") == 0)
-                result->node_actions[node] += 1 << push_6_6;
-            if (strcmp(token, "44↓4") == 0)
-                result->node_actions[node] += 1 << pop_4_4;
-            if (strcmp(token, "46↓4") == 0)
-                result->node_actions[node] += 1 << pop_4_6;
-            if (strcmp(token, "64↓6") == 0)
-                result->node_actions[node] += 1 << pop_6_4;
-            if (strcmp(token, "66↓6") == 0)
-                result->node_actions[node] += 1 << pop_6_6;
-
-            token = strtok_r(NULL, delim, &lex);
+            strings_capacity = 2 * (strings_size + length);
+            strings = (char *)realloc(strings, strings_capacity);
         }
+        memcpy(strings + strings_size, node_name, length);
+        name_offsets[node] = strings_size;
+        strings_size += length;
+    }
+
+    result->node_actions = node_actions;
+    result->row_offsets = row_offsets;
+    result->successors = successors;
+    result->num_edges = num_edges;
+    result->strings = strings;
+    result->strings_size = strings_size;
+    result->name_offset = 0;
+    result->name_offsets = name_offsets;
+    tn_create_core(result, NULL, 0);
+
+    return result;
+}
+
+/**
+ * @brief Writes @p size bytes of @p data in @p file, followed by zeros up to the next multiple of 8, and adds the written size to @p position.
+ *
+ */
+static bool tnb_write_section(FILE *file, const void *data, size_t size, uint64_t *position)
+{
+    static const char padding[8] = {0};
+    size_t padded = (size + 7) & ~(size_t)7;
+    if (size > 0 && fwrite(data, 1, size, file) != size)
+        return false;
+    if (padded > size && fwrite(padding, 1, padded - size, file) != padded - size)
+        return false;
+    *position += padded;
+    return true;
+}
+
+bool tn_save_binary(TunnelNetwork network, const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+        return false;
+
+    tn_refresh(network);
+    int num_nodes = network->num_nodes;
+    tnb_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, tnb_magic, sizeof(header.magic));
+    header.version = TnbVersion;
+    header.header_size = sizeof(tnb_header);
+    header.num_nodes = num_nodes;
+    header.num_edges = network->num_edges;
+    header.initial = network->initial;
+    header.final = network->final;
+    header.name_offset = network->name_offset;
+    header.strings_size = network->strings_size;
+
+    size_t sizes[5] = {(num_nodes + 1) * sizeof(int), network->num_edges * sizeof(int), num_nodes * sizeof(int), num_nodes * sizeof(int), network->strings_size};
+    const void *sections[5] = {network->row_offsets, network->successors, network->node_actions, network->name_offsets, network->strings};
+    uint64_t *offsets[5] = {&header.row_offsets_offset, &header.successors_offset, &header.actions_offset, &header.names_offset, &header.strings_offset};
+    uint64_t position = (sizeof(tnb_header) + 7) & ~(uint64_t)7;
+    for (int section = 0; section < 5; section++)
+    {
+        *offsets[section] = position;
+        position += (sizes[section] + 7) & ~(size_t)7;
+    }
+
+    bool ok = true;
+    position = 0;
+    ok = ok && tnb_write_section(file, &header, sizeof(header), &position);
+    for (int section = 0; section < 5; section++)
+        ok = ok && tnb_write_section(file, sections[section], sizes[section], &position);
+    ok = (fclose(file) == 0) && ok;
+    return ok;
+}
+
+/**
+ * @brief Checks that the section of @p count elements of size @p size at @p offset fits in a mapping of @p mapping_size bytes.
+ *
+ */
+static bool tnb_section_fits(uint64_t offset, uint64_t count, uint64_t size, size_t mapping_size)
+{
+    return offset % 8 == 0 && offset <= mapping_size && count * size <= mapping_size - offset;
+}
+
+/**
+ * @brief Checks in one pass over the sections of the binary network of @p header, mapped at @p base, that every index stays in bounds: the engines and printers read them without checks.
+ *
+ */
+static bool tnb_sections_valid(const tnb_header *header, const char *base)
+{
+    int num_nodes = header->num_nodes;
+    const int *row_offsets = (const int *)(base + header->row_offsets_offset);
+    const int *successors = (const int *)(base + header->successors_offset);
+    const int *node_actions = (const int *)(base + header->actions_offset);
+    const int *name_offsets = (const int *)(base + header->names_offset);
+    const char *strings = base + header->strings_offset;
+
+    if (row_offsets[0] != 0 || row_offsets[num_nodes] != header->num_edges || strings[header->strings_size - 1] != '\0' ||
+        header->name_offset < 0 || header->name_offset >= header->strings_size ||
+        (num_nodes > 0 && (header->initial < 0 || header->initial >= num_nodes || header->final < 0 || header->final >= num_nodes)))
+        return false;
+    for (int node = 0; node < num_nodes; node++)
+        if (row_offsets[node] > row_offsets[node + 1] || (node_actions[node] & ~((1 << NumActions) - 1)) != 0 ||
+            name_offsets[node] < 0 || name_offsets[node] >= header->strings_size)
+            return false;
+    for (int edge = 0; edge < header->num_edges; edge++)
+        if (successors[edge] < 0 || successors[edge] >= num_nodes)
+            return false;
+    return true;
+}
+
+bool tn_is_binary_file(const char *path)
+{
+    // only regular files are probed: reading the magic of a pipe would consume it.
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode))
+        return false;
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+        return false;
+    char magic[8];
+    bool result = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, tnb_magic, sizeof(magic)) == 0;
+    fclose(file);
+    return result;
+}
+
+TunnelNetwork tn_load_binary(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        printf("file %s does not exist.\n", path);
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(tnb_header))
+    {
+        printf("file %s is not a binary network.\n", path);
+        close(fd);
+        return NULL;
+    }
+    size_t mapping_size = st.st_size;
+    void *mapping = mmap(NULL, mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        printf("file %s cannot be mapped.\n", path);
+        return NULL;
     }
-    // todo: fill node_actions.
 
+    const tnb_header *header = (const tnb_header *)mapping;
+    const char *error = NULL;
+    if (memcmp(header->magic, tnb_magic, sizeof(header->magic)) != 0)
+        error = "is not a binary network";
+    else if (header->version != TnbVersion || header->header_size != sizeof(tnb_header))
+        error = "has an unsupported version (or byte order)";
+    else if (header->num_nodes < 0 || header->num_edges < 0 || header->strings_size < 1 ||
+             !tnb_section_fits(header->row_offsets_offset, (uint64_t)header->num_nodes + 1, sizeof(int), mapping_size) ||
+             !tnb_section_fits(header->successors_offset, header->num_edges, sizeof(int), mapping_size) ||
+             !tnb_section_fits(header->actions_offset, header->num_nodes, sizeof(int), mapping_size) ||
+             !tnb_section_fits(header->names_offset, header->num_nodes, sizeof(int), mapping_size) ||
+             !tnb_section_fits(header->strings_offset, header->strings_size, 1, mapping_size))
+        error = "is truncated";
+    else if (!tnb_sections_valid(header, (const char *)mapping))
+        error = "is corrupted";
+    if (error != NULL)
+    {
+        printf("file %s %s.\n", path, error);
+        munmap(mapping, mapping_size);
+        return NULL;
+    }
+    madvise(mapping, mapping_size, MADV_WILLNEED);
+
+    const char *base = (const char *)mapping;
+    TunnelNetwork result = (TunnelNetwork)malloc(sizeof(*result));
+    memset(&result->graph, 0, sizeof(Graph));
+    result->has_graph = false;
+    result->num_nodes = header->num_nodes;
+    result->num_edges = header->num_edges;
+    result->initial = header->initial;
+    result->final = header->final;
+    result->row_offsets = (const int *)(base + header->row_offsets_offset);
+    result->successors = (const int *)(base + header->successors_offset);
+    result->node_actions = (const int *)(base + header->actions_offset);
+    result->name_offsets = (const int *)(base + header->names_offset);
+    result->strings = base + header->strings_offset;
+    result->strings_size = header->strings_size;
+    result->name_offset = header->name_offset;
+    tn_create_core(result, mapping, mapping_size);
+    return result;
+}
+
+TunnelNetwork tn_derive(TunnelNetwork network)
+{
+    TunnelNetwork result = (TunnelNetwork)malloc(sizeof(*result));
+    *result = *network;
+    atomic_fetch_add(&network->core->references, 1);
+    int num_nodes = network->num_nodes;
+    if (network->node_actions != network->core->node_actions)
+    {
+        int *node_actions = (int *)malloc(num_nodes * sizeof(int));
+        memcpy(node_actions, network->node_actions, num_nodes * sizeof(int));
+        result->node_actions = node_actions;
+    }
+    if (network->removed_nodes != NULL)
+    {
+        result->removed_nodes = (bool *)malloc(num_nodes * sizeof(bool));
+        memcpy(result->removed_nodes, network->removed_nodes, num_nodes * sizeof(bool));
+    }
+    if (network->removed_edges != NULL)
+    {
+        result->removed_edges = (bool *)malloc(network->core->num_edges * sizeof(bool));
+        memcpy(result->removed_edges, network->removed_edges, network->core->num_edges * sizeof(bool));
+    }
+    if (network->row_offsets != network->core->row_offsets)
+    {
+        // the rows of network belong to it: result rebuilds its own.
+        result->row_offsets = network->core->row_offsets;
+        result->successors = network->core->successors;
+        result->stale_rows = true;
+    }
     return result;
 }
 
+/**
+ * @brief Returns true if @p network has been modified since it was derived from its core (the Graph it has been initialized from no longer describes it).
+ *
+ */
+static bool tn_is_modified(TunnelNetwork network)
+{
+    return network->removed_nodes != NULL || network->removed_edges != NULL || network->node_actions != network->core->node_actions;
+}
+
+void tn_remove_node(TunnelNetwork network, int node)
+{
+    if (network->removed_nodes == NULL)
+        network->removed_nodes = (bool *)calloc(network->num_nodes, sizeof(bool));
+    network->removed_nodes[node] = true;
+    network->stale_rows = true;
+}
+
+void tn_remove_edge(TunnelNetwork network, int source, int target)
+{
+    tn_core *core = network->core;
+    int low = core->row_offsets[source];
+    int high = core->row_offsets[source + 1];
+    while (low < high)
+    {
+        int middle = (low + high) / 2;
+        if (core->successors[middle] < target)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    if (low == core->row_offsets[source + 1] || core->successors[low] != target)
+        return;
+    if (network->removed_edges == NULL)
+        network->removed_edges = (bool *)calloc(core->num_edges, sizeof(bool));
+    network->removed_edges[low] = true;
+    network->stale_rows = true;
+}
+
+void tn_set_node_action(TunnelNetwork network, int node, stack_action action, bool allowed)
+{
+    if (tn_node_has_action(network, node, action) == allowed)
+        return;
+    if (network->node_actions == network->core->node_actions)
+    {
+        int *node_actions = (int *)malloc(network->num_nodes * sizeof(int));
+        memcpy(node_actions, network->core->node_actions, network->num_nodes * sizeof(int));
+        network->node_actions = node_actions;
+    }
+    int *node_actions = (int *)network->node_actions;
+    node_actions[node] ^= 1 << action;
+}
+
 void tn_delete(TunnelNetwork network)
 {
-    free(network->node_actions);
+    tn_core *core = network->core;
+    if (network->node_actions != core->node_actions)
+        free((void *)network->node_actions);
+    if (network->row_offsets != core->row_offsets)
+    {
+        free((void *)network->row_offsets);
+        free((void *)network->successors);
+    }
+    free(network->removed_nodes);
+    free(network->removed_edges);
     free(network);
+
+    if (atomic_fetch_sub(&core->references, 1) > 1)
+        return;
+    if (core->mapping != NULL)
+        munmap(core->mapping, core->mapping_size);
+    else
+        for (int array = 0; array < 5; array++)
+            free(core->allocated[array]);
+    free(core);
     return;
 }
 
+/**
+ * @brief The semantics of the actions, as X(action, top, below, height_delta, new_top): a push writes a new top above the current one, a pop uncovers the cell below, which must hold the symbol given.
+ * Both tn_action_rules and tn_transition_table are expanded from this list, so that they cannot disagree.
+ *
+ */
+#define TnActionRules(X)                                \
+    X(transmit_4, symbol_4, symbol_none, 0, symbol_4)   \
+    X(transmit_6, symbol_6, symbol_none, 0, symbol_6)   \
+    X(push_4_4, symbol_4, symbol_none, 1, symbol_4)     \
+    X(push_4_6, symbol_4, symbol_none, 1, symbol_6)     \
+    X(push_6_4, symbol_6, symbol_none, 1, symbol_4)     \
+    X(push_6_6, symbol_6, symbol_none, 1, symbol_6)     \
+    X(pop_4_4, symbol_4, symbol_4, -1, symbol_4)        \
+    X(pop_4_6, symbol_6, symbol_4, -1, symbol_4)        \
+    X(pop_6_4, symbol_4, symbol_6, -1, symbol_6)        \
+    X(pop_6_6, symbol_6, symbol_6, -1, symbol_6)
+
+#define TnRuleEntry(action, top, below, delta, new_top) [action] = {top, below, delta, new_top},
+
+const tn_action_rule tn_action_rules[NumActions] = {TnActionRules(TnRuleEntry)};
+
+/**
+ * @brief Transition of a rule when the stack has @p t on top and @p s below.
+ *
+ */
+#define TnTransitionCell(top, below, delta, new_top, t, s) {(t) == (top) && ((below) == symbol_none || (below) == (s)), delta, new_top}
+#define TnTransitionRow(top, below, delta, new_top, t)     \
+    {                                                      \
+        TnTransitionCell(top, below, delta, new_top, t, symbol_4), \
+        TnTransitionCell(top, below, delta, new_top, t, symbol_6), \
+        TnTransitionCell(top, below, delta, new_top, t, symbol_none) \
+    }
+#define TnTransitionEntry(action, top, below, delta, new_top) \
+    [action] = {TnTransitionRow(top, below, delta, new_top, symbol_4), TnTransitionRow(top, below, delta, new_top, symbol_6)},
+
+const tn_transition tn_transition_table[NumActions][NumStackSymbols][NumStackSymbols + 1] = {TnActionRules(TnTransitionEntry)};
+
+/**
+ * @brief Masks of the actions requiring 4 (resp. 6) on top of the stack.
+ *
+ */
+#define TnTopBit(action, top, below, delta, new_top, t) | ((top) == (t) ? 1 << (action) : 0)
+#define TnTop4Bit(action, top, below, delta, new_top) TnTopBit(action, top, below, delta, new_top, symbol_4)
+#define TnTop6Bit(action, top, below, delta, new_top) TnTopBit(action, top, below, delta, new_top, symbol_6)
+
+static const int tn_top_masks[NumStackSymbols] = {0 TnActionRules(TnTop4Bit), 0 TnActionRules(TnTop6Bit)};
+
+int tn_packed_height(tn_packed_stack stack)
+{
+    return 63 - __builtin_clzll(stack);
+}
+
+stack_symbol tn_packed_top(tn_packed_stack stack)
+{
+    return stack == TnInitialStack ? symbol_4 : (stack_symbol)(stack & 1);
+}
+
+const tn_transition *tn_packed_transition(tn_packed_stack stack, stack_action action)
+{
+    int height = tn_packed_height(stack);
+    stack_symbol below = height == 0 ? symbol_none : (height == 1 ? symbol_4 : (stack_symbol)((stack >> 1) & 1));
+    return &tn_transition_table[action][tn_packed_top(stack)][below];
+}
+
+tn_packed_stack tn_packed_apply(tn_packed_stack stack, const tn_transition *transition)
+{
+    if (transition->height_delta > 0)
+        return (stack << 1) | transition->new_top;
+    if (transition->height_delta < 0)
+        return stack >> 1;
+    return stack;
+}
+
+bool tn_packed_unapply(tn_packed_stack stack, stack_action action, tn_packed_stack *previous)
+{
+    const tn_action_rule *rule = &tn_action_rules[action];
+    if (tn_packed_top(stack) != rule->new_top)
+        return false;
+    if (rule->height_delta > 0)
+    {
+        if (stack == TnInitialStack)
+            return false;
+        *previous = stack >> 1;
+    }
+    else if (rule->height_delta < 0)
+        *previous = (stack << 1) | rule->top;
+    else
+        *previous = stack;
+    return tn_packed_transition(*previous, action)->valid;
+}
+
 char *tn_string_of_stack_action(stack_action action)
 {
     if (action == transmit_4)
@@ -106,7 +741,24 @@ char *tn_string_of_stack_action(stack_action action)
 
 void tn_print(TunnelNetwork network)
 {
-    graph_print(network->graph);
+    tn_refresh(network);
+    if (network->has_graph && !tn_is_modified(network))
+        graph_print(network->graph);
+    else
+    {
+        printf("\nName: %s\n", tn_get_name(network));
+        printf("\nNodes:\n");
+        for (int node = 0; node < network->num_nodes; node++)
+            printf("%d : %s , ", node, tn_get_node_name(network, node));
+        printf("\nEdges:\n");
+        for (int node = 0; node < network->num_nodes; node++)
+        {
+            printf("%s ->", tn_get_node_name(network, node));
+            for (int edge = network->row_offsets[node]; edge < network->row_offsets[node + 1]; edge++)
+                printf(" %s", tn_get_node_name(network, network->successors[edge]));
+            printf("\n");
+        }
+    }
     printf("\nTunnel Network properties:\n\n");
     printf("Initial : %s\n", tn_get_node_name(network, network->initial));
     printf("Final : %s\n", tn_get_node_name(network, network->final));
@@ -126,22 +778,41 @@ void tn_print(TunnelNetwork network)
 
 int tn_get_num_nodes(TunnelNetwork network)
 {
-    return graph_num_nodes(network->graph);
+    return network->num_nodes;
 }
 
 int tn_get_num_edges(TunnelNetwork network)
 {
-    return graph_num_edges(network->graph);
+    tn_refresh(network);
+    return network->num_edges;
 }
 
 bool tn_is_edge(TunnelNetwork network, int source, int target)
 {
-    return graph_is_edge(network->graph, source, target);
+    tn_refresh(network);
+    int low = network->row_offsets[source];
+    int high = network->row_offsets[source + 1];
+    while (low < high)
+    {
+        int middle = (low + high) / 2;
+        if (network->successors[middle] < target)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low < network->row_offsets[source + 1] && network->successors[low] == target;
+}
+
+const int *tn_get_successors(TunnelNetwork network, int node, int *num_successors)
+{
+    tn_refresh(network);
+    *num_successors = network->row_offsets[node + 1] - network->row_offsets[node];
+    return network->successors + network->row_offsets[node];
 }
 
 char *tn_get_node_name(TunnelNetwork network, int node)
 {
-    return graph_get_node_name(network->graph, node);
+    return (char *)network->strings + network->name_offsets[node];
 }
 
 bool tn_node_has_action(TunnelNetwork network, int node, stack_action action)
@@ -149,6 +820,11 @@ bool tn_node_has_action(TunnelNetwork network, int node, stack_action action)
     return (((1 << action) & network->node_actions[node]) != 0);
 }
 
+int tn_get_enabled_actions(TunnelNetwork network, int node, stack_symbol top)
+{
+    return network->node_actions[node] & tn_top_masks[top];
+}
+
 int tn_get_initial(TunnelNetwork network)
 {
     return network->initial;
@@ -171,7 +847,7 @@ void tn_set_final(TunnelNetwork network, int final)
 
 char *tn_get_name(TunnelNetwork network)
 {
-    return graph_get_name(network->graph);
+    return (char *)network->strings + network->name_offset;
 }
 
 void tn_print_path(TunnelNetwork network, tn_step *path, int size_path)
@@ -185,6 +861,68 @@ void tn_print_path(TunnelNetwork network, tn_step *path, int size_path)
     return;
 }
 
+bool tn_validate_path(TunnelNetwork network, const tn_step *path, int size_path)
+{
+    if (size_path <= 0 || path[0].source != network->initial || path[size_path - 1].target != network->final)
+        return false;
+
+    // each step pushes at most one cell: the height never exceeds size_path.
+    stack_symbol *stack = (stack_symbol *)malloc((size_path + 1) * sizeof(stack_symbol));
+    bool *visited = (bool *)calloc(network->num_nodes, sizeof(bool));
+    int height = 0;
+    stack[0] = symbol_4;
+    visited[network->initial] = true;
+
+    bool valid = true;
+    for (int i = 0; i < size_path && valid; i++)
+    {
+        const tn_step *step = &path[i];
+        valid = (i == 0 || step->source == path[i - 1].target) && step->action >= 0 && step->action < NumActions && step->target >= 0 && step->target < network->num_nodes && !visited[step->target] && tn_node_has_action(network, step->source, step->action) && tn_is_edge(network, step->source, step->target);
+        if (!valid)
+            break;
+        const tn_transition *transition = &tn_transition_table[step->action][stack[height]][height > 0 ? stack[height - 1] : symbol_none];
+        valid = transition->valid;
+        if (!valid)
+            break;
+        height += transition->height_delta;
+        stack[height] = transition->new_top;
+        visited[step->target] = true;
+    }
+    valid = valid && height == 0 && stack[0] == symbol_4;
+
+    free(visited);
+    free(stack);
+    return valid;
+}
+
+/**
+ * @brief Writes in @p file the nodes and edges of @p network in dot format, when it has no supporting graph. The label and shape of the nodes are rebuilt from their actions and from the initial and final nodes.
+ *
+ */
+static void tn_fill_dot_content(TunnelNetwork network, FILE *file)
+{
+    for (int node = 0; node < network->num_nodes; node++)
+    {
+        fprintf(file, "%s[label=\"", tn_get_node_name(network, node));
+        bool first = true;
+        for (stack_action act = 0; act < NumActions; act++)
+            if (tn_node_has_action(network, node, act))
+            {
+                fprintf(file, "%s%s", first ? "" : "\\n", tn_string_of_stack_action(act));
+                first = false;
+            }
+        fprintf(file, "\"");
+        if (node == network->initial)
+            fprintf(file, ",shape=square");
+        else if (node == network->final)
+            fprintf(file, ",shape=invtriangle");
+        fprintf(file, "];\n");
+    }
+    for (int node = 0; node < network->num_nodes; node++)
+        for (int edge = network->row_offsets[node]; edge < network->row_offsets[node + 1]; edge++)
+            fprintf(file, "%s -> %s;\n", tn_get_node_name(network, node), tn_get_node_name(network, network->successors[edge]));
+}
+
 void tn_create_dot(TunnelNetwork network, tn_step *path, int size_path, char *name)
 {
 
@@ -210,7 +948,11 @@ void tn_create_dot(TunnelNetwork network, tn_step *path, int size_path, char *na
         fprintf(file, "digraph %s{\n", name);
     }
 
-    digraph_fill_dot_content(network->graph, file);
+    tn_refresh(network);
+    if (network->has_graph && !tn_is_modified(network))
+        digraph_fill_dot_content(network->graph, file);
+    else
+        tn_fill_dot_content(network, file);
 
     for (int i = 0; i < size_path; i++)
     {
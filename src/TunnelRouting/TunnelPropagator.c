@@ -0,0 +1,330 @@
+#include "TunnelPropagator.h"
+#include <stdlib.h>
+
+/**
+ * @brief A variable registered with the solver: n(node,pos), or x(node,pos,height).
+ *
+ */
+typedef struct
+{
+    int node;
+    int pos;
+    int height; ///< -1 for n(node,pos).
+} tn_watched;
+
+struct tn_propagator_s
+{
+    Z3_context ctx;
+    unsigned checks;        ///< The tn_propagation flags.
+    int num_nodes;
+    int length;
+    int final;
+    tn_watched *watched;    ///< The variable of each id.
+    int num_ids;            ///< Size of watched.
+    unsigned *holder;       ///< The id of the variable n(u,pos) true for each node u (only meaningful if held[u]).
+    int *held_pos;          ///< The position of each held node.
+    bool *held;             ///< The nodes at some position in the current assignment.
+    int *trail;             ///< The nodes made held, in order.
+    int trail_size;
+    int *scopes;            ///< The trail size at each push of the solver.
+    int num_scopes;
+    int scopes_capacity;
+    int *from_initial;      ///< Distance from the initial node to each node (length + 1 if more).
+    int *to_final;          ///< Distance from each node to the final node (length + 1 if more).
+    int *successor_offsets; ///< The successors of u are successors[successor_offsets[u]] to successors[successor_offsets[u+1]-1].
+    int *successors;
+    int *queue;             ///< The queue of the searches from a held node.
+    int *visit_stamp;       ///< The search during which each node has been reached.
+    int stamp;
+    long num_conflicts;
+};
+
+static void tn_propagator_push(void *context)
+{
+    tn_propagator propagator = (tn_propagator)context;
+    if (propagator->num_scopes == propagator->scopes_capacity)
+    {
+        propagator->scopes_capacity = propagator->scopes_capacity == 0 ? 64 : 2 * propagator->scopes_capacity;
+        propagator->scopes = (int *)realloc(propagator->scopes, propagator->scopes_capacity * sizeof(int));
+    }
+    propagator->scopes[propagator->num_scopes++] = propagator->trail_size;
+}
+
+static void tn_propagator_pop(void *context, unsigned num_scopes)
+{
+    tn_propagator propagator = (tn_propagator)context;
+    propagator->num_scopes -= num_scopes;
+    int trail_size = propagator->scopes[propagator->num_scopes];
+    while (propagator->trail_size > trail_size)
+        propagator->held[propagator->trail[--propagator->trail_size]] = false;
+}
+
+/**
+ * @brief The same propagator serves the copies of the solver (there is none in a sequential check).
+ *
+ */
+static void *tn_propagator_fresh(void *context, Z3_context new_context)
+{
+    return context;
+}
+
+/**
+ * @brief Reports that the variables @p ids cannot all be true.
+ *
+ */
+static void tn_propagator_conflict(tn_propagator propagator, Z3_solver_callback cb, int num_ids, const unsigned *ids)
+{
+    Z3_solver_propagate_consequence(propagator->ctx, cb, num_ids, ids, 0, NULL, NULL, Z3_mk_false(propagator->ctx));
+    propagator->num_conflicts++;
+}
+
+/**
+ * @brief Tells whether the final node can be reached from @p node in at most @p steps steps without visiting the nodes held before position @p pos.
+ *
+ */
+static bool tn_propagator_reaches_final(tn_propagator propagator, int node, int pos, int steps)
+{
+    int stamp = ++propagator->stamp;
+    int first = 0;
+    int last = 0;
+    propagator->queue[last++] = node;
+    propagator->visit_stamp[node] = stamp;
+    for (int depth = 0; depth <= steps && first < last; depth++)
+    {
+        int level_end = last;
+        for (; first < level_end; first++)
+        {
+            int u = propagator->queue[first];
+            if (u == propagator->final)
+                return true;
+            for (int i = propagator->successor_offsets[u]; i < propagator->successor_offsets[u + 1]; i++)
+            {
+                int v = propagator->successors[i];
+                if (propagator->visit_stamp[v] == stamp || (propagator->held[v] && propagator->held_pos[v] < pos))
+                    continue;
+                propagator->visit_stamp[v] = stamp;
+                propagator->queue[last++] = v;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Called when the variable @p id is assigned. When it is made true:
+ *  - a state (node,pos,height) which cannot be reached from the initial state in pos steps, or cannot reach the final state in the remaining steps, is in conflict alone (tn_propagate_reachability);
+ *  - a node put at a second position is in conflict with the first one (tn_propagate_simple);
+ *  - a node from which the final node cannot be reached in time, without the nodes of the positions before, is in conflict with these nodes (tn_propagate_reachability).
+ *
+ */
+static void tn_propagator_fixed(void *context, Z3_solver_callback cb, unsigned id, Z3_ast value)
+{
+    tn_propagator propagator = (tn_propagator)context;
+    if (Z3_get_bool_value(propagator->ctx, value) != Z3_L_TRUE)
+        return;
+
+    const tn_watched *watched = &propagator->watched[id];
+    int node = watched->node;
+    int pos = watched->pos;
+    int remaining = propagator->length - pos;
+    bool reach = propagator->checks & tn_propagate_reachability;
+
+    if (reach)
+    {
+        int height = watched->height < 0 ? 0 : watched->height;
+        // each step changes the height by at most one, and the stack holds only its bottom at both ends.
+        if (propagator->from_initial[node] > pos || height > pos || propagator->to_final[node] > remaining || height > remaining)
+        {
+            tn_propagator_conflict(propagator, cb, 1, &id);
+            return;
+        }
+    }
+    if (watched->height >= 0)
+        return;
+
+    if (propagator->held[node])
+    {
+        if (propagator->holder[node] != id && (propagator->checks & tn_propagate_simple))
+        {
+            unsigned conflict[2] = {propagator->holder[node], id};
+            tn_propagator_conflict(propagator, cb, 2, conflict);
+        }
+        return;
+    }
+    propagator->held[node] = true;
+    propagator->holder[node] = id;
+    propagator->held_pos[node] = pos;
+    propagator->trail[propagator->trail_size++] = node;
+
+    if (!reach || tn_propagator_reaches_final(propagator, node, pos, remaining))
+        return;
+    unsigned conflict[propagator->trail_size];
+    int size = 0;
+    conflict[size++] = id;
+    for (int i = 0; i < propagator->trail_size; i++)
+    {
+        int other = propagator->trail[i];
+        if (propagator->held_pos[other] < pos)
+            conflict[size++] = propagator->holder[other];
+    }
+    tn_propagator_conflict(propagator, cb, size, conflict);
+}
+
+/**
+ * @brief Fills @p distances with the distances from @p source, following the edges of the compressed sparse rows @p offsets and @p targets (@p unreachable if farther).
+ *
+ */
+static void tn_propagator_distances(int num_nodes, const int *offsets, const int *targets, int source, int unreachable, int *distances, int *queue)
+{
+    for (int u = 0; u < num_nodes; u++)
+        distances[u] = unreachable;
+    int first = 0;
+    int last = 0;
+    distances[source] = 0;
+    queue[last++] = source;
+    while (first < last)
+    {
+        int u = queue[first++];
+        if (distances[u] + 1 >= unreachable)
+            continue;
+        for (int i = offsets[u]; i < offsets[u + 1]; i++)
+            if (distances[targets[i]] == unreachable)
+            {
+                distances[targets[i]] = distances[u] + 1;
+                queue[last++] = targets[i];
+            }
+    }
+}
+
+/**
+ * @brief Builds the successors of each node of @p network, and the distances from its initial node and to its final node.
+ *
+ */
+static void tn_propagator_build_graph(tn_propagator propagator, const TunnelNetwork network)
+{
+    int num_nodes = propagator->num_nodes;
+    propagator->successor_offsets = (int *)malloc((num_nodes + 1) * sizeof(int));
+    propagator->successor_offsets[0] = 0;
+    for (int u = 0; u < num_nodes; u++)
+    {
+        int num_successors;
+        tn_get_successors(network, u, &num_successors);
+        propagator->successor_offsets[u + 1] = propagator->successor_offsets[u] + num_successors;
+    }
+    int num_edges = propagator->successor_offsets[num_nodes];
+    propagator->successors = (int *)malloc(num_edges * sizeof(int));
+
+    int *predecessor_offsets = (int *)calloc(num_nodes + 1, sizeof(int));
+    int *predecessors = (int *)malloc(num_edges * sizeof(int));
+    for (int u = 0; u < num_nodes; u++)
+    {
+        int num_successors;
+        const int *successors = tn_get_successors(network, u, &num_successors);
+        for (int i = 0; i < num_successors; i++)
+        {
+            propagator->successors[propagator->successor_offsets[u] + i] = successors[i];
+            predecessor_offsets[successors[i] + 1]++;
+        }
+    }
+    for (int u = 0; u < num_nodes; u++)
+        predecessor_offsets[u + 1] += predecessor_offsets[u];
+    int *fill = (int *)malloc(num_nodes * sizeof(int));
+    for (int u = 0; u < num_nodes; u++)
+        fill[u] = predecessor_offsets[u];
+    for (int u = 0; u < num_nodes; u++)
+        for (int i = propagator->successor_offsets[u]; i < propagator->successor_offsets[u + 1]; i++)
+            predecessors[fill[propagator->successors[i]]++] = u;
+    free(fill);
+
+    int unreachable = propagator->length + 1;
+    propagator->from_initial = (int *)malloc(num_nodes * sizeof(int));
+    propagator->to_final = (int *)malloc(num_nodes * sizeof(int));
+    tn_propagator_distances(num_nodes, propagator->successor_offsets, propagator->successors, tn_get_initial(network), unreachable, propagator->from_initial, propagator->queue);
+    tn_propagator_distances(num_nodes, predecessor_offsets, predecessors, propagator->final, unreachable, propagator->to_final, propagator->queue);
+    free(predecessors);
+    free(predecessor_offsets);
+}
+
+/**
+ * @brief Registers @p variable with the solver, as the watched variable (@p node, @p pos, @p height).
+ *
+ */
+static void tn_propagator_register(tn_propagator propagator, Z3_solver solver, Z3_ast variable, int node, int pos, int height)
+{
+    unsigned id = Z3_solver_propagate_register(propagator->ctx, solver, variable);
+    if (id >= (unsigned)propagator->num_ids)
+    {
+        int num_ids = 2 * propagator->num_ids > (int)id + 1 ? 2 * propagator->num_ids : (int)id + 1;
+        propagator->watched = (tn_watched *)realloc(propagator->watched, num_ids * sizeof(tn_watched));
+        propagator->num_ids = num_ids;
+    }
+    propagator->watched[id] = (tn_watched){node, pos, height};
+}
+
+bool tn_propagator_supports(tn_stack_encoding encoding)
+{
+    return encoding == tn_boolean_stack || encoding == tn_nested_stack;
+}
+
+tn_propagator tn_propagator_attach(Z3_context ctx, Z3_solver solver, const TunnelNetwork network, int length, tn_stack_encoding encoding, unsigned checks)
+{
+    int num_nodes = tn_get_num_nodes(network);
+    tn_propagator propagator = (tn_propagator)malloc(sizeof(struct tn_propagator_s));
+    propagator->ctx = ctx;
+    propagator->checks = checks;
+    propagator->num_nodes = num_nodes;
+    propagator->length = length;
+    propagator->final = tn_get_final(network);
+    propagator->num_ids = num_nodes * (length + 1);
+    propagator->watched = (tn_watched *)malloc(propagator->num_ids * sizeof(tn_watched));
+    propagator->holder = (unsigned *)malloc(num_nodes * sizeof(unsigned));
+    propagator->held_pos = (int *)malloc(num_nodes * sizeof(int));
+    propagator->held = (bool *)calloc(num_nodes, sizeof(bool));
+    propagator->trail = (int *)malloc(num_nodes * sizeof(int));
+    propagator->trail_size = 0;
+    propagator->scopes = NULL;
+    propagator->num_scopes = 0;
+    propagator->scopes_capacity = 0;
+    propagator->queue = (int *)malloc(num_nodes * sizeof(int));
+    propagator->visit_stamp = (int *)calloc(num_nodes, sizeof(int));
+    propagator->stamp = 0;
+    propagator->num_conflicts = 0;
+    tn_propagator_build_graph(propagator, network);
+
+    Z3_solver_propagate_init(ctx, solver, propagator, tn_propagator_push, tn_propagator_pop, tn_propagator_fresh);
+    Z3_solver_propagate_fixed(ctx, solver, tn_propagator_fixed);
+
+    for (int pos = 0; pos <= length; pos++)
+        for (int node = 0; node < num_nodes; node++)
+            tn_propagator_register(propagator, solver, tn_node_variable(ctx, node, pos), node, pos, -1);
+
+    // only the boolean encoding has a variable per state, the others are pruned on their nodes.
+    if ((checks & tn_propagate_reachability) && encoding == tn_boolean_stack)
+        for (int pos = 0; pos <= length; pos++)
+            for (int node = 0; node < num_nodes; node++)
+                for (int height = 0; height < get_stack_size(length); height++)
+                    tn_propagator_register(propagator, solver, tn_path_variable(ctx, node, pos, height), node, pos, height);
+    return propagator;
+}
+
+long tn_propagator_num_conflicts(const tn_propagator propagator)
+{
+    return propagator->num_conflicts;
+}
+
+void tn_propagator_delete(tn_propagator propagator)
+{
+    free(propagator->to_final);
+    free(propagator->from_initial);
+    free(propagator->successors);
+    free(propagator->successor_offsets);
+    free(propagator->visit_stamp);
+    free(propagator->queue);
+    free(propagator->scopes);
+    free(propagator->trail);
+    free(propagator->held);
+    free(propagator->held_pos);
+    free(propagator->holder);
+    free(propagator->watched);
+    free(propagator);
+}
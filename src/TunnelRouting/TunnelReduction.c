@@ -1,6 +1,9 @@
 #include "TunnelReduction.h"
 #include "Z3Tools.h"
+#include "Metrics.h"
 #include "stdio.h"
+#include <stdlib.h>
+#include <string.h>
 #include <getopt.h>
 
 /**
@@ -49,458 +52,1380 @@ Z3_ast tn_6_variable(Z3_context ctx, int pos, int height)
     return mk_bool_var(ctx, name);
 }
 
+Z3_ast tn_node_variable(Z3_context ctx, int node, int pos)
+{
+    char name[60];
+    snprintf(name, 60, "node %d on pos %d", node, pos);
+    return mk_bool_var(ctx, name);
+}
+
+/**
+ * @brief Creates the variable "z_{pos,height}": the state at position @p pos has height @p height, whatever its node.
+ *
+ * @param ctx The solver context.
+ * @param pos The path position.
+ * @param height The height of the stack.
+ * @return Z3_ast
+ */
+static Z3_ast tn_height_variable(Z3_context ctx, int pos, int height)
+{
+    char name[60];
+    snprintf(name, 60, "height %d on pos %d", height, pos);
+    return mk_bool_var(ctx, name);
+}
+
+/**
+ * @brief Creates the variable "S_{pos}" of the bit-vector encoding: the stack at position @p pos, read from its top (bit 0) down to its bottom (bit height). Bits above the bottom are 0.
+ *
+ * @param ctx The solver context.
+ * @param pos The path position.
+ * @param length The length of the sought path (the variable has get_stack_size(length) bits).
+ * @return Z3_ast
+ */
+static Z3_ast tn_stack_variable(Z3_context ctx, int pos, int length);
+
+/**
+ * @brief Wrapper to have the correct size of the array representing the stack (correct cells of the stack will be from 0 to (get_stack_size(length)-1)).
+ *
+ * @param length The length of the sought path.
+ * @return int
+ */
+int get_stack_size(int length)
+{
+    return length / 2 + 1;
+}
+
+static Z3_ast tn_stack_variable(Z3_context ctx, int pos, int length)
+{
+    char name[60];
+    snprintf(name, 60, "stack on pos %d", pos);
+    return Z3_mk_const(ctx, Z3_mk_string_symbol(ctx, name), Z3_mk_bv_sort(ctx, get_stack_size(length)));
+}
+
+/**
+ * @brief Creates the variable "a_{pos,action}" of the nested encoding: the step from position @p pos performs @p action.
+ *
+ * @param ctx The solver context.
+ * @param pos The path position.
+ * @param action An action.
+ * @return Z3_ast
+ */
+static Z3_ast tn_action_variable(Z3_context ctx, int pos, stack_action action)
+{
+    char name[60];
+    snprintf(name, 60, "action %d on pos %d", action, pos);
+    return mk_bool_var(ctx, name);
+}
+
+/**
+ * @brief Creates the variable "t_{pos}" of the nested encoding: the top of the stack at position @p pos is a 6 (a 4 if false).
+ *
+ * @param ctx The solver context.
+ * @param pos The path position.
+ * @return Z3_ast
+ */
+static Z3_ast tn_top_variable(Z3_context ctx, int pos)
+{
+    char name[60];
+    snprintf(name, 60, "top 6 on pos %d", pos);
+    return mk_bool_var(ctx, name);
+}
+
+/**
+ * @brief Creates the variable "m_{push,pop}" of the nested encoding: the cell pushed by the step from position @p push is popped by the step from position @p pop.
+ *
+ * @param ctx The solver context.
+ * @param push The position of the push.
+ * @param pop The position of the pop.
+ * @return Z3_ast
+ */
+static Z3_ast tn_match_variable(Z3_context ctx, int push, int pop)
+{
+    char name[60];
+    snprintf(name, 60, "match %d with %d", push, pop);
+    return mk_bool_var(ctx, name);
+}
+
+/**
+ * @brief Creates the term "p_{pos}" of the finite-domain encoding: the node at position @p pos, an integer of [0,N).
+ *
+ * @param ctx The solver context.
+ * @param pos The path position.
+ * @return Z3_ast
+ */
+static Z3_ast tn_position_term(Z3_context ctx, int pos)
+{
+    char name[60];
+    snprintf(name, 60, "node on pos %d", pos);
+    return Z3_mk_const(ctx, Z3_mk_string_symbol(ctx, name), Z3_mk_int_sort(ctx));
+}
+
+/**
+ * @brief Creates the term "h_{pos}" of the finite-domain encoding: the height of the stack at position @p pos, an integer of [0,get_stack_size(length)).
+ *
+ * @param ctx The solver context.
+ * @param pos The path position.
+ * @return Z3_ast
+ */
+static Z3_ast tn_level_term(Z3_context ctx, int pos)
+{
+    char name[60];
+    snprintf(name, 60, "height on pos %d", pos);
+    return Z3_mk_const(ctx, Z3_mk_string_symbol(ctx, name), Z3_mk_int_sort(ctx));
+}
+
+/**
+ * @brief The integer constant @p value.
+ *
+ */
+static Z3_ast tn_int(Z3_context ctx, int value)
+{
+    return Z3_mk_int(ctx, value, Z3_mk_int_sort(ctx));
+}
+
+/**
+ * @brief Compte les littéraux d'une contrainte (occurrences de variables, en comptant chaque occurrence d'un sous-terme partagé).
+ *
+ * @param ctx Contexte Z3.
+ * @param formula La contrainte.
+ * @return long Le nombre de littéraux.
+ */
+static long tn_count_literals(Z3_context ctx, Z3_ast formula)
+{
+    if (Z3_get_ast_kind(ctx, formula) != Z3_APP_AST)
+        return 0;
+    Z3_app app = Z3_to_app(ctx, formula);
+    unsigned num_args = Z3_get_app_num_args(ctx, app);
+    if (num_args == 0)
+        return Z3_get_decl_kind(ctx, Z3_get_app_decl(ctx, app)) == Z3_OP_UNINTERPRETED ? 1 : 0;
+    long count = 0;
+    for (unsigned arg = 0; arg < num_args; arg++)
+        count += tn_count_literals(ctx, Z3_get_app_arg(ctx, app, arg));
+    return count;
+}
+
+/**
+ * @brief Destination des contraintes construites : elles sont soit assertées une à une dans un solveur dès leur construction, soit gardées dans un vecteur (pour en faire la conjonction).
+ *
+ */
+typedef struct
+{
+    Z3_context ctx;
+    Z3_solver solver;             ///< Le solveur où asserter les contraintes (NULL : elles sont gardées dans formula).
+    Z3_ast_vector formula;        ///< Les contraintes gardées, sans solveur.
+    Z3_ast_vector kept;           ///< Les termes intermédiaires gardés en vie jusqu'au prochain tn_release (voir tn_keep).
+    tn_reduction_stats *stats;    ///< Les statistiques à remplir au fil des contraintes (peut être NULL).
+    tn_constraint_family family;  ///< La famille en cours de construction.
+} tn_constraints;
+
+/**
+ * @brief Prépare une destination @p solver (ou un vecteur si @p solver est NULL), qui remplit @p stats s'il n'est pas NULL.
+ *
+ */
+static tn_constraints tn_open_constraints(Z3_context ctx, Z3_solver solver, tn_reduction_stats *stats)
+{
+    tn_constraints out = {ctx, solver, NULL, Z3_mk_ast_vector(ctx), stats, 0};
+    Z3_ast_vector_inc_ref(ctx, out.kept);
+    if (solver == NULL)
+    {
+        out.formula = Z3_mk_ast_vector(ctx);
+        Z3_ast_vector_inc_ref(ctx, out.formula);
+    }
+    return out;
+}
+
+/**
+ * @brief Libère les vecteurs de @p out.
+ *
+ */
+static void tn_close_constraints(tn_constraints *out)
+{
+    Z3_ast_vector_dec_ref(out->ctx, out->kept);
+    if (out->formula != NULL)
+        Z3_ast_vector_dec_ref(out->ctx, out->formula);
+}
+
+/**
+ * @brief Garde @p term en vie jusqu'au prochain tn_release, et le rend.
+ * Dans un contexte à compteurs de références (Z3_mk_context_rc), l'API ne garde que le dernier terme qu'elle a rendu : un terme rangé dans un tableau, ou construit avant un autre argument du même appel, doit être gardé jusqu'à ce qu'une contrainte assertée le contienne.
+ *
+ */
+static Z3_ast tn_keep(tn_constraints *out, Z3_ast term)
+{
+    Z3_ast_vector_push(out->ctx, out->kept, term);
+    return term;
+}
+
+/**
+ * @brief Relâche les termes gardés par tn_keep : ceux qu'aucune contrainte ne contient sont libérés.
+ *
+ */
+static void tn_release(tn_constraints *out)
+{
+    Z3_ast_vector_resize(out->ctx, out->kept, 0);
+}
+
+/**
+ * @brief Ajoute la contrainte @p constraint à @p out, et compte ses littéraux dans les statistiques de la famille en cours.
+ *
+ */
+static void tn_add(tn_constraints *out, Z3_ast constraint)
+{
+    Z3_inc_ref(out->ctx, constraint);
+    if (out->solver != NULL)
+        Z3_solver_assert(out->ctx, out->solver, constraint);
+    else
+        Z3_ast_vector_push(out->ctx, out->formula, constraint);
+    if (out->stats != NULL)
+    {
+        out->stats->clauses[out->family]++;
+        out->stats->literals[out->family] += tn_count_literals(out->ctx, constraint);
+    }
+    Z3_dec_ref(out->ctx, constraint);
+}
+
+/**
+ * @brief Ajoute à @p out qu'au plus une des @p size formules de @p formulae est vraie (une clause par paire).
+ *
+ */
+static void tn_add_at_most_one(tn_constraints *out, Z3_ast *formulae, int size)
+{
+    Z3_ast negations[size];
+    for (int i = 0; i < size; i++)
+        negations[i] = tn_keep(out, Z3_mk_not(out->ctx, formulae[i]));
+
+    for (int i = 0; i < size; i++)
+        for (int j = i + 1; j < size; j++)
+        {
+            Z3_ast forbid_args[2] = {negations[i], negations[j]};
+            tn_add(out, Z3_mk_or(out->ctx, 2, forbid_args));
+        }
+}
+
+/**
+ * @brief Ajoute à @p out qu'exactement une des @p size formules de @p formulae est vraie.
+ *
+ */
+static void tn_add_exactly_one(tn_constraints *out, Z3_ast *formulae, int size)
+{
+    tn_add(out, Z3_mk_or(out->ctx, size, formulae));
+    tn_add_at_most_one(out, formulae, size);
+}
+
+/**
+ * @brief Signature commune des fonctions construisant une famille de contraintes : chacune ajoute ses contraintes à @p out.
+ *
+ */
+typedef void (*tn_family_builder)(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out);
+
+/**
+ * @brief φ_unicity : à chaque position, exactement un couple (node,height) est vrai.
+ *
+ * @param ctx      Contexte Z3.
+ * @param network  Le TunnelNetwork analysé.
+ * @param length   Longueur exacte du chemin cherché.
+ * @param out      Destination des contraintes.
+ */
+static void tn_unicity_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    int N = tn_get_num_nodes(network);
+    int H = get_stack_size(length);
+    Z3_ast tmp[N * H];
+
+    for (int pos = 0; pos <= length; pos++)
+    {
+        /* ---------------------------
+         * (1) Au moins un état possible
+         * --------------------------- */
+        int a = 0;
+        for (int u = 0; u < N; u++)
+            for (int h = 0; h < H; h++)
+                tmp[a++] = tn_keep(out, tn_path_variable(ctx, u, pos, h));
+
+        tn_add(out, Z3_mk_or(ctx, a, tmp));
+
+        /* ---------------------------
+         * (2) Au plus un : on interdit deux états simultanés (une clause par paire non ordonnée)
+         * --------------------------- */
+        tn_add_at_most_one(out, tmp, a);
+        tn_release(out);
+    }
+}
+
+/**
+ * @brief φ_stack_validity : à chaque position, la pile est bien formée (pas de case à la fois 4 et 6, pas de trou).
+ *
+ * @param ctx      Contexte Z3.
+ * @param network  Le TunnelNetwork analysé.
+ * @param length   Longueur exacte du chemin cherché.
+ * @param out      Destination des contraintes.
+ */
+static void tn_stack_validity_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    int H = get_stack_size(length);
+
+    for (int pos = 0; pos <= length; pos++)
+    {
+        for (int h = 0; h < H; h++)
+        {
+            /* Interdit : y4(pos,h) ET y6(pos,h) */
+            Z3_ast both[2] = {
+                tn_keep(out, tn_4_variable(ctx, pos, h)),
+                tn_keep(out, tn_6_variable(ctx, pos, h))};
+            Z3_ast and_both = Z3_mk_and(ctx, 2, both);
+
+            tn_add(out, Z3_mk_not(ctx, and_both));
+        }
+
+        /* Pas de trou : si une case est vide, tout au-dessus est vide */
+        for (int h = 0; h < H; h++)
+        {
+            Z3_ast empty_h_args[2] = {
+                tn_keep(out, Z3_mk_not(ctx, tn_4_variable(ctx, pos, h))),
+                tn_keep(out, Z3_mk_not(ctx, tn_6_variable(ctx, pos, h)))};
+            Z3_ast empty_h = tn_keep(out, Z3_mk_and(ctx, 2, empty_h_args));
+
+            for (int h2 = h + 1; h2 < H; h2++)
+            {
+                Z3_ast filled_above = Z3_mk_or(ctx, 2,
+                                               (Z3_ast[]){
+                                                   tn_keep(out, tn_4_variable(ctx, pos, h2)),
+                                                   tn_keep(out, tn_6_variable(ctx, pos, h2))});
+
+                Z3_ast not_filled = Z3_mk_not(ctx, filled_above);
+                tn_add(out, Z3_mk_implies(ctx, empty_h, not_filled));
+            }
+        }
+        tn_release(out);
+    }
+}
+
+/**
+ * @brief Ajoute les contraintes fixant l'état à la position @p pos : le nœud @p node à hauteur 0, avec un 4 en bas de la pile et rien au-dessus.
+ *
+ * @param ctx    Contexte Z3.
+ * @param node   Le nœud attendu.
+ * @param pos    La position.
+ * @param length Longueur exacte du chemin cherché.
+ * @param out    Destination des contraintes.
+ */
+static void tn_endpoint_constraints(Z3_context ctx, int node, int pos, int length, tn_constraints *out)
+{
+    int H = get_stack_size(length);
+
+    tn_add(out, tn_path_variable(ctx, node, pos, 0));
+
+    tn_add(out, tn_4_variable(ctx, pos, 0));
+    tn_add(out, Z3_mk_not(ctx, tn_6_variable(ctx, pos, 0)));
+
+    for (int h = 1; h < H; h++)
+    {
+        tn_add(out, Z3_mk_not(ctx, tn_4_variable(ctx, pos, h)));
+        tn_add(out, Z3_mk_not(ctx, tn_6_variable(ctx, pos, h)));
+    }
+}
+
+/**
+ * @brief φ_init : le premier état est (s,0) et la pile initiale est un 4 seul.
+ *
+ * @param ctx      Contexte Z3.
+ * @param network  Le TunnelNetwork analysé.
+ * @param length   Longueur exacte du chemin cherché.
+ * @param out      Destination des contraintes.
+ */
+static void tn_init_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    tn_endpoint_constraints(ctx, tn_get_initial(network), 0, length, out);
+}
+
+/**
+ * @brief φ_final : le dernier état est (t,0) et la pile finale est un 4 seul.
+ *
+ * @param ctx      Contexte Z3.
+ * @param network  Le TunnelNetwork analysé.
+ * @param length   Longueur exacte du chemin cherché.
+ * @param out      Destination des contraintes.
+ */
+static void tn_final_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    tn_endpoint_constraints(ctx, tn_get_final(network), length, length, out);
+}
+
+/**
+ * @brief Comme tn_endpoint_constraints, pour l'encodage bit-vector : le nœud @p node à hauteur 0, et la pile nulle (un 4 seul, les bits au-dessus du fond valant 0).
+ *
+ */
+static void tn_bv_endpoint_constraints(Z3_context ctx, int node, int pos, int length, tn_constraints *out)
+{
+    Z3_ast stack = tn_keep(out, tn_stack_variable(ctx, pos, length));
+
+    tn_add(out, tn_path_variable(ctx, node, pos, 0));
+    tn_add(out, Z3_mk_eq(ctx, stack, Z3_mk_int(ctx, 0, Z3_get_sort(ctx, stack))));
+}
+
+/**
+ * @brief φ_init pour l'encodage bit-vector.
+ *
+ */
+static void tn_bv_init_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    tn_bv_endpoint_constraints(ctx, tn_get_initial(network), 0, length, out);
+}
+
+/**
+ * @brief φ_final pour l'encodage bit-vector.
+ *
+ */
+static void tn_bv_final_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    tn_bv_endpoint_constraints(ctx, tn_get_final(network), length, length, out);
+}
+
+/**
+ * @brief Famille sans contrainte : dans les encodages bit-vector et à domaines finis, la pile est bien formée et conservée par construction (φ_stack_validity, φ_stack_frame).
+ *
+ */
+static void tn_no_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+}
+
+/**
+ * @brief φ_projection : n(u,pos) ⇔ OR_h x(u,pos,h). Les familles qui ne dépendent pas de la hauteur (φ_edges, φ_simple) sont énoncées sur ces variables, ce qui leur évite une copie par couple de hauteurs.
+ *
+ * @param ctx      Contexte Z3.
+ * @param network  Le TunnelNetwork analysé.
+ * @param length   Longueur exacte du chemin cherché.
+ * @param out      Destination des contraintes.
+ */
+static void tn_projection_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    int N = tn_get_num_nodes(network);
+    int H = get_stack_size(length);
+    Z3_ast tmp[H];
+
+    for (int pos = 0; pos <= length; pos++)
+    {
+        for (int u = 0; u < N; u++)
+        {
+            Z3_ast n = tn_keep(out, tn_node_variable(ctx, u, pos));
+            for (int h = 0; h < H; h++)
+            {
+                tmp[h] = tn_keep(out, tn_path_variable(ctx, u, pos, h));
+                tn_add(out, Z3_mk_implies(ctx, tmp[h], n));
+            }
+            tn_add(out, Z3_mk_implies(ctx, n, Z3_mk_or(ctx, H, tmp)));
+        }
+        tn_release(out);
+    }
+}
+
+/**
+ * @brief φ_edges : le nœud suivant est un successeur du nœud courant (n(u,pos) → OR_{u→v} n(v,pos+1)).
+ *
+ * @param ctx      Contexte Z3.
+ * @param network  Le TunnelNetwork analysé.
+ * @param length   Longueur exacte du chemin cherché.
+ * @param out      Destination des contraintes.
+ */
+static void tn_edges_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    int N = tn_get_num_nodes(network);
+    Z3_ast tmp[N];
+
+    for (int pos = 0; pos < length; pos++)
+    {
+        for (int u = 0; u < N; u++)
+        {
+            int num_successors;
+            const int *successors = tn_get_successors(network, u, &num_successors);
+            for (int i = 0; i < num_successors; i++)
+                tmp[i] = tn_keep(out, tn_node_variable(ctx, successors[i], pos + 1));
+
+            Z3_ast n = tn_keep(out, tn_node_variable(ctx, u, pos));
+            if (num_successors > 0)
+                tn_add(out, Z3_mk_implies(ctx, n, Z3_mk_or(ctx, num_successors, tmp)));
+            else
+                tn_add(out, Z3_mk_not(ctx, n));
+        }
+        tn_release(out);
+    }
+}
+
+/**
+ * @brief φ_simple : un chemin simple (un même nœud est à au plus une position).
+ *
+ * @param ctx      Contexte Z3.
+ * @param network  Le TunnelNetwork analysé.
+ * @param length   Longueur exacte du chemin cherché.
+ * @param out      Destination des contraintes.
+ */
+static void tn_simple_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    int N = tn_get_num_nodes(network);
+    Z3_ast absent[length + 1];
+
+    for (int u = 0; u < N; u++)
+    {
+        for (int pos = 0; pos <= length; pos++)
+            absent[pos] = tn_keep(out, Z3_mk_not(ctx, tn_node_variable(ctx, u, pos)));
+
+        for (int pos1 = 0; pos1 <= length; pos1++)
+        {
+            for (int pos2 = pos1 + 1; pos2 <= length; pos2++)
+            {
+                /* interdit : n(u,pos1) et n(u,pos2) */
+                Z3_ast forbid_args[2] = {absent[pos1], absent[pos2]};
+                tn_add(out, Z3_mk_or(ctx, 2, forbid_args));
+            }
+        }
+        tn_release(out);
+    }
+}
+
+/**
+ * @brief φ_stack_frame : les contraintes de pile qui ne dépendent pas du nœud, énoncées une fois par (pos,hauteur) plutôt que dans chaque transition.
+ *  - x(u,pos,h) → z(pos,h) : la variable de hauteur z vaut dès qu'un état de hauteur h est à la position pos ;
+ *  - z(pos,h) → case h occupée et case h+1 vide (avec φ_stack_validity, toutes les cases au-dessus sont vides) ;
+ *  - une case occupée aux positions pos et pos+1 garde son contenu : ce sont exactement les cases sous le plus bas des deux sommets, sommet compris.
+ *
+ * @param ctx      Contexte Z3.
+ * @param network  Le TunnelNetwork analysé.
+ * @param length   Longueur exacte du chemin cherché.
+ * @param out      Destination des contraintes.
+ */
+static void tn_stack_frame_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    int N = tn_get_num_nodes(network);
+    int H = get_stack_size(length);
+
+    for (int pos = 0; pos <= length; pos++)
+    {
+        for (int h = 0; h < H; h++)
+        {
+            Z3_ast z = tn_keep(out, tn_height_variable(ctx, pos, h));
+
+            for (int u = 0; u < N; u++)
+                tn_add(out, Z3_mk_implies(ctx, tn_path_variable(ctx, u, pos, h), z));
+
+            Z3_ast occupied[2] = {tn_keep(out, tn_4_variable(ctx, pos, h)), tn_keep(out, tn_6_variable(ctx, pos, h))};
+            tn_add(out, Z3_mk_implies(ctx, z, Z3_mk_or(ctx, 2, occupied)));
+            if (h + 1 < H)
+            {
+                tn_add(out, Z3_mk_implies(ctx, z, Z3_mk_not(ctx, tn_4_variable(ctx, pos, h + 1))));
+                tn_add(out, Z3_mk_implies(ctx, z, Z3_mk_not(ctx, tn_6_variable(ctx, pos, h + 1))));
+            }
+        }
+        tn_release(out);
+    }
+
+    for (int pos = 0; pos < length; pos++)
+    {
+        for (int h = 0; h < H; h++)
+        {
+            Z3_ast y4 = tn_keep(out, tn_4_variable(ctx, pos, h));
+            Z3_ast y6 = tn_keep(out, tn_6_variable(ctx, pos, h));
+            Z3_ast next_y4 = tn_keep(out, tn_4_variable(ctx, pos + 1, h));
+            Z3_ast next_y6 = tn_keep(out, tn_6_variable(ctx, pos + 1, h));
+            Z3_ast kept[2] = {
+                tn_keep(out, Z3_mk_or(ctx, 2, (Z3_ast[]){y4, y6})),
+                tn_keep(out, Z3_mk_or(ctx, 2, (Z3_ast[]){next_y4, next_y6}))};
+            Z3_ast same[2] = {
+                tn_keep(out, Z3_mk_iff(ctx, y4, next_y4)),
+                tn_keep(out, Z3_mk_iff(ctx, y6, next_y6))};
+            Z3_ast both_kept = tn_keep(out, Z3_mk_and(ctx, 2, kept));
+            tn_add(out, Z3_mk_implies(ctx, both_kept, Z3_mk_and(ctx, 2, same)));
+        }
+        tn_release(out);
+    }
+}
+
+/**
+ * @brief The symbol at depth @p depth below the top of the stack @p stack of the bit-vector encoding (depth 0 for the top) is @p symbol. Its intermediate terms are kept by @p out.
+ *
+ */
+static Z3_ast tn_stack_symbol_is(tn_constraints *out, Z3_ast stack, int depth, stack_symbol symbol)
+{
+    Z3_ast bit = tn_keep(out, Z3_mk_extract(out->ctx, depth, depth, stack));
+    return Z3_mk_eq(out->ctx, bit, Z3_mk_int(out->ctx, symbol, Z3_mk_bv_sort(out->ctx, 1)));
+}
+
+/**
+ * @brief La variable y(pos,height,symbol) : la case @p height de la pile contient @p symbol à la position @p pos.
+ *
+ */
+static Z3_ast tn_symbol_variable(Z3_context ctx, int pos, int height, stack_symbol symbol)
+{
+    return symbol == symbol_4 ? tn_4_variable(ctx, pos, height) : tn_6_variable(ctx, pos, height);
+}
+
+/**
+ * @brief Ajoute dans @p conds les conditions de pile de l'action de règle @p rule entre les positions @p pos et pos+1, depuis la hauteur @p hs.
+ *  - booléen : sommet (et case en dessous pour un pop) à pos, nouveau sommet à pos+1 ; le reste de la pile est conservé par φ_stack_frame ;
+ *  - bit-vector : bits 0 (et 1 pour un pop) de S_pos, et S_{pos+1} obtenu de S_pos par décalage (le sommet entre ou sort par le bit 0). Ces termes ne dépendent ni du nœud ni de la hauteur, et sont donc partagés.
+ *
+ * Les conditions (et leurs termes intermédiaires) sont gardées par @p out.
+ *
+ * @return int Le nombre de conditions ajoutées.
+ */
+static int tn_action_stack_conditions(tn_constraints *out, tn_stack_encoding encoding, int length, int pos, int hs, const tn_action_rule *rule, Z3_ast *conds)
+{
+    Z3_context ctx = out->ctx;
+    int c = 0;
+    int hs2 = hs + rule->height_delta;
+
+    if (encoding == tn_boolean_stack)
+    {
+        conds[c++] = tn_keep(out, tn_symbol_variable(ctx, pos, hs, rule->top));
+        if (rule->below != symbol_none)
+            conds[c++] = tn_keep(out, tn_symbol_variable(ctx, pos, hs - 1, rule->below));
+        /* nouveau sommet (φ_stack_validity interdit l'autre symbole dans la même case) */
+        conds[c++] = tn_keep(out, tn_symbol_variable(ctx, pos + 1, hs2, rule->new_top));
+        return c;
+    }
+
+    int H = get_stack_size(length);
+    Z3_ast stack = tn_keep(out, tn_stack_variable(ctx, pos, length));
+    Z3_ast next = tn_keep(out, tn_stack_variable(ctx, pos + 1, length));
+
+    conds[c++] = tn_keep(out, tn_stack_symbol_is(out, stack, 0, rule->top));
+    if (rule->below != symbol_none)
+        conds[c++] = tn_keep(out, tn_stack_symbol_is(out, stack, 1, rule->below));
+
+    Z3_ast updated = stack;
+    if (rule->height_delta > 0)
+    {
+        Z3_ast kept = tn_keep(out, Z3_mk_extract(ctx, H - 2, 0, stack));
+        updated = tn_keep(out, Z3_mk_concat(ctx, kept, Z3_mk_int(ctx, rule->new_top, Z3_mk_bv_sort(ctx, 1))));
+    }
+    else if (rule->height_delta < 0)
+    {
+        Z3_ast bottom = tn_keep(out, Z3_mk_int(ctx, 0, Z3_mk_bv_sort(ctx, 1)));
+        updated = tn_keep(out, Z3_mk_concat(ctx, bottom, Z3_mk_extract(ctx, H - 1, 1, stack)));
+    }
+    conds[c++] = tn_keep(out, Z3_mk_eq(ctx, next, updated));
+    return c;
+}
+
+/**
+ * @brief φ_transitions : si le couple (u,hs) est à la position pos, alors l'une des actions de u fait passer correctement à la position pos+1.
+ * Chaque action est traduite depuis sa règle (tn_action_rules) : sommet requis, case requise en dessous, variation de hauteur et nouveau sommet. Un couple (u,hs) depuis lequel aucune action n'est possible est interdit.
+ * Seules les une ou deux cases du sommet sont contraintes ici : le reste de la pile est conservé par φ_stack_frame (encodage booléen) ou par le décalage (encodage bit-vector).
+ *
+ * @param ctx      Contexte Z3.
+ * @param network  Le TunnelNetwork analysé.
+ * @param length   Longueur exacte du chemin cherché.
+ * @param encoding L'encodage de la pile.
+ * @param out      Destination des contraintes.
+ */
+static void tn_encoded_transitions_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_stack_encoding encoding, tn_constraints *out)
+{
+    int N = tn_get_num_nodes(network);
+    int H = get_stack_size(length);
+
+    /* Tableau temporaire pour fabriquer des OR/AND */
+    Z3_ast tmp[N];
+    Z3_ast conds[4];
+
+    for (int pos = 0; pos < length; pos++)
+    {
+        for (int u = 0; u < N; u++)
+        {
+            for (int hs = 0; hs < H; hs++)
+            {
+                Z3_ast xu = tn_keep(out, tn_path_variable(ctx, u, pos, hs));
+
+                Z3_ast actions[NumActions];
+                int ac = 0;
+
+                for (stack_action act = 0; act < NumActions; act++)
+                {
+                    if (!tn_node_has_action(network, u, act))
+                        continue;
+
+                    const tn_action_rule *rule = &tn_action_rules[act];
+                    int hs2 = hs + rule->height_delta;
+                    if (hs2 < 0 || hs2 >= H)
+                        continue;
+
+                    int c = tn_action_stack_conditions(out, encoding, length, pos, hs, rule, conds);
+
+                    /* edge(u,v) et (v,pos+1,hs2) */
+                    int a = 0;
+                    for (int v = 0; v < N; v++)
+                        if (tn_is_edge(network, u, v))
+                            tmp[a++] = tn_keep(out, tn_path_variable(ctx, v, pos + 1, hs2));
+
+                    conds[c++] = tn_keep(out, Z3_mk_or(ctx, a, tmp));
+
+                    actions[ac++] = tn_keep(out, Z3_mk_and(ctx, c, conds));
+                }
+
+                /* ==========================================
+                 * si x(u,pos,hs) alors OR(actions)
+                 * ========================================== */
+                if (ac > 0)
+                    tn_add(out, Z3_mk_implies(ctx, xu, Z3_mk_or(ctx, ac, actions)));
+                else
+                    tn_add(out, Z3_mk_not(ctx, xu));
+                tn_release(out);
+            }
+        }
+    }
+}
+
+/**
+ * @brief φ_transitions pour l'encodage booléen.
+ *
+ */
+static void tn_transitions_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    tn_encoded_transitions_constraints(ctx, network, length, tn_boolean_stack, out);
+}
+
+/**
+ * @brief φ_transitions pour l'encodage bit-vector.
+ *
+ */
+static void tn_bv_transitions_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    tn_encoded_transitions_constraints(ctx, network, length, tn_bitvector_stack, out);
+}
+
+/**
+ * @brief Le pas depuis @p pos change la hauteur de @p height_delta (1 : un push, -1 : un pop) : OR des variables d'action correspondantes.
+ *
+ */
+static Z3_ast tn_nested_kind(tn_constraints *out, int pos, int height_delta)
+{
+    Z3_ast actions[NumActions];
+    int a = 0;
+    for (stack_action act = 0; act < NumActions; act++)
+        if (tn_action_rules[act].height_delta == height_delta)
+            actions[a++] = tn_keep(out, tn_action_variable(out->ctx, pos, act));
+    return Z3_mk_or(out->ctx, a, actions);
+}
+
+/**
+ * @brief φ_unicity pour l'encodage imbriqué : à chaque position, exactement un nœud n(u,pos) ; à chaque pas, exactement une action a(pos,act).
+ *
+ * @param ctx      Contexte Z3.
+ * @param network  Le TunnelNetwork analysé.
+ * @param length   Longueur exacte du chemin cherché.
+ * @param out      Destination des contraintes.
+ */
+static void tn_nested_unicity_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    int N = tn_get_num_nodes(network);
+    Z3_ast tmp[N > NumActions ? N : NumActions];
+
+    for (int pos = 0; pos <= length; pos++)
+    {
+        for (int u = 0; u < N; u++)
+            tmp[u] = tn_keep(out, tn_node_variable(ctx, u, pos));
+        tn_add_exactly_one(out, tmp, N);
+        tn_release(out);
+
+        if (pos == length)
+            continue;
+        for (stack_action act = 0; act < NumActions; act++)
+            tmp[act] = tn_keep(out, tn_action_variable(ctx, pos, act));
+        tn_add_exactly_one(out, tmp, NumActions);
+        tn_release(out);
+    }
+}
+
+/**
+ * @brief φ_stack_validity pour l'encodage imbriqué : les push et les pop forment un mot bien parenthésé.
+ *  - chaque push (resp. pop) est apparié à exactement un pop ultérieur (resp. un push antérieur), et m(i,j) n'apparie qu'un push i à un pop j ;
+ *  - deux paires ne se croisent pas : pas de m(i,j) et m(i',j') avec i < i' < j < j'.
+ * Tout push étant apparié, la pile finale est la pile initiale ; tout pop l'étant, la pile ne descend jamais sous le fond.
+ *
+ * @param ctx      Contexte Z3.
+ * @param network  Le TunnelNetwork analysé.
+ * @param length   Longueur exacte du chemin cherché.
+ * @param out      Destination des contraintes.
+ */
+static void tn_nested_matching_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    Z3_ast tmp[length];
+
+    for (int i = 0; i < length; i++)
+    {
+        /* le push de i est apparié à exactement un pop */
+        int a = 0;
+        for (int j = i + 1; j < length; j++)
+            tmp[a++] = tn_keep(out, tn_match_variable(ctx, i, j));
+        Z3_ast push = tn_keep(out, tn_nested_kind(out, i, 1));
+        if (a == 0)
+            tn_add(out, Z3_mk_not(ctx, push));
+        else
+        {
+            tn_add(out, Z3_mk_implies(ctx, push, Z3_mk_or(ctx, a, tmp)));
+            tn_add_at_most_one(out, tmp, a);
+        }
+
+        /* le pop de i est apparié à exactement un push */
+        a = 0;
+        for (int j = i - 1; j >= 0; j--)
+            tmp[a++] = tn_keep(out, tn_match_variable(ctx, j, i));
+        Z3_ast pop = tn_keep(out, tn_nested_kind(out, i, -1));
+        if (a == 0)
+            tn_add(out, Z3_mk_not(ctx, pop));
+        else
+        {
+            tn_add(out, Z3_mk_implies(ctx, pop, Z3_mk_or(ctx, a, tmp)));
+            tn_add_at_most_one(out, tmp, a);
+        }
+        tn_release(out);
+    }
+
+    for (int i = 0; i < length; i++)
+    {
+        for (int j = i + 1; j < length; j++)
+        {
+            Z3_ast m = tn_keep(out, tn_match_variable(ctx, i, j));
+            tn_add(out, Z3_mk_implies(ctx, m, tn_nested_kind(out, i, 1)));
+            tn_add(out, Z3_mk_implies(ctx, m, tn_nested_kind(out, j, -1)));
+
+            /* pas de croisement : i < i2 < j < j2 */
+            Z3_ast unmatched = tn_keep(out, Z3_mk_not(ctx, m));
+            for (int i2 = i + 1; i2 < j; i2++)
+                for (int j2 = j + 1; j2 < length; j2++)
+                {
+                    Z3_ast forbid_args[2] = {
+                        unmatched,
+                        tn_keep(out, Z3_mk_not(ctx, tn_match_variable(ctx, i2, j2)))};
+                    tn_add(out, Z3_mk_or(ctx, 2, forbid_args));
+                }
+            tn_release(out);
+        }
+    }
+}
+
+/**
+ * @brief Fixe l'état de la position @p pos pour l'encodage imbriqué : le nœud @p node, et un 4 au sommet (la pile n'a que son fond, par le bon parenthésage).
+ *
+ */
+static void tn_nested_endpoint_constraints(Z3_context ctx, int node, int pos, tn_constraints *out)
+{
+    tn_add(out, tn_node_variable(ctx, node, pos));
+    tn_add(out, Z3_mk_not(ctx, tn_top_variable(ctx, pos)));
+}
+
+/**
+ * @brief φ_init pour l'encodage imbriqué.
+ *
+ */
+static void tn_nested_init_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    tn_nested_endpoint_constraints(ctx, tn_get_initial(network), 0, out);
+}
+
+/**
+ * @brief φ_final pour l'encodage imbriqué.
+ *
+ */
+static void tn_nested_final_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    tn_nested_endpoint_constraints(ctx, tn_get_final(network), length, out);
+}
+
+/**
+ * @brief φ_stack_frame pour l'encodage imbriqué : un pop découvre la case sous son sommet, qui est le sommet d'avant le push apparié (m(i,j) → t(j+1) ⇔ t(i)).
+ * C'est le seul lien entre des positions non consécutives : les cases sous le sommet ne sont jamais représentées.
+ *
+ * @param ctx      Contexte Z3.
+ * @param network  Le TunnelNetwork analysé.
+ * @param length   Longueur exacte du chemin cherché.
+ * @param out      Destination des contraintes.
+ */
+static void tn_nested_agreement_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    for (int i = 0; i < length; i++)
+        for (int j = i + 1; j < length; j++)
+        {
+            Z3_ast m = tn_keep(out, tn_match_variable(ctx, i, j));
+            Z3_ast uncovered = tn_keep(out, tn_top_variable(ctx, j + 1));
+            tn_add(out, Z3_mk_implies(ctx, m, Z3_mk_iff(ctx, uncovered, tn_top_variable(ctx, i))));
+            tn_release(out);
+        }
+}
+
+/**
+ * @brief φ_transitions pour l'encodage imbriqué : l'action du pas depuis pos est une action du nœud de pos, et fait passer le sommet de son symbole requis (t(pos)) à son nouveau sommet (t(pos+1)).
+ *
+ * @param ctx      Contexte Z3.
+ * @param network  Le TunnelNetwork analysé.
+ * @param length   Longueur exacte du chemin cherché.
+ * @param out      Destination des contraintes.
+ */
+static void tn_nested_transitions_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    int N = tn_get_num_nodes(network);
+    Z3_ast actions[NumActions];
+
+    for (int pos = 0; pos < length; pos++)
+    {
+        for (int u = 0; u < N; u++)
+        {
+            int a = 0;
+            for (stack_action act = 0; act < NumActions; act++)
+                if (tn_node_has_action(network, u, act))
+                    actions[a++] = tn_keep(out, tn_action_variable(ctx, pos, act));
+
+            Z3_ast n = tn_keep(out, tn_node_variable(ctx, u, pos));
+            if (a > 0)
+                tn_add(out, Z3_mk_implies(ctx, n, Z3_mk_or(ctx, a, actions)));
+            else
+                tn_add(out, Z3_mk_not(ctx, n));
+        }
+
+        for (stack_action act = 0; act < NumActions; act++)
+        {
+            const tn_action_rule *rule = &tn_action_rules[act];
+            Z3_ast top = tn_keep(out, tn_top_variable(ctx, pos));
+            Z3_ast new_top = tn_keep(out, tn_top_variable(ctx, pos + 1));
+            Z3_ast conds[2] = {
+                rule->top == symbol_6 ? top : tn_keep(out, Z3_mk_not(ctx, top)),
+                rule->new_top == symbol_6 ? new_top : tn_keep(out, Z3_mk_not(ctx, new_top))};
+            Z3_ast performed = tn_keep(out, tn_action_variable(ctx, pos, act));
+            tn_add(out, Z3_mk_implies(ctx, performed, Z3_mk_and(ctx, 2, conds)));
+        }
+        tn_release(out);
+    }
+}
+
+/**
+ * @brief φ_unicity pour l'encodage à domaines finis : un seul nœud et une seule hauteur par position par construction, il reste à borner leurs domaines (0 ≤ p(pos) < N, 0 ≤ h(pos) < H).
+ *
+ * @param ctx      Contexte Z3.
+ * @param network  Le TunnelNetwork analysé.
+ * @param length   Longueur exacte du chemin cherché.
+ * @param out      Destination des contraintes.
+ */
+static void tn_fd_domain_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    int N = tn_get_num_nodes(network);
+    int H = get_stack_size(length);
+
+    for (int pos = 0; pos <= length; pos++)
+    {
+        Z3_ast node = tn_keep(out, tn_position_term(ctx, pos));
+        Z3_ast level = tn_keep(out, tn_level_term(ctx, pos));
+        tn_add(out, Z3_mk_ge(ctx, node, tn_int(ctx, 0)));
+        tn_add(out, Z3_mk_lt(ctx, node, tn_int(ctx, N)));
+        tn_add(out, Z3_mk_ge(ctx, level, tn_int(ctx, 0)));
+        tn_add(out, Z3_mk_lt(ctx, level, tn_int(ctx, H)));
+        tn_release(out);
+    }
+}
+
+/**
+ * @brief Fixe l'état de la position @p pos pour l'encodage à domaines finis : le nœud @p node à hauteur 0, et la pile nulle (un 4 seul).
+ *
+ */
+static void tn_fd_endpoint_constraints(Z3_context ctx, int node, int pos, int length, tn_constraints *out)
+{
+    Z3_ast stack = tn_keep(out, tn_stack_variable(ctx, pos, length));
+    Z3_ast node_term = tn_keep(out, tn_position_term(ctx, pos));
+    Z3_ast level = tn_keep(out, tn_level_term(ctx, pos));
+
+    tn_add(out, Z3_mk_eq(ctx, node_term, tn_int(ctx, node)));
+    tn_add(out, Z3_mk_eq(ctx, level, tn_int(ctx, 0)));
+    tn_add(out, Z3_mk_eq(ctx, stack, Z3_mk_int(ctx, 0, Z3_get_sort(ctx, stack))));
+}
+
+/**
+ * @brief φ_init pour l'encodage à domaines finis.
+ *
+ */
+static void tn_fd_init_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    tn_fd_endpoint_constraints(ctx, tn_get_initial(network), 0, length, out);
+}
+
+/**
+ * @brief φ_final pour l'encodage à domaines finis.
+ *
+ */
+static void tn_fd_final_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    tn_fd_endpoint_constraints(ctx, tn_get_final(network), length, length, out);
+}
+
+/**
+ * @brief φ_edges pour l'encodage à domaines finis, en table : p(pos) = u → OR_{u→v} p(pos+1) = v.
+ *
+ * @param ctx      Contexte Z3.
+ * @param network  Le TunnelNetwork analysé.
+ * @param length   Longueur exacte du chemin cherché.
+ * @param out      Destination des contraintes.
+ */
+static void tn_fd_edges_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    int N = tn_get_num_nodes(network);
+    Z3_ast tmp[N];
+
+    for (int pos = 0; pos < length; pos++)
+    {
+        Z3_ast node = tn_keep(out, tn_position_term(ctx, pos));
+        Z3_ast next = tn_keep(out, tn_position_term(ctx, pos + 1));
+        for (int u = 0; u < N; u++)
+        {
+            int num_successors;
+            const int *successors = tn_get_successors(network, u, &num_successors);
+            for (int i = 0; i < num_successors; i++)
+                tmp[i] = tn_keep(out, Z3_mk_eq(ctx, next, tn_int(ctx, successors[i])));
+
+            Z3_ast is_u = tn_keep(out, Z3_mk_eq(ctx, node, tn_int(ctx, u)));
+            if (num_successors > 0)
+                tn_add(out, Z3_mk_implies(ctx, is_u, Z3_mk_or(ctx, num_successors, tmp)));
+            else
+                tn_add(out, Z3_mk_not(ctx, is_u));
+        }
+        tn_release(out);
+    }
+}
+
+/**
+ * @brief φ_simple pour l'encodage à domaines finis : une seule contrainte distinct(p(0), ..., p(length)).
+ *
+ * @param ctx      Contexte Z3.
+ * @param network  Le TunnelNetwork analysé.
+ * @param length   Longueur exacte du chemin cherché.
+ * @param out      Destination des contraintes.
+ */
+static void tn_fd_simple_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    Z3_ast nodes[length + 1];
+
+    for (int pos = 0; pos <= length; pos++)
+        nodes[pos] = tn_keep(out, tn_position_term(ctx, pos));
+    tn_add(out, Z3_mk_distinct(ctx, length + 1, nodes));
+}
+
+/**
+ * @brief φ_transitions pour l'encodage à domaines finis : si p(pos) = u, l'une des actions de u fait passer à la position pos+1.
+ * Les conditions de pile sont celles de l'encodage bit-vector, auxquelles s'ajoute h(pos+1) = h(pos) + variation de hauteur ; un pop depuis la hauteur 0 ou un push au-delà de H sont exclus par φ_unicity.
+ *
+ * @param ctx      Contexte Z3.
+ * @param network  Le TunnelNetwork analysé.
+ * @param length   Longueur exacte du chemin cherché.
+ * @param out      Destination des contraintes.
+ */
+static void tn_fd_transitions_constraints(Z3_context ctx, const TunnelNetwork network, int length, tn_constraints *out)
+{
+    int N = tn_get_num_nodes(network);
+    int H = get_stack_size(length);
+    Z3_ast conds[4];
+
+    for (int pos = 0; pos < length; pos++)
+    {
+        /* les conditions d'une action ne dépendent pas du nœud : elles sont construites une fois par position */
+        Z3_ast steps[NumActions];
+        for (stack_action act = 0; act < NumActions; act++)
+        {
+            const tn_action_rule *rule = &tn_action_rules[act];
+            /* une pile d'une seule case ne permet ni push ni pop */
+            if (rule->height_delta != 0 && H < 2)
+            {
+                steps[act] = tn_keep(out, Z3_mk_false(ctx));
+                continue;
+            }
+            int c = tn_action_stack_conditions(out, tn_bitvector_stack, length, pos, 0, rule, conds);
+            Z3_ast level[2] = {tn_keep(out, tn_level_term(ctx, pos)), tn_keep(out, tn_int(ctx, rule->height_delta))};
+            Z3_ast next_level = tn_keep(out, tn_level_term(ctx, pos + 1));
+            conds[c++] = tn_keep(out, Z3_mk_eq(ctx, next_level, Z3_mk_add(ctx, 2, level)));
+            steps[act] = tn_keep(out, Z3_mk_and(ctx, c, conds));
+        }
+
+        Z3_ast node = tn_keep(out, tn_position_term(ctx, pos));
+        for (int u = 0; u < N; u++)
+        {
+            Z3_ast actions[NumActions];
+            int ac = 0;
+            for (stack_action act = 0; act < NumActions; act++)
+                if (tn_node_has_action(network, u, act))
+                    actions[ac++] = steps[act];
+
+            Z3_ast is_u = tn_keep(out, Z3_mk_eq(ctx, node, tn_int(ctx, u)));
+            if (ac > 0)
+                tn_add(out, Z3_mk_implies(ctx, is_u, Z3_mk_or(ctx, ac, actions)));
+            else
+                tn_add(out, Z3_mk_not(ctx, is_u));
+        }
+        tn_release(out);
+    }
+}
+
 /**
- * @brief Wrapper to have the correct size of the array representing the stack (correct cells of the stack will be from 0 to (get_stack_size(length)-1)).
+ * @brief Les fonctions construisant chaque famille de contraintes, pour chaque encodage de la pile, dans l'ordre de tn_constraint_family.
  *
- * @param length The length of the sought path.
- * @return int
  */
-int get_stack_size(int length)
+static const tn_family_builder tn_family_builders[NumStackEncodings][NumConstraintFamilies] = {
+    [tn_boolean_stack] = {
+        tn_unicity_constraints,
+        tn_stack_validity_constraints,
+        tn_init_constraints,
+        tn_final_constraints,
+        tn_projection_constraints,
+        tn_edges_constraints,
+        tn_simple_constraints,
+        tn_stack_frame_constraints,
+        tn_transitions_constraints},
+    [tn_bitvector_stack] = {
+        tn_unicity_constraints,
+        tn_no_constraints,
+        tn_bv_init_constraints,
+        tn_bv_final_constraints,
+        tn_projection_constraints,
+        tn_edges_constraints,
+        tn_simple_constraints,
+        tn_no_constraints,
+        tn_bv_transitions_constraints},
+    [tn_nested_stack] = {
+        tn_nested_unicity_constraints,
+        tn_nested_matching_constraints,
+        tn_nested_init_constraints,
+        tn_nested_final_constraints,
+        tn_no_constraints,
+        tn_edges_constraints,
+        tn_simple_constraints,
+        tn_nested_agreement_constraints,
+        tn_nested_transitions_constraints},
+    [tn_finite_domain] = {
+        tn_fd_domain_constraints,
+        tn_no_constraints,
+        tn_fd_init_constraints,
+        tn_fd_final_constraints,
+        tn_no_constraints,
+        tn_fd_edges_constraints,
+        tn_fd_simple_constraints,
+        tn_no_constraints,
+        tn_fd_transitions_constraints}};
+
+static const char *tn_stack_encoding_names[NumStackEncodings] = {
+    "boolean",
+    "bitvector",
+    "nested",
+    "finite"};
+
+const char *tn_stack_encoding_name(tn_stack_encoding encoding)
 {
-    return length / 2 + 1;
+    return tn_stack_encoding_names[encoding];
+}
+
+bool tn_stack_encoding_of_name(const char *name, tn_stack_encoding *encoding)
+{
+    for (tn_stack_encoding candidate = 0; candidate < NumStackEncodings; candidate++)
+        if (strcmp(name, tn_stack_encoding_names[candidate]) == 0)
+        {
+            *encoding = candidate;
+            return true;
+        }
+    return false;
 }
+
+static const char *tn_family_names[NumConstraintFamilies] = {
+    "unicity",
+    "stack_validity",
+    "init",
+    "final",
+    "projection",
+    "edges",
+    "simple",
+    "stack_frame",
+    "transitions"};
+
+const char *tn_constraint_family_name(tn_constraint_family family)
+{
+    return tn_family_names[family];
+}
+
 /**
- * @brief Construit toute la formule SAT décrivant un chemin valide.
+ * @brief Construit les familles de contraintes non omises dans @p out, et en remplit les statistiques si elles sont demandées.
  *
  * Cette fonction regroupe TOUTES les contraintes du sujet :
  *  - φ_unicity : unicité du couple (node,height) à chaque position
  *  - φ_stack_validity : stack cohérente et sans trous
  *  - φ_init : contraintes d’état initial + pile initiale
  *  - φ_final : contraintes d’état final + pile finale
+ *  - φ_projection : nœud de chaque position, quelle que soit la hauteur
  *  - φ_edges : respecter les arêtes du graphe
  *  - φ_simple : chemin simple (pas de nœud répété)
+ *  - φ_stack_frame : hauteur de pile de chaque position, et conservation des cases sous les sommets
  *  - φ_transitions : correspondance exacte avec les règles push/pop/transmit
  *
- * Le résultat est une  conjonction (AND) de toutes ces contraintes.
+ * Les familles dont le bit (1 << famille) est dans @p omitted ne sont pas construites (leurs statistiques sont nulles) : elles sont alors à la charge de l'appelant.
  *
- * @param ctx      Contexte Z3.
  * @param network  Le TunnelNetwork analysé.
  * @param length   Longueur exacte du chemin cherché.
- *
- * @return La formule Z3 (conjonction de toutes les contraintes).
+ * @param encoding L'encodage de la pile (les familles qui ne le concernent pas sont communes).
+ * @param omitted  Les familles à ne pas construire.
+ * @param out      Destination des contraintes.
  */
-
-Z3_ast tn_reduction(Z3_context ctx, const TunnelNetwork network, int length)
+static void tn_build_reduction(const TunnelNetwork network, int length, tn_stack_encoding encoding, unsigned omitted, tn_constraints *out)
 {
-    int N = tn_get_num_nodes(network);
-    int H = get_stack_size(length);
-
-    /* Un très grand tableau pour accumuler les contraintes */
-    Z3_ast C[300000];
-    int k = 0;
-
-    /* Tableau temporaire pour fabriquer des OR/AND */
-    Z3_ast tmp[20000];
-
-    /* ===========================================================
-     * φ_unicity : unicité du couple (node,height) à chaque position
-     * =========================================================== */
-
-    for (int pos = 0; pos <= length; pos++)
-    {
-        /* ---------------------------
-         * (1) Au moins un état possible
-         * --------------------------- */
-        int a = 0;
-        for (int u = 0; u < N; u++)
-            for (int h = 0; h < H; h++)
-                tmp[a++] = tn_path_variable(ctx, u, pos, h);
-
-        C[k++] = Z3_mk_or(ctx, a, tmp);
-
-        /* ---------------------------
-         * (2) Au plus un : on interdit deux états simultanés
-         * --------------------------- */
-        for (int u1 = 0; u1 < N; u1++)
-            for (int h1 = 0; h1 < H; h1++)
-                for (int u2 = 0; u2 < N; u2++)
-                    for (int h2 = 0; h2 < H; h2++)
-                    {
-                        if (u1 == u2 && h1 == h2)
-                            continue;
-
-                        Z3_ast forbid_args[2] = {
-                            Z3_mk_not(ctx, tn_path_variable(ctx, u1, pos, h1)),
-                            Z3_mk_not(ctx, tn_path_variable(ctx, u2, pos, h2))};
-                        C[k++] = Z3_mk_or(ctx, 2, forbid_args);
-                    }
-    }
-    /* ===========================================================
-     * φ_stack_validity : la pile est bien formée
-     * =========================================================== */
-
-    for (int pos = 0; pos <= length; pos++)
+    for (tn_constraint_family family = 0; family < NumConstraintFamilies; family++)
     {
-        for (int h = 0; h < H; h++)
-        {
-            /* Interdit : y4(pos,h) ET y6(pos,h) */
-            Z3_ast both[2] = {
-                tn_4_variable(ctx, pos, h),
-                tn_6_variable(ctx, pos, h)};
-            Z3_ast and_both = Z3_mk_and(ctx, 2, both);
-
-            C[k++] = Z3_mk_not(ctx, and_both);
-        }
-
-        /* Pas de trou : si une case est vide, tout au-dessus est vide */
-        for (int h = 0; h < H; h++)
+        double start = metrics_now();
+        out->family = family;
+        if (out->stats != NULL)
         {
-            Z3_ast empty_h_args[2] = {
-                Z3_mk_not(ctx, tn_4_variable(ctx, pos, h)),
-                Z3_mk_not(ctx, tn_6_variable(ctx, pos, h))};
-            Z3_ast empty_h = Z3_mk_and(ctx, 2, empty_h_args);
-
-            for (int h2 = h + 1; h2 < H; h2++)
-            {
-                Z3_ast filled_above = Z3_mk_or(ctx, 2,
-                                               (Z3_ast[]){
-                                                   tn_4_variable(ctx, pos, h2),
-                                                   tn_6_variable(ctx, pos, h2)});
-
-                Z3_ast not_filled = Z3_mk_not(ctx, filled_above);
-                C[k++] = Z3_mk_implies(ctx, empty_h, not_filled);
-            }
+            out->stats->clauses[family] = 0;
+            out->stats->literals[family] = 0;
         }
-    }
-
-    /* ===========================================================
-     * φ_init : état initial + pile initiale
-     * =========================================================== */
-
-    int s = tn_get_initial(network);
 
-    /* Le premier état est (s,0) */
-    C[k++] = tn_path_variable(ctx, s, 0, 0);
+        if (!(omitted & (1u << family)))
+            tn_family_builders[encoding][family](out->ctx, network, length, out);
+        tn_release(out);
 
-    /* Pile initiale = un 4 en bas, vide au-dessus */
-    C[k++] = tn_4_variable(ctx, 0, 0);
-    C[k++] = Z3_mk_not(ctx, tn_6_variable(ctx, 0, 0));
-
-    for (int h = 1; h < H; h++)
-    {
-        C[k++] = Z3_mk_not(ctx, tn_4_variable(ctx, 0, h));
-        C[k++] = Z3_mk_not(ctx, tn_6_variable(ctx, 0, h));
+        if (out->stats != NULL)
+            out->stats->seconds[family] = metrics_now() - start;
     }
+}
 
-    /* ===========================================================
-     * φ_final : état final + pile finale
-     * =========================================================== */
-
-    int t = tn_get_final(network);
-
-    /* Dernier état = (t,0) */
-    C[k++] = tn_path_variable(ctx, t, length, 0);
-
-    /* Pile finale = 4 en bas, vide au-dessus */
-    C[k++] = tn_4_variable(ctx, length, 0);
-    C[k++] = Z3_mk_not(ctx, tn_6_variable(ctx, length, 0));
+void tn_assert_reduction(Z3_context ctx, Z3_solver solver, const TunnelNetwork network, int length, tn_stack_encoding encoding, unsigned omitted, tn_reduction_stats *stats)
+{
+    tn_constraints out = tn_open_constraints(ctx, solver, stats);
+    tn_build_reduction(network, length, encoding, omitted, &out);
+    tn_close_constraints(&out);
+}
 
-    for (int h = 1; h < H; h++)
+Z3_ast tn_node_literal(Z3_context ctx, int node, int pos, tn_stack_encoding encoding)
+{
+    /* l'encodage à domaines finis n'a pas de variables n(u,pos) : on fixe le terme du noeud */
+    if (encoding == tn_finite_domain)
     {
-        C[k++] = Z3_mk_not(ctx, tn_4_variable(ctx, length, h));
-        C[k++] = Z3_mk_not(ctx, tn_6_variable(ctx, length, h));
+        Z3_ast node_term = tn_position_term(ctx, pos);
+        Z3_inc_ref(ctx, node_term);
+        Z3_ast literal = Z3_mk_eq(ctx, node_term, tn_int(ctx, node));
+        Z3_dec_ref(ctx, node_term);
+        return literal;
     }
-    /* ===========================================================
-     * φ_edges : on interdit les transitions (u → v) inexistantes
-     * =========================================================== */
+    return tn_node_variable(ctx, node, pos);
+}
 
-    for (int pos = 0; pos < length; pos++)
+int tn_hint_literals(Z3_context ctx, const tn_step *path, int size_path, tn_stack_encoding encoding, Z3_ast *literals)
+{
+    if (size_path == 0)
+        return 0;
+    for (int pos = 0; pos <= size_path; pos++)
     {
-        for (int u = 0; u < N; u++)
-        {
-            for (int v = 0; v < N; v++)
-            {
-                if (!tn_is_edge(network, u, v))
-                {
-                    /* Interdire : (u,pos,h1) & (v,pos+1,h2) */
-                    for (int h1 = 0; h1 < H; h1++)
-                    {
-                        for (int h2 = 0; h2 < H; h2++)
-                        {
-                            Z3_ast forbid_args[2] = {
-                                Z3_mk_not(ctx, tn_path_variable(ctx, u, pos, h1)),
-                                Z3_mk_not(ctx, tn_path_variable(ctx, v, pos + 1, h2))};
-                            C[k++] = Z3_mk_or(ctx, 2, forbid_args);
-                        }
-                    }
-                }
-            }
-        }
+        literals[pos] = tn_node_literal(ctx, pos < size_path ? path[pos].source : path[size_path - 1].target, pos, encoding);
+        Z3_inc_ref(ctx, literals[pos]);
     }
+    return size_path + 1;
+}
 
-    /* ===========================================================
-     * φ_simple : un chemin simple (un même nœud ne peut être visité
-     *            à deux positions différentes)
-     * =========================================================== */
+Z3_ast tn_reduction(Z3_context ctx, const TunnelNetwork network, int length)
+{
+    tn_constraints out = tn_open_constraints(ctx, NULL, NULL);
+    tn_build_reduction(network, length, tn_boolean_stack, 0, &out);
 
-    for (int u = 0; u < N; u++)
-    {
-        for (int pos1 = 0; pos1 <= length; pos1++)
-        {
-            for (int pos2 = pos1 + 1; pos2 <= length; pos2++)
-            {
-                for (int h1 = 0; h1 < H; h1++)
-                {
-                    for (int h2 = 0; h2 < H; h2++)
-                    {
-                        /* interdit : (u,pos1,h1) et (u,pos2,h2) */
-                        Z3_ast forbid_args[2] = {
-                            Z3_mk_not(ctx, tn_path_variable(ctx, u, pos1, h1)),
-                            Z3_mk_not(ctx, tn_path_variable(ctx, u, pos2, h2))};
-                        C[k++] = Z3_mk_or(ctx, 2, forbid_args);
-                    }
-                }
-            }
-        }
-    }
     /* ===========================================================
-     * φ_transitions — VERSION CORRIGÉE
+     * Return : conjonction de toutes les contraintes
      * =========================================================== */
 
-    for (int pos = 0; pos < length; pos++)
-    {
-        for (int u = 0; u < N; u++)
-        {
-            for (int hs = 0; hs < H; hs++)
-            {
-                Z3_ast xu = tn_path_variable(ctx, u, pos, hs);
-
-                Z3_ast actions[2000];
-                int ac = 0;
-
-                /* ==========================================
-                 * TRANSMIT 4
-                 * ========================================== */
-                if (tn_node_has_action(network, u, transmit_4))
-                {
-                    if (hs < H)
-                    {
-                        Z3_ast conds[1000];
-                        int c = 0;
-
-                        /* sommet = 4 */
-                        conds[c++] = tn_4_variable(ctx, pos, hs);
-
-                        /* même hauteur, edge(u,v) */
-                        int a = 0;
-                        for (int v = 0; v < N; v++)
-                            if (tn_is_edge(network, u, v))
-                                tmp[a++] = tn_path_variable(ctx, v, pos + 1, hs);
-
-                        conds[c++] = Z3_mk_or(ctx, a, tmp);
-
-                        /* pile identique */
-                        for (int h = 0; h < H; h++)
-                        {
-                            Z3_ast eq4 = Z3_mk_iff(ctx,
-                                                   tn_4_variable(ctx, pos, h),
-                                                   tn_4_variable(ctx, pos + 1, h));
-
-                            Z3_ast eq6 = Z3_mk_iff(ctx,
-                                                   tn_6_variable(ctx, pos, h),
-                                                   tn_6_variable(ctx, pos + 1, h));
-
-                            Z3_ast both[2] = {eq4, eq6};
-                            conds[c++] = Z3_mk_and(ctx, 2, both);
-                        }
-
-                        actions[ac++] = Z3_mk_and(ctx, c, conds);
-                    }
-                }
-
-                /* ==========================================
-                 * TRANSMIT 6
-                 * ========================================== */
-                if (tn_node_has_action(network, u, transmit_6))
-                {
-                    if (hs < H)
-                    {
-                        Z3_ast conds[1000];
-                        int c = 0;
-
-                        conds[c++] = tn_6_variable(ctx, pos, hs);
-
-                        int a = 0;
-                        for (int v = 0; v < N; v++)
-                            if (tn_is_edge(network, u, v))
-                                tmp[a++] = tn_path_variable(ctx, v, pos + 1, hs);
-
-                        conds[c++] = Z3_mk_or(ctx, a, tmp);
-
-                        for (int h = 0; h < H; h++)
-                        {
-                            Z3_ast eq4 = Z3_mk_iff(ctx,
-                                                   tn_4_variable(ctx, pos, h),
-                                                   tn_4_variable(ctx, pos + 1, h));
-                            Z3_ast eq6 = Z3_mk_iff(ctx,
-                                                   tn_6_variable(ctx, pos, h),
-                                                   tn_6_variable(ctx, pos + 1, h));
-
-                            Z3_ast both[2] = {eq4, eq6};
-                            conds[c++] = Z3_mk_and(ctx, 2, both);
-                        }
-
-                        actions[ac++] = Z3_mk_and(ctx, c, conds);
-                    }
-                }
-
-                /* ==========================================
-                 * PUSH
-                 * ========================================== */
-                for (stack_action act = push_4_4; act <= push_6_6; act++)
-                {
-                    if (!tn_node_has_action(network, u, act))
-                        continue;
-
-                    if (hs + 1 < H)
-                    {
-                        int hs2 = hs + 1;
-
-                        bool topWas4 = (act == push_4_4 || act == push_4_6);
-                        bool pushedIs4 = (act == push_4_4 || act == push_6_4);
-
-                        Z3_ast conds[1000];
-                        int c = 0;
-
-                        /* sommet avant push */
-                        conds[c++] = topWas4 ? tn_4_variable(ctx, pos, hs) : tn_6_variable(ctx, pos, hs);
-
-                        /* edge(u,v) et (v,pos+1,hs2) */
-                        int a = 0;
-                        for (int v = 0; v < N; v++)
-                            if (tn_is_edge(network, u, v))
-                                tmp[a++] = tn_path_variable(ctx, v, pos + 1, hs2);
-
-                        conds[c++] = Z3_mk_or(ctx, a, tmp);
-
-                        /* nouvelle case ajoutée */
-                        if (pushedIs4)
-                        {
-                            conds[c++] = tn_4_variable(ctx, pos + 1, hs2);
-                            conds[c++] = Z3_mk_not(ctx, tn_6_variable(ctx, pos + 1, hs2));
-                        }
-                        else
-                        {
-                            conds[c++] = tn_6_variable(ctx, pos + 1, hs2);
-                            conds[c++] = Z3_mk_not(ctx, tn_4_variable(ctx, pos + 1, hs2));
-                        }
-
-                        /* pile inchangée en-dessous */
-                        for (int h = 0; h <= hs; h++)
-                        {
-                            Z3_ast eq4 = Z3_mk_iff(ctx,
-                                                   tn_4_variable(ctx, pos, h),
-                                                   tn_4_variable(ctx, pos + 1, h));
-                            Z3_ast eq6 = Z3_mk_iff(ctx,
-                                                   tn_6_variable(ctx, pos, h),
-                                                   tn_6_variable(ctx, pos + 1, h));
-
-                            Z3_ast both[2] = {eq4, eq6};
-                            conds[c++] = Z3_mk_and(ctx, 2, both);
-                        }
-
-                        /* cases au-dessus vides */
-                        for (int h = hs2 + 1; h < H; h++)
-                        {
-                            conds[c++] = Z3_mk_not(ctx, tn_4_variable(ctx, pos + 1, h));
-                            conds[c++] = Z3_mk_not(ctx, tn_6_variable(ctx, pos + 1, h));
-                        }
-
-                        actions[ac++] = Z3_mk_and(ctx, c, conds);
-                    }
-                }
-
-                /* ==========================================
-                 * POP
-                 * ========================================== */
-                for (stack_action act = pop_4_4; act <= pop_6_6; act++)
-                {
-                    if (!tn_node_has_action(network, u, act))
-                        continue;
-                    if (hs == 0)
-                        continue;
-
-                    int hs2 = hs - 1;
+    unsigned count = Z3_ast_vector_size(ctx, out.formula);
+    Z3_ast *constraints = (Z3_ast *)malloc(count * sizeof(Z3_ast));
+    for (unsigned i = 0; i < count; i++)
+        constraints[i] = Z3_ast_vector_get(ctx, out.formula, i);
+    Z3_ast formula = Z3_mk_and(ctx, count, constraints);
+    free(constraints);
+    tn_close_constraints(&out);
+    return formula;
+}
 
-                    bool removedWas4 = (act == pop_4_4 || act == pop_6_4);
-                    bool newTopIs4 = (act == pop_4_4 || act == pop_4_6);
+/**
+ * @brief Lit dans @p model le symbole à la profondeur @p depth sous le sommet de la pile de la position @p pos, dont la hauteur est @p height.
+ *
+ */
+static stack_symbol tn_model_symbol(Z3_context ctx, Z3_model model, tn_stack_encoding encoding, int length, int pos, int height, int depth)
+{
+    if (encoding == tn_boolean_stack)
+        return value_of_var_in_model(ctx, model, tn_4_variable(ctx, pos, height - depth)) ? symbol_4 : symbol_6;
+
+    Z3_ast value;
+    unsigned bit = 0;
+    if (Z3_model_eval(ctx, model, Z3_mk_extract(ctx, depth, depth, tn_stack_variable(ctx, pos, length)), true, &value))
+        Z3_get_numeral_uint(ctx, value, &bit);
+    return bit == 0 ? symbol_4 : symbol_6;
+}
 
-                    Z3_ast conds[1000];
-                    int c = 0;
+/**
+ * @brief Lit dans @p model le nœud de la position @p pos de l'encodage imbriqué (-1 si aucun).
+ *
+ */
+static int tn_model_node(Z3_context ctx, Z3_model model, int num_nodes, int pos)
+{
+    for (int node = 0; node < num_nodes; node++)
+        if (value_of_var_in_model(ctx, model, tn_node_variable(ctx, node, pos)))
+            return node;
+    return -1;
+}
 
-                    /* sommet avant pop */
-                    conds[c++] = removedWas4 ? tn_4_variable(ctx, pos, hs) : tn_6_variable(ctx, pos, hs);
+/**
+ * @brief Lit dans @p model l'action du pas depuis la position @p pos de l'encodage imbriqué.
+ *
+ */
+static stack_action tn_model_action(Z3_context ctx, Z3_model model, int pos)
+{
+    for (stack_action act = 0; act < NumActions; act++)
+        if (value_of_var_in_model(ctx, model, tn_action_variable(ctx, pos, act)))
+            return act;
+    return 0;
+}
 
-                    /* edge(u,v) */
-                    int a = 0;
-                    for (int v = 0; v < N; v++)
-                        if (tn_is_edge(network, u, v))
-                            tmp[a++] = tn_path_variable(ctx, v, pos + 1, hs2);
-
-                    conds[c++] = Z3_mk_or(ctx, a, tmp);
-
-                    /* nouveau sommet après pop */
-                    if (newTopIs4)
-                    {
-                        conds[c++] = tn_4_variable(ctx, pos + 1, hs2);
-                        conds[c++] = Z3_mk_not(ctx, tn_6_variable(ctx, pos + 1, hs2));
-                    }
-                    else
-                    {
-                        conds[c++] = tn_6_variable(ctx, pos + 1, hs2);
-                        conds[c++] = Z3_mk_not(ctx, tn_4_variable(ctx, pos + 1, hs2));
-                    }
-
-                    /* pile en-dessous identique */
-                    for (int h = 0; h < hs2; h++)
-                    {
-                        Z3_ast eq4 = Z3_mk_iff(ctx,
-                                               tn_4_variable(ctx, pos, h),
-                                               tn_4_variable(ctx, pos + 1, h));
-                        Z3_ast eq6 = Z3_mk_iff(ctx,
-                                               tn_6_variable(ctx, pos, h),
-                                               tn_6_variable(ctx, pos + 1, h));
-
-                        Z3_ast both[2] = {eq4, eq6};
-                        conds[c++] = Z3_mk_and(ctx, 2, both);
-                    }
-
-                    /* cases au-dessus doivent être vides */
-                    for (int h = hs2 + 1; h < H; h++)
-                    {
-                        conds[c++] = Z3_mk_not(ctx, tn_4_variable(ctx, pos + 1, h));
-                        conds[c++] = Z3_mk_not(ctx, tn_6_variable(ctx, pos + 1, h));
-                    }
-
-                    actions[ac++] = Z3_mk_and(ctx, c, conds);
-                }
+/**
+ * @brief Lit dans @p model la valeur de l'entier @p term (-1 si le modèle ne la donne pas).
+ *
+ */
+static int tn_model_int(Z3_context ctx, Z3_model model, Z3_ast term)
+{
+    Z3_ast value;
+    int result = -1;
+    if (!Z3_model_eval(ctx, model, term, true, &value) || !Z3_get_numeral_int(ctx, value, &result))
+        return -1;
+    return result;
+}
 
-                /* ==========================================
-                 * si x(u,pos,hs) alors OR(actions)
-                 * ========================================== */
-                if (ac > 0)
-                {
-                    Z3_ast or_actions = Z3_mk_or(ctx, ac, actions);
-                    C[k++] = Z3_mk_implies(ctx, xu, or_actions);
-                }
-            }
-        }
+/**
+ * @brief Lit dans @p model l'état (nœud, hauteur) de la position @p pos, depuis les variables x(u,pos,h) ou, dans l'encodage à domaines finis, depuis p(pos) et h(pos).
+ *
+ * @return int Le nombre d'états vrais à cette position (1 dans un modèle de la formule) ; le dernier est rendu dans @p node et @p height.
+ */
+static int tn_model_state(Z3_context ctx, Z3_model model, TunnelNetwork network, tn_stack_encoding encoding, int length, int pos, int *node, int *height)
+{
+    if (encoding == tn_finite_domain)
+    {
+        *node = tn_model_int(ctx, model, tn_position_term(ctx, pos));
+        *height = tn_model_int(ctx, model, tn_level_term(ctx, pos));
+        return *node >= 0 && *node < tn_get_num_nodes(network) ? 1 : 0;
     }
 
-    /* ===========================================================
-     * Return : conjonction de toutes les contraintes
-     * =========================================================== */
-
-    return Z3_mk_and(ctx, k, C);
+    int num_seen = 0;
+    for (int n = 0; n < tn_get_num_nodes(network); n++)
+        for (int h = 0; h < get_stack_size(length); h++)
+            if (value_of_var_in_model(ctx, model, tn_path_variable(ctx, n, pos, h)))
+            {
+                *node = n;
+                *height = h;
+                num_seen++;
+            }
+    return num_seen;
 }
+
 /**
  * @brief Reconstruit le chemin depuis un modèle satisfaisable.
  *
- * Cette fonction lit les variables x(u,pos,h) et y(pos,h,val) du modèle Z3
+ * Cette fonction lit les variables x(u,pos,h) (ou p(pos) et h(pos)) et la pile (y(pos,h,val) ou S_pos selon @p encoding) du modèle Z3
  * pour déterminer :
  *   - à chaque position pos, le nœud courant,
  *   - la hauteur de pile courante,
- *   - l'action appliquée pour aller à la position suivante.
+ *   - l'action appliquée pour aller à la position suivante (l'action du nœud dont la transition, dans tn_transition_table, produit la pile suivante).
+ *
+ * Dans l'encodage imbriqué, le nœud et l'action sont lus directement dans n(u,pos) et a(pos,act).
  *
  * Le chemin ainsi reconstruit est stocké dans le tableau 'path'.
  *
@@ -508,76 +1433,73 @@ Z3_ast tn_reduction(Z3_context ctx, const TunnelNetwork network, int length)
  * @param model Modèle retourné par Z3.
  * @param network Réseau Tunnel.
  * @param bound Longueur du chemin.
+ * @param encoding Encodage de la pile dans la formule résolue.
  * @param path Tableau dans lequel enregistrer le chemin.
  */
 
-void tn_get_path_from_model(Z3_context ctx, Z3_model model, TunnelNetwork network, int bound, tn_step *path)
+void tn_get_path_from_model(Z3_context ctx, Z3_model model, TunnelNetwork network, int bound, tn_stack_encoding encoding, tn_step *path)
 {
     int num_nodes = tn_get_num_nodes(network);
-    int stack_size = get_stack_size(bound);
+    if (encoding == tn_nested_stack)
+    {
+        for (int pos = 0; pos < bound; pos++)
+            path[pos] = tn_step_create(tn_model_action(ctx, model, pos), tn_model_node(ctx, model, num_nodes, pos), tn_model_node(ctx, model, num_nodes, pos + 1));
+        return;
+    }
     for (int pos = 0; pos < bound; pos++)
     {
         int src = -1;
         int src_height = -1;
         int tgt = -1;
         int tgt_height = -1;
-        for (int n = 0; n < num_nodes; n++)
-        {
-            for (int height = 0; height < stack_size; height++)
-            {
-                if (value_of_var_in_model(ctx, model, tn_path_variable(ctx, n, pos, height)))
-                {
-                    src = n;
-                    src_height = height;
-                }
-                if (value_of_var_in_model(ctx, model, tn_path_variable(ctx, n, pos + 1, height)))
-                {
-                    tgt = n;
-                    tgt_height = height;
-                }
-            }
-        }
+        tn_model_state(ctx, model, network, encoding, bound, pos, &src, &src_height);
+        tn_model_state(ctx, model, network, encoding, bound, pos + 1, &tgt, &tgt_height);
+        /* l'action est celle de src dont la transition mène de la pile lue à pos vers celle lue à pos+1 */
+        stack_symbol top = tn_model_symbol(ctx, model, encoding, bound, pos, src_height, 0);
+        stack_symbol below = symbol_none;
+        if (src_height > 0)
+            below = tn_model_symbol(ctx, model, encoding, bound, pos, src_height, 1);
+        stack_symbol new_top = tn_model_symbol(ctx, model, encoding, bound, pos + 1, tgt_height, 0);
         int action = 0;
-        if (src_height == tgt_height)
-        {
-            if (value_of_var_in_model(ctx, model, tn_4_variable(ctx, pos, src_height)))
-                action = transmit_4;
-            else
-                action = transmit_6;
-        }
-        else if (src_height == tgt_height - 1)
-        {
-            if (value_of_var_in_model(ctx, model, tn_4_variable(ctx, pos, src_height)))
-            {
-                if (value_of_var_in_model(ctx, model, tn_4_variable(ctx, pos + 1, tgt_height)))
-                    action = push_4_4;
-                else
-                    action = push_4_6;
-            }
-            else if (value_of_var_in_model(ctx, model, tn_4_variable(ctx, pos + 1, tgt_height)))
-                action = push_6_4;
-            else
-                action = push_6_6;
-        }
-        else if (src_height == tgt_height + 1)
+        int enabled = tn_get_enabled_actions(network, src, top);
+        for (stack_action act = 0; act < NumActions; act++)
         {
+            const tn_transition *transition = &tn_transition_table[act][top][below];
+            if ((enabled & (1 << act)) && transition->valid && transition->height_delta == tgt_height - src_height && transition->new_top == new_top)
             {
-                if (value_of_var_in_model(ctx, model, tn_4_variable(ctx, pos, src_height)))
-                {
-                    if (value_of_var_in_model(ctx, model, tn_4_variable(ctx, pos + 1, tgt_height)))
-                        action = pop_4_4;
-                    else
-                        action = pop_6_4;
-                }
-                else if (value_of_var_in_model(ctx, model, tn_4_variable(ctx, pos + 1, tgt_height)))
-                    action = pop_4_6;
-                else
-                    action = pop_6_6;
+                action = act;
+                break;
             }
         }
         path[pos] = tn_step_create(action, src, tgt);
     }
 }
+/**
+ * @brief Affiche un modèle de l'encodage imbriqué : à chaque position, le nœud, le sommet de pile, l'action et le pop apparié à un push.
+ *
+ */
+static void tn_print_nested_model(Z3_context ctx, Z3_model model, TunnelNetwork network, int bound)
+{
+    int num_nodes = tn_get_num_nodes(network);
+    for (int pos = 0; pos < bound + 1; pos++)
+    {
+        printf("At pos %d:\nState: ", pos);
+        int node = tn_model_node(ctx, model, num_nodes, pos);
+        if (node == -1)
+            printf("No node at that position !\n");
+        else
+            printf("%s\n", tn_get_node_name(network, node));
+        printf("Top: %c\n", value_of_var_in_model(ctx, model, tn_top_variable(ctx, pos)) ? '6' : '4');
+        if (pos == bound)
+            continue;
+        printf("Action: %s", tn_string_of_stack_action(tn_model_action(ctx, model, pos)));
+        for (int pop = pos + 1; pop < bound; pop++)
+            if (value_of_var_in_model(ctx, model, tn_match_variable(ctx, pos, pop)))
+                printf(" (popped at pos %d)", pop);
+        printf("\n");
+    }
+}
+
 /**
  * @brief Affiche le modèle SAT sous une forme lisible.
  *
@@ -592,33 +1514,42 @@ void tn_get_path_from_model(Z3_context ctx, Z3_model model, TunnelNetwork networ
  * @param model Modèle retourné par Z3.
  * @param network Réseau Tunnel.
  * @param bound Longueur du chemin.
+ * @param encoding Encodage de la pile dans la formule résolue.
  */
-void tn_print_model(Z3_context ctx, Z3_model model, TunnelNetwork network, int bound)
+void tn_print_model(Z3_context ctx, Z3_model model, TunnelNetwork network, int bound, tn_stack_encoding encoding)
 {
-    int num_nodes = tn_get_num_nodes(network);
+    if (encoding == tn_nested_stack)
+    {
+        tn_print_nested_model(ctx, model, network, bound);
+        return;
+    }
     int stack_size = get_stack_size(bound);
     for (int pos = 0; pos < bound + 1; pos++)
     {
         printf("At pos %d:\nState: ", pos);
-        int num_seen = 0;
-        for (int node = 0; node < num_nodes; node++)
-        {
-            for (int height = 0; height < stack_size; height++)
-            {
-                if (value_of_var_in_model(ctx, model, tn_path_variable(ctx, node, pos, height)))
-                {
-                    printf("(%s,%d) ", tn_get_node_name(network, node), height);
-                    num_seen++;
-                }
-            }
-        }
+        int state_node = -1;
+        int state_height = 0;
+        int num_seen = tn_model_state(ctx, model, network, encoding, bound, pos, &state_node, &state_height);
         if (num_seen == 0)
             printf("No node at that position !\n");
         else
-            printf("\n");
+            printf("(%s,%d)\n", tn_get_node_name(network, state_node), state_height);
         if (num_seen > 1)
             printf("Several pair node,height!\n");
         printf("Stack: ");
+        if (encoding != tn_boolean_stack)
+        {
+            /* la pile bit-vector est lue depuis le sommet : elle est toujours bien formée */
+            for (int height = 0; height < stack_size; height++)
+            {
+                if (height > state_height)
+                    printf("| ");
+                else
+                    printf("|%c", tn_model_symbol(ctx, model, encoding, bound, pos, state_height, state_height - height) == symbol_4 ? '4' : '6');
+            }
+            printf("\n");
+            continue;
+        }
         bool misdefined = false;
         bool above_top = false;
         for (int height = 0; height < stack_size; height++)
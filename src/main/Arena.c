@@ -0,0 +1,112 @@
+#include "Arena.h"
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Minimal size of a chunk.
+ *
+ */
+#define ArenaChunkSize 65536
+
+/**
+ * @brief A chunk of memory. Chunks are chained from the most recent one.
+ *
+ */
+typedef struct arena_chunk
+{
+    struct arena_chunk *next; ///< The previous chunk.
+    size_t size;              ///< Number of bytes available in data.
+    size_t used;              ///< Number of bytes used in data.
+    alignas(max_align_t) unsigned char data[]; ///< The memory.
+} arena_chunk;
+
+struct Arena_s
+{
+    arena_chunk *chunks; ///< The chunk being filled, followed by the full ones.
+    atomic_int references; ///< Number of owners of the arena.
+};
+
+Arena arena_create(void)
+{
+    Arena arena = (Arena)malloc(sizeof(struct Arena_s));
+    arena->chunks = NULL;
+    atomic_init(&arena->references, 1);
+    return arena;
+}
+
+/**
+ * @brief Allocates @p size bytes aligned on @p alignment (a power of 2, at most that of max_align_t) in @p arena.
+ *
+ */
+static void *arena_take(Arena arena, size_t size, size_t alignment)
+{
+    arena_chunk *chunk = arena->chunks;
+    size_t offset = chunk == NULL ? 0 : (chunk->used + alignment - 1) & ~(alignment - 1);
+    if (chunk == NULL || offset > chunk->size || chunk->size - offset < size)
+    {
+        size_t chunk_size = size > ArenaChunkSize ? size : ArenaChunkSize;
+        arena_chunk *fresh = (arena_chunk *)malloc(sizeof(arena_chunk) + chunk_size);
+        fresh->size = chunk_size;
+        fresh->used = 0;
+        // a chunk taken by a large allocation is put behind the current one, which can still be filled.
+        if (chunk != NULL && chunk_size > ArenaChunkSize)
+        {
+            fresh->next = chunk->next;
+            chunk->next = fresh;
+        }
+        else
+        {
+            fresh->next = chunk;
+            arena->chunks = fresh;
+        }
+        chunk = fresh;
+        offset = 0;
+    }
+    chunk->used = offset + size;
+    return chunk->data + offset;
+}
+
+void *arena_alloc(Arena arena, size_t size)
+{
+    return arena_take(arena, size, alignof(max_align_t));
+}
+
+char *arena_strndup(Arena arena, const char *string, size_t length)
+{
+    char *copy = (char *)arena_take(arena, length + 1, 1);
+    memcpy(copy, string, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+void *arena_calloc(Arena arena, size_t size)
+{
+    return memset(arena_alloc(arena, size), 0, size);
+}
+
+void *arena_memdup(Arena arena, const void *data, size_t size)
+{
+    return size == 0 ? arena_alloc(arena, 0) : memcpy(arena_alloc(arena, size), data, size);
+}
+
+Arena arena_share(Arena arena)
+{
+    atomic_fetch_add(&arena->references, 1);
+    return arena;
+}
+
+void arena_delete(Arena arena)
+{
+    if (arena == NULL || atomic_fetch_sub(&arena->references, 1) > 1)
+        return;
+    arena_chunk *chunk = arena->chunks;
+    while (chunk != NULL)
+    {
+        arena_chunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    free(arena);
+}
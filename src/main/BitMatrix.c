@@ -0,0 +1,271 @@
+#include "BitMatrix.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BITSET_HAS_AVX2
+#endif
+
+/**
+ * @brief Rows are padded to a multiple of this number of words (32 bytes, an AVX2 register), and aligned on it.
+ *
+ */
+#define RowAlignWords 4
+
+struct BitMatrix_s
+{
+    int num_rows;    ///< Number of rows.
+    int num_columns; ///< Number of columns.
+    int row_words;   ///< Number of meaningful words of a row.
+    int row_stride;  ///< Number of words between two rows (row_words rounded up to RowAlignWords).
+    uint64_t *bits;  ///< The rows, one after the other.
+};
+
+/**
+ * @brief The kernels in use.
+ *
+ */
+typedef struct
+{
+    bool (*and)(uint64_t *, const uint64_t *, const uint64_t *, int);
+    bool (*and_not)(uint64_t *, const uint64_t *, const uint64_t *, int);
+    bool (*intersects)(const uint64_t *, const uint64_t *, int);
+    void (*or_into)(uint64_t *, const uint64_t *, int);
+    long (*count)(const uint64_t *, int);
+} bitset_kernels;
+
+/* ---------- portable kernels ---------- */
+
+static bool scalar_and(uint64_t *result, const uint64_t *first, const uint64_t *second, int num_words)
+{
+    uint64_t any = 0;
+    for (int i = 0; i < num_words; i++)
+    {
+        result[i] = first[i] & second[i];
+        any |= result[i];
+    }
+    return any != 0;
+}
+
+static bool scalar_and_not(uint64_t *result, const uint64_t *set, const uint64_t *removed, int num_words)
+{
+    uint64_t any = 0;
+    for (int i = 0; i < num_words; i++)
+    {
+        result[i] = set[i] & ~removed[i];
+        any |= result[i];
+    }
+    return any != 0;
+}
+
+static bool scalar_intersects(const uint64_t *first, const uint64_t *second, int num_words)
+{
+    for (int i = 0; i < num_words; i++)
+        if (first[i] & second[i])
+            return true;
+    return false;
+}
+
+static void scalar_or_into(uint64_t *result, const uint64_t *set, int num_words)
+{
+    for (int i = 0; i < num_words; i++)
+        result[i] |= set[i];
+}
+
+static long scalar_count(const uint64_t *set, int num_words)
+{
+    long count = 0;
+    for (int i = 0; i < num_words; i++)
+        count += __builtin_popcountll(set[i]);
+    return count;
+}
+
+static const bitset_kernels scalar_kernels = {scalar_and, scalar_and_not, scalar_intersects, scalar_or_into, scalar_count};
+
+/* ---------- AVX2 kernels (4 words at a time, the remaining words with the portable code) ---------- */
+
+#ifdef BITSET_HAS_AVX2
+
+__attribute__((target("avx2"))) static bool avx2_and(uint64_t *result, const uint64_t *first, const uint64_t *second, int num_words)
+{
+    __m256i any = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 4 <= num_words; i += 4)
+    {
+        __m256i value = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(first + i)), _mm256_loadu_si256((const __m256i *)(second + i)));
+        _mm256_storeu_si256((__m256i *)(result + i), value);
+        any = _mm256_or_si256(any, value);
+    }
+    bool tail = scalar_and(result + i, first + i, second + i, num_words - i);
+    return tail || !_mm256_testz_si256(any, any);
+}
+
+__attribute__((target("avx2"))) static bool avx2_and_not(uint64_t *result, const uint64_t *set, const uint64_t *removed, int num_words)
+{
+    __m256i any = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 4 <= num_words; i += 4)
+    {
+        __m256i value = _mm256_andnot_si256(_mm256_loadu_si256((const __m256i *)(removed + i)), _mm256_loadu_si256((const __m256i *)(set + i)));
+        _mm256_storeu_si256((__m256i *)(result + i), value);
+        any = _mm256_or_si256(any, value);
+    }
+    bool tail = scalar_and_not(result + i, set + i, removed + i, num_words - i);
+    return tail || !_mm256_testz_si256(any, any);
+}
+
+__attribute__((target("avx2"))) static bool avx2_intersects(const uint64_t *first, const uint64_t *second, int num_words)
+{
+    int i = 0;
+    for (; i + 4 <= num_words; i += 4)
+        if (!_mm256_testz_si256(_mm256_loadu_si256((const __m256i *)(first + i)), _mm256_loadu_si256((const __m256i *)(second + i))))
+            return true;
+    return scalar_intersects(first + i, second + i, num_words - i);
+}
+
+__attribute__((target("avx2"))) static void avx2_or_into(uint64_t *result, const uint64_t *set, int num_words)
+{
+    int i = 0;
+    for (; i + 4 <= num_words; i += 4)
+    {
+        __m256i value = _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(result + i)), _mm256_loadu_si256((const __m256i *)(set + i)));
+        _mm256_storeu_si256((__m256i *)(result + i), value);
+    }
+    scalar_or_into(result + i, set + i, num_words - i);
+}
+
+/**
+ * @brief Counts bits with nibble lookups (AVX2 has no population count instruction): each byte is split in two nibbles whose counts are looked up with a shuffle, and bytes are summed per word with _mm256_sad_epu8.
+ *
+ */
+__attribute__((target("avx2"))) static long avx2_count(const uint64_t *set, int num_words)
+{
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    __m256i total = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 4 <= num_words; i += 4)
+    {
+        __m256i value = _mm256_loadu_si256((const __m256i *)(set + i));
+        __m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(value, low_mask));
+        __m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(value, 4), low_mask));
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256()));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, total);
+    return (long)(lanes[0] + lanes[1] + lanes[2] + lanes[3]) + scalar_count(set + i, num_words - i);
+}
+
+static const bitset_kernels avx2_kernels = {avx2_and, avx2_and_not, avx2_intersects, avx2_or_into, avx2_count};
+
+#endif
+
+static const bitset_kernels *kernels = &scalar_kernels;
+
+/**
+ * @brief Selects the AVX2 kernels if the processor supports them, before main is run.
+ *
+ */
+__attribute__((constructor)) static void bitset_select_kernels(void)
+{
+    bitset_use_simd(true);
+}
+
+bool bitset_use_simd(bool enabled)
+{
+    kernels = &scalar_kernels;
+#ifdef BITSET_HAS_AVX2
+    __builtin_cpu_init();
+    if (enabled && __builtin_cpu_supports("avx2"))
+        kernels = &avx2_kernels;
+    return kernels == &avx2_kernels;
+#else
+    (void)enabled;
+    return false;
+#endif
+}
+
+bool bitset_and(uint64_t *result, const uint64_t *first, const uint64_t *second, int num_words)
+{
+    return kernels->and(result, first, second, num_words);
+}
+
+bool bitset_and_not(uint64_t *result, const uint64_t *set, const uint64_t *removed, int num_words)
+{
+    return kernels->and_not(result, set, removed, num_words);
+}
+
+bool bitset_intersects(const uint64_t *first, const uint64_t *second, int num_words)
+{
+    return kernels->intersects(first, second, num_words);
+}
+
+void bitset_or(uint64_t *result, const uint64_t *set, int num_words)
+{
+    kernels->or_into(result, set, num_words);
+}
+
+long bitset_count(const uint64_t *set, int num_words)
+{
+    return kernels->count(set, num_words);
+}
+
+/* ---------- matrices ---------- */
+
+BitMatrix bit_matrix_create(int num_rows, int num_columns)
+{
+    BitMatrix matrix = (BitMatrix)malloc(sizeof(struct BitMatrix_s));
+    matrix->num_rows = num_rows;
+    matrix->num_columns = num_columns;
+    matrix->row_words = BitsetWords(num_columns);
+    matrix->row_stride = (matrix->row_words + RowAlignWords - 1) / RowAlignWords * RowAlignWords;
+    size_t size = (size_t)num_rows * matrix->row_stride * sizeof(uint64_t);
+    matrix->bits = (uint64_t *)aligned_alloc(RowAlignWords * sizeof(uint64_t), size == 0 ? RowAlignWords * sizeof(uint64_t) : size);
+    memset(matrix->bits, 0, size);
+    return matrix;
+}
+
+void bit_matrix_delete(BitMatrix matrix)
+{
+    if (matrix == NULL)
+        return;
+    free(matrix->bits);
+    free(matrix);
+}
+
+int bit_matrix_row_words(BitMatrix matrix)
+{
+    return matrix->row_words;
+}
+
+void bit_matrix_set(BitMatrix matrix, int row, int column)
+{
+    BitsetSet(matrix->bits + (size_t)row * matrix->row_stride, column);
+}
+
+bool bit_matrix_get(BitMatrix matrix, int row, int column)
+{
+    return BitsetTest(matrix->bits + (size_t)row * matrix->row_stride, column);
+}
+
+const uint64_t *bit_matrix_row(BitMatrix matrix, int row)
+{
+    return matrix->bits + (size_t)row * matrix->row_stride;
+}
+
+void bit_matrix_or_rows(BitMatrix matrix, const uint64_t *rows, uint64_t *result)
+{
+    int num_words = BitsetWords(matrix->num_rows);
+    for (int word = 0; word < num_words; word++)
+    {
+        uint64_t bits = rows[word];
+        while (bits != 0)
+        {
+            int row = word * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            kernels->or_into(result, matrix->bits + (size_t)row * matrix->row_stride, matrix->row_words);
+        }
+    }
+}
@@ -16,72 +16,6 @@
 #include <string.h>
 #include <stdlib.h>
 
-parameterList *parameter_list_add_parameter(parameterList *list, char *name, char *value)
-{
-	if (list == NULL)
-	{
-		list = (parameterList *)malloc(sizeof(parameterList));
-		list->name = (char *)malloc((strlen(name) + 1) * sizeof(char));
-		strcpy(list->name, name);
-		list->value = (char *)malloc((strlen(value) + 1) * sizeof(char));
-		strcpy(list->value, value);
-		list->next = NULL;
-		return list;
-	}
-	else if (strcmp(name, list->name) != 0)
-		list->next = parameter_list_add_parameter(list->next, name, value);
-	return list;
-}
-
-parameterList *parameter_lists_merge(parameterList *head, parameterList *tail)
-{
-	if (head == NULL)
-		return tail;
-	if (head->next != NULL)
-	{
-		parameter_lists_merge(head->next, tail);
-		return head;
-	}
-	head->next = tail;
-	return head;
-}
-
-parameterList *parameter_list_copy(parameterList *source)
-{
-	if (source == NULL)
-		return NULL;
-	parameterList *result = (parameterList *)malloc(sizeof(parameterList));
-	result->name = (char *)malloc((strlen(source->name) + 1) * sizeof(char));
-	strcpy(result->name, source->name);
-	result->value = (char *)malloc((strlen(source->value) + 1) * sizeof(char));
-	strcpy(result->value, source->value);
-	result->next = parameter_list_copy(source->next);
-	return result;
-}
-
-char *parameter_list_get_value(parameterList *list, char *name)
-{
-	while (list != NULL && strcmp(list->name, name) != 0)
-		list = list->next;
-	if (list == NULL)
-	{
-		return NULL;
-		/* printf("Parameter list does not contain required field %s\n", name);
-		exit(-1); */
-	}
-	return list->value;
-}
-
-void parameter_list_delete(parameterList *list)
-{
-	if (list == NULL)
-		return;
-	parameter_list_delete(list->next);
-	free(list->name);
-	free(list->value);
-	free(list);
-}
-
 void graph_print(Graph graph)
 {
 	printf("\nName: %s\n", graph.name);
@@ -94,7 +28,7 @@ void graph_print(Graph graph)
 	{
 		for (int j = 0; j < graph.numNodes; j++)
 		{
-			printf("%d ", graph.edges[i * graph.numNodes + j]);
+			printf("%d ", graph_is_edge(graph, i, j));
 		}
 		printf("\n");
 	}
@@ -105,65 +39,33 @@ void graph_print(Graph graph)
 	for (int i = 0; i < graph.numNodes; i++)
 	{
 		printf("node %s:", graph.nodes[i]);
-		parameterList *list = graph.parameters[i];
-		while (list != NULL)
-		{
-			printf("(%s : %s), ", list->name, list->value);
-			list = list->next;
-		}
+		for (int attr = graph.attributeOffsets[i]; attr < graph.attributeOffsets[i + 1]; attr++)
+			printf("(%s : %s), ", graph.attributes[attr].key, graph.attributes[attr].value);
 		printf("\n");
 	}
 }
 
 Graph graph_copy(Graph graph)
 {
-	Graph copy;
-	copy.name = graph.name;
-	copy.numNodes = graph.numNodes;
-	copy.numEdges = graph.numEdges;
-	copy.nodes = (char **)malloc(copy.numNodes * sizeof(char *));
-	copy.edges = (bool *)malloc(copy.numNodes * copy.numNodes * sizeof(bool));
-
-	for (int i = 0; i < copy.numNodes * copy.numNodes; i++)
-		copy.edges[i] = graph.edges[i];
-
-	copy.parameters = (parameterList **)malloc(graph.numNodes * sizeof(parameterList *));
-	for (int i = 0; i < graph.numNodes; i++)
-		copy.parameters[i] = parameter_list_copy(graph.parameters[i]);
-
-	copy.edge_parameters = (parameterList **)malloc(graph.numNodes * graph.numNodes * sizeof(parameterList *));
-	for (int i = 0; i < graph.numNodes * graph.numNodes; i++)
-		copy.edge_parameters[i] = parameter_list_copy(graph.edge_parameters[i]);
-
+	Graph copy = graph;
+	if (copy.arena != NULL)
+		arena_share(copy.arena);
 	return copy;
 }
 
 void graph_delete(Graph graph)
 {
-	if (graph.edges != NULL)
-		free(graph.edges);
-	if (graph.nodes != NULL)
-	{
-		for (int i = 0; i < graph.numNodes; i++)
-		{
-			if (graph.nodes[i] != NULL)
-				free(graph.nodes[i]);
-		}
-		free(graph.nodes);
-	}
-	// Pour les automates.
-
-	for (int i = 0; i < graph.numNodes; i++)
-		parameter_list_delete(graph.parameters[i]);
-	free(graph.parameters);
+	arena_delete(graph.arena);
+}
 
-	for (int i = 0; i < graph.numNodes * graph.numNodes; i++)
-		parameter_list_delete(graph.edge_parameters[i]);
-	free(graph.edge_parameters);
+int graph_num_nodes(Graph graph)
+{
+	return graph.numNodes;
+}
 
-	graph.numEdges = 0;
-	graph.numNodes = 0;
-	free(graph.name);
+int graph_num_edges(Graph graph)
+{
+	return graph.numEdges;
 }
 
 char *graph_get_name(Graph graph)
@@ -171,29 +73,66 @@ char *graph_get_name(Graph graph)
 	return graph.name;
 }
 
-int graph_num_nodes(Graph graph)
+int graph_get_edge_index(Graph graph, int source, int target)
 {
-	return graph.numNodes;
+	int low = graph.edgeOffsets[source];
+	int high = graph.edgeOffsets[source + 1];
+	while (low < high)
+	{
+		int middle = (low + high) / 2;
+		if (graph.successors[middle] < target)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	if (low < graph.edgeOffsets[source + 1] && graph.successors[low] == target)
+		return low;
+	return -1;
 }
 
-int graph_num_edges(Graph graph)
+bool graph_is_edge(Graph graph, int source, int target)
 {
-	return graph.numEdges;
+	return graph_get_edge_index(graph, source, target) >= 0;
 }
 
-bool graph_is_edge(Graph graph, int source, int target)
+const int *graph_get_successors(Graph graph, int node, int *num_successors)
+{
+	*num_successors = graph.edgeOffsets[node + 1] - graph.edgeOffsets[node];
+	return graph.successors + graph.edgeOffsets[node];
+}
+
+const graphAttribute *graph_get_edge_attributes(Graph graph, int source, int target, int *num_attributes)
 {
-	return graph.edges[(source * graph.numNodes) + target];
+	int edge = graph_get_edge_index(graph, source, target);
+	if (edge < 0)
+	{
+		*num_attributes = 0;
+		return NULL;
+	}
+	*num_attributes = graph.edgeAttributeOffsets[edge + 1] - graph.edgeAttributeOffsets[edge];
+	return graph.edgeAttributes + graph.edgeAttributeOffsets[edge];
 }
 
-parameterList *graph_get_edge_parameter(Graph graph, int source, int target)
+const graphAttribute *graph_get_node_attributes(Graph graph, int node, int *num_attributes)
 {
-	return graph.edge_parameters[(source * graph.numNodes) + target];
+	*num_attributes = graph.attributeOffsets[node + 1] - graph.attributeOffsets[node];
+	return graph.attributes + graph.attributeOffsets[node];
 }
 
-parameterList *graph_get_node_parameter(Graph graph, int node)
+const char *graph_find_string(Graph graph, const char *string)
 {
-	return graph.parameters[node];
+	return string_pool_find(graph.strings, string, strlen(string));
+}
+
+const char *graph_get_node_attribute(Graph graph, int node, const char *key)
+{
+	key = graph_find_string(graph, key);
+	if (key == NULL)
+		return NULL;
+	for (int attr = graph.attributeOffsets[node]; attr < graph.attributeOffsets[node + 1]; attr++)
+		if (graph.attributes[attr].key == key)
+			return graph.attributes[attr].value;
+	return NULL;
 }
 
 char *graph_get_node_name(Graph graph, int node)
@@ -201,38 +140,38 @@ char *graph_get_node_name(Graph graph, int node)
 	return graph.nodes[node];
 }
 
+/**
+ * @brief Writes in @p file the attributes of @p node between brackets, if it has any.
+ *
+ */
+static void fill_dot_attributes(Graph graph, int node, FILE *file)
+{
+	int first = graph.attributeOffsets[node], last = graph.attributeOffsets[node + 1];
+	if (first == last)
+		return;
+	fprintf(file, "[");
+	for (int attr = first; attr < last; attr++)
+		fprintf(file, attr == first ? "%s=%s" : ",%s=%s", graph.attributes[attr].key, graph.attributes[attr].value);
+	fprintf(file, "]");
+}
+
 void graph_fill_dot_content(Graph graph, FILE *file)
 {
 	int num_nodes = graph.numNodes;
 	for (int node = 0; node < num_nodes; node++)
 	{
 		fprintf(file, "%s", graph_get_node_name(graph, node));
-		if (graph.parameters[node] != NULL)
-		{
-			fprintf(file, "[");
-			parameterList *param = graph.parameters[node];
-			while (true)
-			{
-				fprintf(file, "%s=%s", param->name, param->value);
-				param = param->next;
-				if (param == NULL)
-					break;
-				fprintf(file, ",");
-			}
-			fprintf(file, "]");
-		}
+		fill_dot_attributes(graph, node, file);
 		fprintf(file, ";\n");
 	}
 	for (int node = 0; node < num_nodes; node++)
 	{
-		for (int node2 = 0; node2 < node; node2++)
+		for (int edge = graph.edgeOffsets[node]; edge < graph.edgeOffsets[node + 1] && graph.successors[edge] < node; edge++)
 		{
-			if (graph_is_edge(graph, node, node2))
-			{
-				fprintf(file, "%s -- %s", graph_get_node_name(graph, node), graph_get_node_name(graph, node2));
-				fprintf(file, ";\n");
-				// todo : edge parameters
-			}
+			int node2 = graph.successors[edge];
+			fprintf(file, "%s -- %s", graph_get_node_name(graph, node), graph_get_node_name(graph, node2));
+			fprintf(file, ";\n");
+			// todo : edge parameters
 		}
 	}
 }
@@ -243,33 +182,18 @@ void digraph_fill_dot_content(Graph graph, FILE *file)
 	for (int node = 0; node < num_nodes; node++)
 	{
 		fprintf(file, "%s", graph_get_node_name(graph, node));
-		if (graph.parameters[node] != NULL)
-		{
-			fprintf(file, "[");
-			parameterList *param = graph.parameters[node];
-			while (true)
-			{
-				fprintf(file, "%s=%s", param->name, param->value);
-				param = param->next;
-				if (param == NULL)
-					break;
-				fprintf(file, ",");
-			}
-			fprintf(file, "]");
-		}
+		fill_dot_attributes(graph, node, file);
 		fprintf(file, ";\n");
 	}
 	for (int node = 0; node < num_nodes; node++)
 	{
-		for (int node2 = 0; node2 < num_nodes; node2++)
+		for (int edge = graph.edgeOffsets[node]; edge < graph.edgeOffsets[node + 1]; edge++)
 		{
-			if (graph_is_edge(graph, node, node2))
-			{
-				fprintf(file, "%s -> %s", graph_get_node_name(graph, node), graph_get_node_name(graph, node2));
-				fprintf(file, ";\n");
+			int node2 = graph.successors[edge];
+			fprintf(file, "%s -> %s", graph_get_node_name(graph, node), graph_get_node_name(graph, node2));
+			fprintf(file, ";\n");
 
-				// todo : edge parameters.
-			}
+			// todo : edge parameters.
 		}
 	}
 }
\ No newline at end of file
@@ -0,0 +1,227 @@
+#include "Metrics.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <pthread.h>
+
+/**
+ * @brief Accumulated measures of a phase.
+ *
+ */
+typedef struct
+{
+    double total; ///< Total time spent in the phase.
+    int count;    ///< Number of completed spans.
+} phase_record;
+
+/**
+ * @brief A record of named values.
+ *
+ */
+typedef struct
+{
+    char *kind;       ///< The kind of the record.
+    int num_values;   ///< Number of values.
+    int capacity;     ///< Allocated size of keys and values.
+    char **keys;      ///< The names of the values.
+    double *values;   ///< The values.
+} value_record;
+
+static phase_record phases[NumMetricsPhases];
+static double run_start = 0;
+
+/**
+ * @brief Start time of the running span of each phase, for each thread.
+ *
+ */
+static _Thread_local double phase_started[NumMetricsPhases];
+
+/**
+ * @brief Protects the totals of the phases and the records.
+ *
+ */
+static pthread_mutex_t metrics_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static value_record *records = NULL;
+static int num_records = 0;
+static int records_capacity = 0;
+
+static const char *phase_names[NumMetricsPhases] = {
+    "parse",
+    "create_graph",
+    "initialize",
+    "preprocessing",
+    "formula",
+    "solve",
+    "decode",
+    "output"};
+
+double metrics_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+void metrics_init(void)
+{
+    metrics_release();
+    pthread_mutex_lock(&metrics_mutex);
+    for (int phase = 0; phase < NumMetricsPhases; phase++)
+    {
+        phases[phase].total = 0;
+        phases[phase].count = 0;
+    }
+    run_start = metrics_now();
+    pthread_mutex_unlock(&metrics_mutex);
+}
+
+void metrics_phase_start(metrics_phase phase)
+{
+    phase_started[phase] = metrics_now();
+}
+
+double metrics_phase_stop(metrics_phase phase)
+{
+    double span = metrics_now() - phase_started[phase];
+    pthread_mutex_lock(&metrics_mutex);
+    phases[phase].total += span;
+    phases[phase].count++;
+    pthread_mutex_unlock(&metrics_mutex);
+    return span;
+}
+
+double metrics_phase_total(metrics_phase phase)
+{
+    pthread_mutex_lock(&metrics_mutex);
+    double total = phases[phase].total;
+    pthread_mutex_unlock(&metrics_mutex);
+    return total;
+}
+
+const char *metrics_phase_name(metrics_phase phase)
+{
+    return phase_names[phase];
+}
+
+long metrics_peak_rss_kb(void)
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+    return usage.ru_maxrss;
+}
+
+void metrics_record_start(const char *kind)
+{
+    pthread_mutex_lock(&metrics_mutex);
+    if (num_records == records_capacity)
+    {
+        records_capacity = records_capacity == 0 ? 16 : 2 * records_capacity;
+        records = (value_record *)realloc(records, records_capacity * sizeof(value_record));
+    }
+    value_record *record = &records[num_records++];
+    record->kind = strdup(kind);
+    record->num_values = 0;
+    record->capacity = 0;
+    record->keys = NULL;
+    record->values = NULL;
+    pthread_mutex_unlock(&metrics_mutex);
+}
+
+void metrics_record_value(const char *key, double value)
+{
+    pthread_mutex_lock(&metrics_mutex);
+    value_record *record = &records[num_records - 1];
+    if (record->num_values == record->capacity)
+    {
+        record->capacity = record->capacity == 0 ? 8 : 2 * record->capacity;
+        record->keys = (char **)realloc(record->keys, record->capacity * sizeof(char *));
+        record->values = (double *)realloc(record->values, record->capacity * sizeof(double));
+    }
+    record->keys[record->num_values] = strdup(key);
+    record->values[record->num_values] = value;
+    record->num_values++;
+    pthread_mutex_unlock(&metrics_mutex);
+}
+
+void metrics_release(void)
+{
+    pthread_mutex_lock(&metrics_mutex);
+    for (int i = 0; i < num_records; i++)
+    {
+        for (int value = 0; value < records[i].num_values; value++)
+            free(records[i].keys[value]);
+        free(records[i].keys);
+        free(records[i].values);
+        free(records[i].kind);
+    }
+    free(records);
+    records = NULL;
+    num_records = 0;
+    records_capacity = 0;
+    pthread_mutex_unlock(&metrics_mutex);
+}
+
+/**
+ * @brief Prints the statistics as human readable lines.
+ *
+ * @param file A file.
+ */
+static void print_text(FILE *file)
+{
+    fprintf(file, "\n*** Statistics ***\n");
+    for (int phase = 0; phase < NumMetricsPhases; phase++)
+        fprintf(file, "%-14s %12.6f s (%d)\n", phase_names[phase], phases[phase].total, phases[phase].count);
+    fprintf(file, "%-14s %12.6f s\n", "wall", metrics_now() - run_start);
+    fprintf(file, "%-14s %12ld kB\n", "peak_rss", metrics_peak_rss_kb());
+    for (int i = 0; i < num_records; i++)
+    {
+        fprintf(file, "%s:", records[i].kind);
+        for (int value = 0; value < records[i].num_values; value++)
+            fprintf(file, " %s=%.9g", records[i].keys[value], records[i].values[value]);
+        fprintf(file, "\n");
+    }
+}
+
+/**
+ * @brief Prints the statistics as a single JSON object.
+ *
+ * @param file A file.
+ */
+static void print_json(FILE *file)
+{
+    fprintf(file, "{\"wall_seconds\":%.9f,\"peak_rss_kb\":%ld,\"phases\":{", metrics_now() - run_start, metrics_peak_rss_kb());
+    for (int phase = 0; phase < NumMetricsPhases; phase++)
+    {
+        fprintf(file, "%s\"%s\":{\"seconds\":%.9f,\"count\":%d}", phase == 0 ? "" : ",", phase_names[phase], phases[phase].total, phases[phase].count);
+    }
+    fprintf(file, "},\"records\":[");
+    for (int i = 0; i < num_records; i++)
+    {
+        fprintf(file, "%s{\"kind\":\"%s\"", i == 0 ? "" : ",", records[i].kind);
+        for (int value = 0; value < records[i].num_values; value++)
+            fprintf(file, ",\"%s\":%.9g", records[i].keys[value], records[i].values[value]);
+        fprintf(file, "}");
+    }
+    fprintf(file, "]}\n");
+}
+
+void metrics_print(FILE *file, metrics_format format)
+{
+    pthread_mutex_lock(&metrics_mutex);
+    switch (format)
+    {
+    case metrics_format_none:
+        break;
+    case metrics_format_text:
+        print_text(file);
+        break;
+    case metrics_format_json:
+        print_json(file);
+        break;
+    }
+    pthread_mutex_unlock(&metrics_mutex);
+}
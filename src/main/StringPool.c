@@ -0,0 +1,132 @@
+#include "StringPool.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief A slot of the hash table. Empty slots have a NULL string.
+ *
+ */
+typedef struct
+{
+    const char *string; ///< The interned string.
+    size_t length;      ///< Its length.
+    unsigned hash;      ///< Its hash.
+} pool_slot;
+
+struct StringPool_s
+{
+    Arena arena;        ///< Holds the pool, its table and its strings.
+    bool owns_arena;    ///< True if the arena has been created with the pool.
+    pool_slot *slots;   ///< Open addressing hash table (linear probing).
+    size_t capacity;    ///< Size of slots (a power of 2).
+    int num_strings;    ///< Number of used slots.
+};
+
+/**
+ * @brief FNV-1a hash of @p length characters.
+ *
+ */
+static unsigned hash_string(const char *string, size_t length)
+{
+    unsigned hash = 2166136261u;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= (unsigned char)string[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Doubles the size of the hash table of @p pool.
+ *
+ */
+static void grow_table(StringPool pool)
+{
+    size_t capacity = 2 * pool->capacity;
+    pool_slot *slots = (pool_slot *)arena_calloc(pool->arena, capacity * sizeof(pool_slot));
+    for (size_t i = 0; i < pool->capacity; i++)
+    {
+        if (pool->slots[i].string == NULL)
+            continue;
+        size_t index = pool->slots[i].hash & (capacity - 1);
+        while (slots[index].string != NULL)
+            index = (index + 1) & (capacity - 1);
+        slots[index] = pool->slots[i];
+    }
+    // the old table stays in the arena: all the tables together are smaller than twice the last one.
+    pool->slots = slots;
+    pool->capacity = capacity;
+}
+
+StringPool string_pool_create_in(Arena arena)
+{
+    StringPool pool = (StringPool)arena_alloc(arena, sizeof(struct StringPool_s));
+    pool->arena = arena;
+    pool->owns_arena = false;
+    pool->capacity = 1024;
+    pool->slots = (pool_slot *)arena_calloc(arena, pool->capacity * sizeof(pool_slot));
+    pool->num_strings = 0;
+    return pool;
+}
+
+StringPool string_pool_create(void)
+{
+    StringPool pool = string_pool_create_in(arena_create());
+    pool->owns_arena = true;
+    return pool;
+}
+
+/**
+ * @brief Returns the slot of the @p length characters of @p string (of hash @p hash) in @p pool: either the slot where they are interned, or the empty slot where they should be.
+ *
+ */
+static pool_slot *find_slot(StringPool pool, const char *string, size_t length, unsigned hash)
+{
+    size_t index = hash & (pool->capacity - 1);
+    while (pool->slots[index].string != NULL)
+    {
+        pool_slot *slot = &pool->slots[index];
+        if (slot->hash == hash && slot->length == length && memcmp(slot->string, string, length) == 0)
+            return slot;
+        index = (index + 1) & (pool->capacity - 1);
+    }
+    return &pool->slots[index];
+}
+
+const char *string_pool_intern(StringPool pool, const char *string, size_t length)
+{
+    unsigned hash = hash_string(string, length);
+    pool_slot *slot = find_slot(pool, string, length, hash);
+    if (slot->string != NULL)
+        return slot->string;
+
+    slot->string = arena_strndup(pool->arena, string, length);
+    slot->length = length;
+    slot->hash = hash;
+    pool->num_strings++;
+
+    const char *result = slot->string;
+    if (2 * (size_t)pool->num_strings > pool->capacity)
+        grow_table(pool);
+    return result;
+}
+
+const char *string_pool_find(StringPool pool, const char *string, size_t length)
+{
+    if (pool == NULL)
+        return NULL;
+    return find_slot(pool, string, length, hash_string(string, length))->string;
+}
+
+int string_pool_num_strings(StringPool pool)
+{
+    return pool->num_strings;
+}
+
+void string_pool_delete(StringPool pool)
+{
+    if (pool != NULL && pool->owns_arena)
+        arena_delete(pool->arena);
+}
@@ -3,6 +3,8 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h>
+#include <limits.h>
 
 Z3_context make_context(void)
 {
@@ -12,6 +14,14 @@ Z3_context make_context(void)
     return ctx;
 }
 
+Z3_context make_rc_context(void)
+{
+    Z3_config config = Z3_mk_config();
+    Z3_context ctx = Z3_mk_context_rc(config);
+    Z3_del_config(config);
+    return ctx;
+}
+
 Z3_ast mk_var(Z3_context ctx, const char *name, Z3_sort ty)
 {
     Z3_symbol s = Z3_mk_string_symbol(ctx, name);
@@ -96,14 +106,59 @@ Z3_model get_model_from_sat_formula(Z3_context ctx, Z3_ast formula)
     return m;
 }
 
+void get_solver_statistics(Z3_context ctx, Z3_solver s, solver_statistics *stats)
+{
+    stats->conflicts = 0;
+    stats->decisions = 0;
+    stats->propagations = 0;
+    stats->memory = 0;
+
+    Z3_stats z3_stats = Z3_solver_get_statistics(ctx, s);
+    Z3_stats_inc_ref(ctx, z3_stats);
+    unsigned size = Z3_stats_size(ctx, z3_stats);
+    for (unsigned i = 0; i < size; i++)
+    {
+        const char *key = Z3_stats_get_key(ctx, z3_stats, i);
+        double value = Z3_stats_is_uint(ctx, z3_stats, i) ? Z3_stats_get_uint_value(ctx, z3_stats, i) : Z3_stats_get_double_value(ctx, z3_stats, i);
+        if (strcmp(key, "conflicts") == 0 || strcmp(key, "sat conflicts") == 0)
+            stats->conflicts += value;
+        else if (strcmp(key, "decisions") == 0 || strcmp(key, "sat decisions") == 0)
+            stats->decisions += value;
+        // Exact keys only: the others, such as "binary propagations" or those of the arithmetic, overlap with these.
+        else if (strcmp(key, "propagations") == 0 || strcmp(key, "sat propagations 2ary") == 0 || strcmp(key, "sat propagations 3ary") == 0 || strcmp(key, "sat propagations nary") == 0)
+            stats->propagations += value;
+        else if (strcmp(key, "max memory") == 0)
+            stats->memory = value;
+    }
+    Z3_stats_dec_ref(ctx, z3_stats);
+}
+
 Z3_lbool solve_formula(Z3_context ctx, Z3_ast formula, Z3_model *model)
+{
+    return solve_formula_with_statistics(ctx, formula, model, NULL);
+}
+
+Z3_lbool solve_formula_with_statistics(Z3_context ctx, Z3_ast formula, Z3_model *model, solver_statistics *stats)
 {
     Z3_solver s = Z3_mk_solver(ctx);
     Z3_solver_inc_ref(ctx, s);
-    Z3_solver_assert(ctx, s, formula);
+    Z3_lbool result = solve_formula_in_solver(ctx, s, formula, model, stats);
+    Z3_solver_dec_ref(ctx, s);
+    return result;
+}
 
-    Z3_lbool result = Z3_solver_check(ctx, s);
+Z3_lbool solve_formula_in_solver(Z3_context ctx, Z3_solver s, Z3_ast formula, Z3_model *model, solver_statistics *stats)
+{
+    Z3_solver_assert(ctx, s, formula);
+    return check_solver(ctx, s, model, stats);
+}
 
+/**
+ * @brief Reports the result of the last check of @p s, and gets its model and statistics (see check_solver).
+ *
+ */
+static Z3_lbool finish_check(Z3_context ctx, Z3_solver s, Z3_lbool result, Z3_model *model, solver_statistics *stats)
+{
     switch (result)
     {
     case Z3_L_FALSE:
@@ -118,10 +173,64 @@ Z3_lbool solve_formula(Z3_context ctx, Z3_ast formula, Z3_model *model)
             Z3_model_inc_ref(ctx, *model);
     }
 
-    Z3_solver_dec_ref(ctx, s);
+    if (stats != NULL)
+        get_solver_statistics(ctx, s, stats);
+
     return result;
 }
 
+Z3_lbool check_solver(Z3_context ctx, Z3_solver s, Z3_model *model, solver_statistics *stats)
+{
+    return finish_check(ctx, s, Z3_solver_check(ctx, s), model, stats);
+}
+
+/**
+ * @brief Sets the maximal number of conflicts of the checks of @p s.
+ *
+ */
+static void set_max_conflicts(Z3_context ctx, Z3_solver s, unsigned max_conflicts)
+{
+    Z3_params params = Z3_mk_params(ctx);
+    Z3_params_inc_ref(ctx, params);
+    Z3_params_set_uint(ctx, params, Z3_mk_string_symbol(ctx, "max_conflicts"), max_conflicts);
+    Z3_solver_set_params(ctx, s, params);
+    Z3_params_dec_ref(ctx, params);
+}
+
+Z3_solver make_hinted_solver(Z3_context ctx, bool finite_domain)
+{
+    // The solver of Z3_mk_solver runs the SMT core as soon as it is checked with assumptions (a SAT check of a propositional formula which takes seconds can then take minutes): the one for the logic QF_FD keeps the SAT core.
+    if (finite_domain)
+        return Z3_mk_solver_for_logic(ctx, Z3_mk_string_symbol(ctx, "QF_FD"));
+    return Z3_mk_solver(ctx);
+}
+
+Z3_lbool check_solver_with_hints(Z3_context ctx, Z3_solver s, int num_hints, Z3_ast *hints, unsigned max_conflicts, Z3_model *model, solver_statistics *stats)
+{
+    if (num_hints == 0)
+        return check_solver(ctx, s, model, stats);
+
+    set_max_conflicts(ctx, s, max_conflicts);
+    Z3_lbool result = Z3_solver_check_assumptions(ctx, s, num_hints, hints);
+    set_max_conflicts(ctx, s, UINT_MAX);
+
+    // A model of the hinted check is a model of the assertions, and an empty core shows that they are unsatisfiable whatever the hints.
+    if (result == Z3_L_TRUE)
+        return finish_check(ctx, s, result, model, stats);
+    if (result == Z3_L_FALSE)
+    {
+        Z3_ast_vector core = Z3_solver_get_unsat_core(ctx, s);
+        Z3_ast_vector_inc_ref(ctx, core);
+        unsigned core_size = Z3_ast_vector_size(ctx, core);
+        Z3_ast_vector_dec_ref(ctx, core);
+        if (core_size == 0)
+            return finish_check(ctx, s, result, model, stats);
+    }
+
+    // The hints are wrong, or too costly to confirm: the search goes on without them, keeping what the solver learnt.
+    return check_solver(ctx, s, model, stats);
+}
+
 bool value_of_var_in_model(Z3_context ctx, Z3_model model, Z3_ast variable)
 {
     Z3_ast result;
@@ -13,6 +13,7 @@
 #include "Parsing.h"
 #include "Z3Tools.h"
 #include "Parser.h"
+#include "Metrics.h"
 #include <getopt.h>
 
 #ifdef REPARTITION
@@ -33,11 +34,15 @@
 #ifdef TUNNEL
 #include "TunnelNetwork.h"
 #include "TunnelBF.h"
+#include "TunnelFrontier.h"
+#include "TunnelAStar.h"
+#include "TunnelBidir.h"
 #include "TunnelReduction.h"
+#include "TunnelPropagator.h"
+#include "TunnelCubes.h"
 #endif
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/types.h>
@@ -58,6 +63,7 @@ void usage()
 #endif
 #ifdef TUNNEL
     printf("- Tunnel Network simple path existence.\n");
+    printf(" The Tunnel problem also accepts binary networks written by tn_convert (.tnb files), which are loaded without parsing.\n");
 #endif
     printf(" Can apply a brute force algorithm or a reduction to SAT.\n Can display the result both on the command line or in dot format.\n For the reduction, can print the formula generated and give the raw model satisfying it (for debugging purposes).\n");
     printf("Options: \n");
@@ -101,9 +107,90 @@ void usage()
     printf(" -M         Displays the model of the satisfied formula, to help understanding why it is true, especially when there are variables not representing a part of the solution.\n");
     printf(" -t         Displays the solution found [if not present, only displays the existence of the solution].\n");
     printf(" -f         Writes the result with colors in a .dot file. See next option for the name. These files will be produced in the folder 'sol'.\n");
+    printf(" -j N       Parses the input files on N threads [if not present: the number of processors]. With --cubes, also the number of threads solving each size.\n");
     printf(" -o NAME    Writes the output graph in \"NAME_Brute.dot\" or \"NAME_SAT.dot\" depending of the algorithm used and the formula in \"NAME.formula\". [if not present: \"default_SAT.dot\", \"default_Brute.dot\" and \"default.formula\"]\n");
+    printf(" --stats[=FORMAT]  Prints at the end the wall-clock time spent in each phase (parse, graph creation, initialization, preprocessing, formula, solve, decode, output) and the peak memory used. FORMAT is \"text\" (default) or \"json\" (a single machine-readable line).\n");
+    printf(" --engine=NAME  Exact search used by -B for the Tunnel problem: \"dfs\" (default) explores simple paths one by one, \"frontier\" computes all the states reachable at each position with bitsets, then extracts a simple path, \"astar\" expands partial paths by increasing length plus a lower bound of the remaining steps, \"bidir\" joins the first halves of paths with their last halves, enumerated backward from the final node.\n");
+    printf(" --encoding=NAME  Encoding of the stack used by -R for the Tunnel problem: \"boolean\" (default) has a variable per cell, position and symbol, \"bitvector\" a bit-vector per position, pushed and popped by shifts, \"nested\" no stack but the top of each position and the matching of each push with its pop, \"finite\" integer node and height terms with the bit-vector stack.\n");
+    printf(" --lazy-simple  For the Tunnel problem, -R leaves the simple path constraint out of the formula, and enforces it during the search with a propagator raising a conflict when a node is at two positions (only with the \"boolean\" and \"nested\" encodings).\n");
+    printf(" --prune-reach  For the Tunnel problem, -R prunes during the search the states which cannot reach the final state in time, by their distances and heights, and the prefixes after which the final node cannot be reached without revisiting a node (only with the \"boolean\" and \"nested\" encodings).\n");
+    printf(" --warm-start[=BUDGET]  For the Tunnel problem, -R first looks for a path of each size with a brute force expanding at most BUDGET states [if not present: 100000], and gives the solver the path found, or the longest prefix met, as a hint: the solver first tries to extend it, for at most %d conflicts, then searches without it.\n", TnHintConflicts);
+    printf(" --hint-path  With --warm-start, a path of the whole size found by the brute force is taken as the solution, and no formula is solved for this size (-M then has no model to print).\n");
+    printf(" --cubes    For the Tunnel problem, -R splits each size into one cube per node at the middle position of the path, and solves them on the threads of -j, each with its own copy of the formula: the first path found ends the search, and there is none once every cube is refuted. -F, -M, --warm-start and --hint-path are then ignored.\n");
+    printf(" --stats-verbose   Also records, for each size tried by the reduction, the number of constraints, literals and build time of each constraint family, and the statistics of the solver (conflicts, decisions, propagations, memory); with --cubes, the number of cubes, of cubes refuted and of threads started. Implies --stats if absent.\n");
 }
 
+#ifdef TUNNEL
+/**
+ * @brief Records the statistics of the reduction for size @p length (sizes of the constraint families and solver statistics).
+ *
+ * @param length The size of the path.
+ * @param reductionStats The statistics of the formula.
+ * @param solverStats The statistics of the solver.
+ */
+void record_tunnel_length_stats(int length, tn_reduction_stats *reductionStats, solver_statistics *solverStats)
+{
+    metrics_record_start("tn_length");
+    metrics_record_value("length", length);
+    for (tn_constraint_family family = 0; family < NumConstraintFamilies; family++)
+    {
+        const char *name = tn_constraint_family_name(family);
+        char key[64];
+        snprintf(key, 64, "%s.clauses", name);
+        metrics_record_value(key, reductionStats->clauses[family]);
+        snprintf(key, 64, "%s.literals", name);
+        metrics_record_value(key, reductionStats->literals[family]);
+        snprintf(key, 64, "%s.seconds", name);
+        metrics_record_value(key, reductionStats->seconds[family]);
+    }
+    metrics_record_value("solver.conflicts", solverStats->conflicts);
+    metrics_record_value("solver.decisions", solverStats->decisions);
+    metrics_record_value("solver.propagations", solverStats->propagations);
+    metrics_record_value("solver.memory_mb", solverStats->memory);
+}
+
+/**
+ * @brief Records the statistics of the cube-and-conquer search of size @p length (see --cubes), in the same kind of record as record_tunnel_length_stats.
+ *
+ * @param length The size of the path.
+ * @param cubeStats The statistics of the search.
+ */
+void record_tunnel_cube_stats(int length, tn_cube_stats *cubeStats)
+{
+    metrics_record_start("tn_length");
+    metrics_record_value("length", length);
+    metrics_record_value("cubes.count", cubeStats->num_cubes);
+    metrics_record_value("cubes.refuted", cubeStats->num_refuted);
+    metrics_record_value("cubes.workers", cubeStats->num_workers);
+}
+
+#ifdef TN_BF_STATS
+/**
+ * @brief Prints the counters of the last brute force exploration and records them (kind "tn_brute_force", and one record "tn_brute_force_length" per length explored).
+ *
+ */
+void report_brute_force_stats(void)
+{
+    const tn_bf_stats *stats = tn_brute_force_stats();
+    printf("Explored %ld states, tried %ld actions (%ld rejected by the stack), pruned %ld visited successors.\n", stats->nodes_expanded, stats->actions_tried, stats->actions_rejected, stats->visited_prunes);
+    printf("Maximal depth %d, maximal stack height %d, %d lengths explored.\n", stats->max_depth, stats->max_stack_height, stats->num_lengths);
+    metrics_record_start("tn_brute_force");
+    metrics_record_value("nodes_expanded", stats->nodes_expanded);
+    metrics_record_value("actions_tried", stats->actions_tried);
+    metrics_record_value("actions_rejected", stats->actions_rejected);
+    metrics_record_value("visited_prunes", stats->visited_prunes);
+    metrics_record_value("max_depth", stats->max_depth);
+    metrics_record_value("max_stack_height", stats->max_stack_height);
+    for (int i = 0; i < stats->num_lengths; i++)
+    {
+        metrics_record_start("tn_brute_force_length");
+        metrics_record_value("length", i + 1);
+        metrics_record_value("seconds", stats->length_seconds[i]);
+    }
+}
+#endif
+#endif
+
 enum problemType
 {
     Repartition,
@@ -112,6 +199,18 @@ enum problemType
     Tunnel
 };
 
+/**
+ * @brief The exact search run by -B on the Tunnel problem (see option --engine).
+ *
+ */
+enum tunnelEngine
+{
+    DepthFirst,
+    Frontier,
+    AStar,
+    Bidirectional
+};
+
 int main(int argc, char *argv[])
 {
     if (argc < 2)
@@ -130,12 +229,36 @@ int main(int argc, char *argv[])
     bool printModel = false;
     char *problem_parameter = "";
     char *solutionName = "default";
+    metrics_format statsFormat = metrics_format_none;
+    bool verboseStats = false;
+    enum tunnelEngine engine = DepthFirst;
+    tn_stack_encoding encoding = tn_boolean_stack;
+    bool lazySimple = false;
+    bool pruneReach = false;
+    long warmBudget = 0;
+    bool hintPath = false;
+    bool cubes = false;
+    int numThreads = sysconf(_SC_NPROCESSORS_ONLN);
     /*char *realArgs[argc];
     int numArgs = 0;*/
 
+    metrics_init();
+
+    static struct option longOptions[] = {
+        {"stats", optional_argument, NULL, 'S'},
+        {"stats-verbose", no_argument, NULL, 'V'},
+        {"engine", required_argument, NULL, 'E'},
+        {"encoding", required_argument, NULL, 'N'},
+        {"lazy-simple", no_argument, NULL, 'L'},
+        {"prune-reach", no_argument, NULL, 'A'},
+        {"warm-start", optional_argument, NULL, 'W'},
+        {"hint-path", no_argument, NULL, 'H'},
+        {"cubes", no_argument, NULL, 'C'},
+        {NULL, 0, NULL, 0}};
+
     int option;
 
-    while ((option = getopt(argc, argv, ":hP:c:vFBGRMtfo:")) != -1)
+    while ((option = getopt_long(argc, argv, ":hP:c:vFBGRMtfo:j:", longOptions, NULL)) != -1)
     {
         switch (option)
         {
@@ -183,6 +306,51 @@ int main(int argc, char *argv[])
         case 'o':
             solutionName = optarg;
             break;
+        case 'S':
+            if (optarg == NULL || strcmp(optarg, "text") == 0)
+                statsFormat = metrics_format_text;
+            else if (strcmp(optarg, "json") == 0)
+                statsFormat = metrics_format_json;
+            else
+                printf("unknown statistics format: %s\n", optarg);
+            break;
+        case 'V':
+            verboseStats = true;
+            break;
+        case 'j':
+            numThreads = atoi(optarg);
+            break;
+        case 'E':
+            if (strcmp(optarg, "dfs") == 0)
+                engine = DepthFirst;
+            else if (strcmp(optarg, "frontier") == 0)
+                engine = Frontier;
+            else if (strcmp(optarg, "astar") == 0)
+                engine = AStar;
+            else if (strcmp(optarg, "bidir") == 0)
+                engine = Bidirectional;
+            else
+                printf("unknown engine: %s\n", optarg);
+            break;
+        case 'N':
+            if (!tn_stack_encoding_of_name(optarg, &encoding))
+                printf("unknown encoding: %s\n", optarg);
+            break;
+        case 'L':
+            lazySimple = true;
+            break;
+        case 'A':
+            pruneReach = true;
+            break;
+        case 'W':
+            warmBudget = optarg == NULL ? 100000 : atol(optarg);
+            break;
+        case 'H':
+            hintPath = true;
+            break;
+        case 'C':
+            cubes = true;
+            break;
         case '?':
             printf("unknown option: %c\n", optopt);
             break;
@@ -195,14 +363,25 @@ int main(int argc, char *argv[])
         return 0;
     }
 
+    if (verboseStats && statsFormat == metrics_format_none)
+        statsFormat = metrics_format_text;
+
     int num_graphs = argc - optind;
     Graph graphs[argc - optind];
+    char *toParse[argc - optind];
     for (int i = optind; i < argc; i++)
     {
-        graphs[i - optind] = get_graph_from_file(argv[i]);
-        // graph_print(graphs[i - optind]);
-        // printf("\nA\n");
+        toParse[i - optind] = argv[i];
+#ifdef TUNNEL
+        // binary networks are loaded directly by the Tunnel problem.
+        if (problem == Tunnel && tn_is_binary_file(argv[i]))
+        {
+            graphs[i - optind] = (Graph){.numNodes = 0};
+            toParse[i - optind] = NULL;
+        }
+#endif
     }
+    get_graphs_from_files(toParse, num_graphs, graphs, numThreads);
 
     Graph graph = graphs[0];
 
@@ -218,9 +397,9 @@ int main(int argc, char *argv[])
         if (bruteForce)
         {
             printf("\n*******************\n*** Brute Force ***\n*******************\n\n");
-            clock_t start = clock();
+            metrics_phase_start(metrics_solve);
             bool res = repartition_brute_force(rep_graph);
-            double end = (double)(clock() - start) / CLOCKS_PER_SEC;
+            double end = metrics_phase_stop(metrics_solve);
             printf("Brute force computed the solution in %g seconds:\n", end);
             if (res)
             {
@@ -247,14 +426,14 @@ int main(int argc, char *argv[])
 
             Z3_context ctx = make_context();
 
-            clock_t start = clock();
+            metrics_phase_start(metrics_formula);
 
             Z3_ast formula;
             formula = repartition_reduction(ctx, rep_graph);
 
-            clock_t timeFormula = clock();
+            double timeFormula = metrics_phase_stop(metrics_formula);
 
-            printf("formula computed in %g seconds\n", (double)(timeFormula - start) / CLOCKS_PER_SEC);
+            printf("formula computed in %g seconds\n", timeFormula);
 
             if (printformula)
             {
@@ -275,11 +454,11 @@ int main(int argc, char *argv[])
             }
 
             Z3_model model;
+            metrics_phase_start(metrics_solve);
             Z3_lbool isSat = solve_formula(ctx, formula, &model);
+            double timeSat = metrics_phase_stop(metrics_solve);
 
-            clock_t timeSat = clock();
-
-            printf("solution computed in %g seconds\n", (double)(timeSat - timeFormula) / CLOCKS_PER_SEC);
+            printf("solution computed in %g seconds\n", timeSat);
 
             switch (isSat)
             {
@@ -339,7 +518,9 @@ int main(int argc, char *argv[])
         if (verbose)
             printf("We will try to colour the following graph with %d colours\n", num_colours);
 
+        metrics_phase_start(metrics_initialize);
         ColouredGraph coloured_graph = cg_initialize(graph);
+        metrics_phase_stop(metrics_initialize);
 
         if (verbose)
             cg_print(coloured_graph);
@@ -347,13 +528,14 @@ int main(int argc, char *argv[])
         if (bruteForce)
         {
             printf("\n*******************\n*** Brute Force ***\n*******************\n\n");
-            clock_t start = clock();
+            metrics_phase_start(metrics_solve);
             bool res = colouring_brute_force(coloured_graph, num_colours);
-            double end = (double)(clock() - start) / CLOCKS_PER_SEC;
+            double end = metrics_phase_stop(metrics_solve);
             printf("Brute force computed the solution in %g seconds:\n", end);
             if (res)
             {
                 printf("There is a %d-colouring of this graph.\n", num_colours);
+                metrics_phase_start(metrics_output);
                 if (displayTerminal)
                     cg_print_colors(coloured_graph);
                 if (outputFile)
@@ -364,6 +546,7 @@ int main(int argc, char *argv[])
                     cg_create_dot(coloured_graph, nameFile);
                     printf("Solution printed in sol/%s.dot.\n", nameFile);
                 }
+                metrics_phase_stop(metrics_output);
             }
             else
                 printf("There is no %d-colouring of this graph.\n", num_colours);
@@ -375,17 +558,18 @@ int main(int argc, char *argv[])
 
             Z3_context ctx = make_context();
 
-            clock_t start = clock();
+            metrics_phase_start(metrics_formula);
 
             Z3_ast formula;
             formula = colouring_reduction(ctx, coloured_graph, num_colours);
 
-            clock_t timeFormula = clock();
+            double timeFormula = metrics_phase_stop(metrics_formula);
 
-            printf("formula computed in %g seconds\n", (double)(timeFormula - start) / CLOCKS_PER_SEC);
+            printf("formula computed in %g seconds\n", timeFormula);
 
             if (printformula)
             {
+                metrics_phase_start(metrics_output);
                 struct stat st = {0};
                 if (stat("./sol", &st) == -1)
                     mkdir("./sol", 0777);
@@ -396,14 +580,15 @@ int main(int argc, char *argv[])
                 fprintf(file, "%s\n", Z3_ast_to_string(ctx, formula));
                 fclose(file);
                 printf("Formula printed in sol/%s.formula\n", solutionName);
+                metrics_phase_stop(metrics_output);
             }
 
             Z3_model model;
+            metrics_phase_start(metrics_solve);
             Z3_lbool isSat = solve_formula(ctx, formula, &model);
+            double timeSat = metrics_phase_stop(metrics_solve);
 
-            clock_t timeSat = clock();
-
-            printf("solution computed in %g seconds\n", (double)(timeSat - timeFormula) / CLOCKS_PER_SEC);
+            printf("solution computed in %g seconds\n", timeSat);
 
             switch (isSat)
             {
@@ -418,12 +603,15 @@ int main(int argc, char *argv[])
             case Z3_L_TRUE:
                 printf("There is a %d-colouring of this graph.\n", num_colours);
 
+                metrics_phase_start(metrics_decode);
                 if (displayTerminal || outputFile)
                     colour_graph_from_model(ctx, model, coloured_graph, num_colours);
+                metrics_phase_stop(metrics_decode);
 
                 //            if (displayModel)
                 //                printModel(ctx, model, biGraph, numComponent);
 
+                metrics_phase_start(metrics_output);
                 if (displayTerminal)
                 {
                     cg_print_colors(coloured_graph);
@@ -439,6 +627,7 @@ int main(int argc, char *argv[])
                     cg_create_dot(coloured_graph, nameFile);
                     printf("Solution printed in sol/%s.dot.\n", nameFile);
                 }
+                metrics_phase_stop(metrics_output);
 
                 break;
             }
@@ -481,9 +670,9 @@ int main(int argc, char *argv[])
         if (bruteForce)
         {
             printf("\n*******************\n*** Brute Force ***\n*******************\n\n");
-            clock_t start = clock();
+            metrics_phase_start(metrics_solve);
             bool res = deadlock_brute_force(automata, num_graphs, bound, path);
-            double end = (double)(clock() - start) / CLOCKS_PER_SEC;
+            double end = metrics_phase_stop(metrics_solve);
             printf("Brute force computed the solution in %g seconds:\n", end);
             if (res)
             {
@@ -509,14 +698,14 @@ int main(int argc, char *argv[])
 
             Z3_context ctx = make_context();
 
-            clock_t start = clock();
+            metrics_phase_start(metrics_formula);
 
             Z3_ast formula;
             formula = deadlock_reduction(ctx, automata, num_graphs, bound);
 
-            clock_t timeFormula = clock();
+            double timeFormula = metrics_phase_stop(metrics_formula);
 
-            printf("formula computed in %g seconds\n", (double)(timeFormula - start) / CLOCKS_PER_SEC);
+            printf("formula computed in %g seconds\n", timeFormula);
 
             if (printformula)
             {
@@ -537,11 +726,11 @@ int main(int argc, char *argv[])
             }
 
             Z3_model model;
+            metrics_phase_start(metrics_solve);
             Z3_lbool isSat = solve_formula(ctx, formula, &model);
+            double timeSat = metrics_phase_stop(metrics_solve);
 
-            clock_t timeSat = clock();
-
-            printf("solution computed in %g seconds\n", (double)(timeSat - timeFormula) / CLOCKS_PER_SEC);
+            printf("solution computed in %g seconds\n", timeSat);
 
             switch (isSat)
             {
@@ -592,7 +781,14 @@ int main(int argc, char *argv[])
     if (problem == Tunnel)
     {
         printf("\n*****************************************\n*** Tunnel Network Problem ***\n*****************************************\n\n");
-        TunnelNetwork network = tn_initialize(graph);
+        metrics_phase_start(metrics_initialize);
+        TunnelNetwork network = tn_is_binary_file(argv[optind]) ? tn_load_binary(argv[optind]) : tn_initialize(graph);
+        metrics_phase_stop(metrics_initialize);
+        if (network == NULL)
+        {
+            printf("Exiting.\n");
+            exit(-1);
+        }
         if (verbose)
         {
             tn_print(network);
@@ -612,13 +808,35 @@ int main(int argc, char *argv[])
         {
             printf("\n*******************\n*** Brute Force ***\n*******************\n\n");
 #ifndef SUBJECT
-            clock_t start = clock();
-            int res = tn_brute_force(network, bound, path);
-            double end = (double)(clock() - start) / CLOCKS_PER_SEC;
+            metrics_phase_start(metrics_solve);
+            int res;
+            switch (engine)
+            {
+            case Frontier:
+                res = tn_frontier_search(network, bound, path);
+                break;
+            case AStar:
+                res = tn_astar_search(network, bound, path);
+                break;
+            case Bidirectional:
+                res = tn_bidir_search(network, bound, path);
+                break;
+            default:
+                res = tn_brute_force(network, bound, path);
+                break;
+            }
+            double end = metrics_phase_stop(metrics_solve);
             printf("Brute force computed the solution in %g seconds:\n", end);
+#ifdef TN_BF_STATS
+            if (engine == DepthFirst)
+                report_brute_force_stats();
+#endif
             if (res > 0)
             {
                 printf("There is a simple path of size %d.\n", res);
+                if (!tn_validate_path(network, path, res))
+                    printf("Warning: the path found is not a valid path.\n");
+                metrics_phase_start(metrics_output);
                 if (displayTerminal)
                     tn_print_path(network, path, res);
                 if (outputFile)
@@ -629,6 +847,7 @@ int main(int argc, char *argv[])
                     tn_create_dot(network, path, res, nameFile);
                     printf("Solution printed in sol/%s.dot.\n", nameFile);
                 }
+                metrics_phase_stop(metrics_output);
             }
             else
                 printf("There is no simple path of size at most %d.\n", bound);
@@ -641,45 +860,122 @@ int main(int argc, char *argv[])
         {
             printf("\n************************\n*** Reduction to SAT ***\n************************\n\n");
 
-            Z3_context ctx = make_context();
+            // The terms of each length are freed with its solver, instead of piling up until the end.
+            Z3_context ctx = make_rc_context();
+
+            if ((lazySimple || pruneReach) && !tn_propagator_supports(encoding))
+            {
+                printf("The propagator does not support the %s encoding: --lazy-simple and --prune-reach ignored.\n", tn_stack_encoding_name(encoding));
+                lazySimple = false;
+                pruneReach = false;
+            }
+            unsigned checks = (lazySimple ? tn_propagate_simple : 0) | (pruneReach ? tn_propagate_reachability : 0);
+            if (cubes && (printformula || printModel || warmBudget > 0 || hintPath))
+            {
+                printf("Each cube is solved in its own context: -F, -M, --warm-start and --hint-path ignored with --cubes.\n");
+                printformula = false;
+                printModel = false;
+                warmBudget = 0;
+                hintPath = false;
+            }
 
             for (int l = 1; l <= bound; l++)
             {
                 printf("\n--- size %d ---\n", l);
 
-                clock_t start = clock();
+                Z3_lbool isSat;
+                double timeSat;
+                Z3_model model = NULL;
 
-                Z3_ast formula;
-                formula = tn_reduction(ctx, network, l);
+                // The hint of the warm start is computed on the network, before building the formula.
+                tn_step hint[l];
+                int hintLength = 0;
+                if (warmBudget > 0)
+                {
+                    metrics_phase_start(metrics_preprocessing);
+                    hintLength = tn_brute_force_hint(network, l, warmBudget, hint);
+                    metrics_phase_stop(metrics_preprocessing);
+                    printf("hint of %d steps found by the brute force\n", hintLength);
+                }
 
-                clock_t timeFormula = clock();
+                if (cubes)
+                {
+                    // The formula is built by each thread of the search, within the solving time.
+                    metrics_phase_start(metrics_solve);
+                    tn_cube_stats cubeStats;
+                    isSat = tn_solve_cubes(network, l, encoding, checks, numThreads, path, &cubeStats);
+                    timeSat = metrics_phase_stop(metrics_solve);
+                    printf("%d of %d cubes refuted by %d threads\n", cubeStats.num_refuted, cubeStats.num_cubes, cubeStats.num_workers);
+                    if (verboseStats)
+                        record_tunnel_cube_stats(l, &cubeStats);
+                    printf("solution computed in %g seconds\n", timeSat);
+                }
+                else if (hintPath && hintLength == l)
+                {
+                    // A hint of the whole size is a path, checked step by step by the brute force: there is nothing left to solve.
+                    isSat = Z3_L_TRUE;
+                    for (int step = 0; step < l; step++)
+                        path[step] = hint[step];
+                    printf("the hint is a path: no formula solved\n");
+                }
+                else
+                {
+                    Z3_solver solver = checks != 0 ? Z3_mk_simple_solver(ctx) : warmBudget > 0 ? make_hinted_solver(ctx, encoding != tn_finite_domain) : Z3_mk_solver(ctx);
+                    Z3_solver_inc_ref(ctx, solver);
 
-                printf("formula for size %d computed in %g seconds\n", l, (double)(timeFormula - start) / CLOCKS_PER_SEC);
+                    // The distances of the propagator are computed on the network, before building the formula.
+                    metrics_phase_start(metrics_preprocessing);
+                    tn_propagator propagator = checks != 0 ? tn_propagator_attach(ctx, solver, network, l, encoding, checks) : NULL;
+                    Z3_ast hints[l + 1];
+                    int numHints = tn_hint_literals(ctx, hint, hintLength, encoding, hints);
+                    metrics_phase_stop(metrics_preprocessing);
 
-                if (printformula)
-                {
+                    metrics_phase_start(metrics_formula);
+
+                    // The constraints are streamed into the solver: the formula printed is read back from it.
+                    tn_reduction_stats reductionStats;
+                    unsigned omitted = lazySimple ? 1u << tn_simple : 0;
+                    tn_assert_reduction(ctx, solver, network, l, encoding, omitted, verboseStats ? &reductionStats : NULL);
+
+                    double timeFormula = metrics_phase_stop(metrics_formula);
+
+                    printf("formula for size %d computed in %g seconds\n", l, timeFormula);
+
+                    if (printformula)
+                    {
 #ifndef SUBJECT
-                    struct stat st = {0};
-                    if (stat("./sol", &st) == -1)
-                        mkdir("./sol", 0777);
-                    int length = strlen(solutionName) + 13;
-                    char nameFile[length];
-                    snprintf(nameFile, length, "sol/%s_%d.formula", solutionName, l);
-                    FILE *file = fopen(nameFile, "w");
-                    fprintf(file, "%s\n", Z3_ast_to_string(ctx, formula));
-                    fclose(file);
-                    printf("Formula for size %d printed in sol/%s_%d.formula\n", l, solutionName, l);
+                        metrics_phase_start(metrics_output);
+                        struct stat st = {0};
+                        if (stat("./sol", &st) == -1)
+                            mkdir("./sol", 0777);
+                        int length = strlen(solutionName) + 13;
+                        char nameFile[length];
+                        snprintf(nameFile, length, "sol/%s_%d.formula", solutionName, l);
+                        FILE *file = fopen(nameFile, "w");
+                        fprintf(file, "%s\n", Z3_solver_to_string(ctx, solver));
+                        fclose(file);
+                        printf("Formula for size %d printed in sol/%s_%d.formula\n", l, solutionName, l);
+                        metrics_phase_stop(metrics_output);
 #else
-                    printf("Nah, I'm not displaying the formula in the given executable\n");
+                        printf("Nah, I'm not displaying the formula in the given executable\n");
 #endif
-                }
+                    }
 
-                Z3_model model;
-                Z3_lbool isSat = solve_formula(ctx, formula, &model);
+                    solver_statistics solverStats;
+                    metrics_phase_start(metrics_solve);
+                    isSat = check_solver_with_hints(ctx, solver, numHints, hints, TnHintConflicts, &model, verboseStats ? &solverStats : NULL);
+                    for (int hint = 0; hint < numHints; hint++)
+                        Z3_dec_ref(ctx, hints[hint]);
+                    Z3_solver_dec_ref(ctx, solver);
+                    if (propagator != NULL)
+                        tn_propagator_delete(propagator);
+                    timeSat = metrics_phase_stop(metrics_solve);
 
-                clock_t timeSat = clock();
+                    if (verboseStats)
+                        record_tunnel_length_stats(l, &reductionStats, &solverStats);
 
-                printf("solution computed in %g seconds\n", (double)(timeSat - timeFormula) / CLOCKS_PER_SEC);
+                    printf("solution computed in %g seconds\n", timeSat);
+                }
 
                 switch (isSat)
                 {
@@ -697,14 +993,23 @@ int main(int argc, char *argv[])
                     if (!(displayTerminal || outputFile || printModel))
                         goto TN_end;
 
-                    tn_get_path_from_model(ctx, model, network, l, path);
+                    // With cubes, the thread which found the model has already decoded it, and a hint of the whole size is the path itself.
+                    if (model != NULL)
+                    {
+                        metrics_phase_start(metrics_decode);
+                        tn_get_path_from_model(ctx, model, network, l, encoding, path);
+                        metrics_phase_stop(metrics_decode);
+                    }
+                    if (!tn_validate_path(network, path, l))
+                        printf("Warning: the path decoded from the model is not a valid path.\n");
 
+                    metrics_phase_start(metrics_output);
                     if (displayTerminal)
                     {
                         tn_print_path(network, path, l);
                     }
-                    if (printModel)
-                        tn_print_model(ctx, model, network, l);
+                    if (printModel && model != NULL)
+                        tn_print_model(ctx, model, network, l, encoding);
 
                     if (outputFile)
                     {
@@ -714,6 +1019,7 @@ int main(int argc, char *argv[])
                         tn_create_dot(network, path, l, nameFile);
                         printf("Solution printed in sol/%s.dot.\n", nameFile);
                     }
+                    metrics_phase_stop(metrics_output);
 
                     goto TN_end;
                 }
@@ -730,5 +1036,8 @@ int main(int argc, char *argv[])
     for (int i = 0; i < num_graphs; i++)
         graph_delete(graphs[i]);
 
+    metrics_print(stdout, statsFormat);
+    metrics_release();
+
     return 0;
 }
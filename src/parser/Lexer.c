@@ -490,18 +490,17 @@ static const flex_int16_t yy_chk[120] =
 #include <ctype.h>
 #include <string.h>
 #include <stdlib.h>
-#include "GraphList.h"
+#include "GraphBuilder.h"
 #include "Parser.h"
+#include "StringPool.h"
 
- 
- #define MAXSIZE  1024
-char any_name_s[MAXSIZE];
+/* yyextra is the StringPool in which identifiers and strings are interned. */
 
-#line 501 "src/parser/Lexer.c"
+#line 500 "src/parser/Lexer.c"
 /* %option outfile="Lexer.c" header-file="Lexer.h"  //for normal make.*/
 #define YY_NO_UNISTD_H 1
 #define YY_NO_INPUT 1
-#line 505 "src/parser/Lexer.c"
+#line 504 "src/parser/Lexer.c"
 
 #define INITIAL 0
 
@@ -773,9 +772,9 @@ YY_DECL
 		}
 
 	{
-#line 64 "src/parser/Lexer.l"
+#line 63 "src/parser/Lexer.l"
 
-#line 779 "src/parser/Lexer.c"
+#line 778 "src/parser/Lexer.c"
 
 	while ( /*CONSTCOND*/1 )		/* loops until end-of-file is reached */
 		{
@@ -830,132 +829,129 @@ do_action:	/* This label is used only to access EOF actions. */
 
 case 1:
 YY_RULE_SETUP
-#line 65 "src/parser/Lexer.l"
+#line 64 "src/parser/Lexer.l"
 { }
 	YY_BREAK
 case 2:
 /* rule 2 can match eol */
 YY_RULE_SETUP
-#line 66 "src/parser/Lexer.l"
-{ strcpy(any_name_s,yytext);
-                  yylval->name = any_name_s;
+#line 65 "src/parser/Lexer.l"
+{ yylval->name = string_pool_intern(yyextra, yytext, yyleng);
                   return(T_STRING); }
 	YY_BREAK
 case 3:
 /* rule 3 can match eol */
 YY_RULE_SETUP
-#line 69 "src/parser/Lexer.l"
+#line 67 "src/parser/Lexer.l"
 ;
 	YY_BREAK
 case 4:
 YY_RULE_SETUP
-#line 70 "src/parser/Lexer.l"
+#line 68 "src/parser/Lexer.l"
 { return(T_LBRACKET); }
 	YY_BREAK
 case 5:
 YY_RULE_SETUP
-#line 71 "src/parser/Lexer.l"
+#line 69 "src/parser/Lexer.l"
 { return(T_RBRACKET); }
 	YY_BREAK
 case 6:
 YY_RULE_SETUP
-#line 72 "src/parser/Lexer.l"
+#line 70 "src/parser/Lexer.l"
 { return(T_LPAREN); }
 	YY_BREAK
 case 7:
 YY_RULE_SETUP
-#line 73 "src/parser/Lexer.l"
+#line 71 "src/parser/Lexer.l"
 { return(T_RPAREN); }
 	YY_BREAK
 case 8:
 YY_RULE_SETUP
-#line 74 "src/parser/Lexer.l"
+#line 72 "src/parser/Lexer.l"
 { return(T_LBRACE); }
 	YY_BREAK
 case 9:
 YY_RULE_SETUP
-#line 75 "src/parser/Lexer.l"
+#line 73 "src/parser/Lexer.l"
 { return(T_RBRACE); }
 	YY_BREAK
 case 10:
 YY_RULE_SETUP
-#line 76 "src/parser/Lexer.l"
+#line 74 "src/parser/Lexer.l"
 { return(T_COMMA); }
 	YY_BREAK
 case 11:
 YY_RULE_SETUP
-#line 77 "src/parser/Lexer.l"
+#line 75 "src/parser/Lexer.l"
 { return(T_COLON); }
 	YY_BREAK
 case 12:
 YY_RULE_SETUP
-#line 78 "src/parser/Lexer.l"
+#line 76 "src/parser/Lexer.l"
 { return(T_SEMI); }
 	YY_BREAK
 case 13:
 YY_RULE_SETUP
-#line 79 "src/parser/Lexer.l"
+#line 77 "src/parser/Lexer.l"
 { return(T_DEDGE); }
 	YY_BREAK
 case 14:
 YY_RULE_SETUP
-#line 80 "src/parser/Lexer.l"
+#line 78 "src/parser/Lexer.l"
 { return(T_UEDGE); }
 	YY_BREAK
 case 15:
 YY_RULE_SETUP
-#line 81 "src/parser/Lexer.l"
+#line 79 "src/parser/Lexer.l"
 { return(T_EQ); }
 	YY_BREAK
 case 16:
 YY_RULE_SETUP
-#line 82 "src/parser/Lexer.l"
+#line 80 "src/parser/Lexer.l"
 { return(T_DIGRAPH); }
 	YY_BREAK
 case 17:
 YY_RULE_SETUP
-#line 83 "src/parser/Lexer.l"
+#line 81 "src/parser/Lexer.l"
 { return(T_GRAPH); }
 	YY_BREAK
 case 18:
 YY_RULE_SETUP
-#line 84 "src/parser/Lexer.l"
+#line 82 "src/parser/Lexer.l"
 { return(T_SUBGRAPH); }
 	YY_BREAK
 case 19:
 YY_RULE_SETUP
-#line 85 "src/parser/Lexer.l"
+#line 83 "src/parser/Lexer.l"
 { return(T_AT); }
 	YY_BREAK
 case 20:
 YY_RULE_SETUP
-#line 86 "src/parser/Lexer.l"
+#line 84 "src/parser/Lexer.l"
 { return(T_STRICT); }
 	YY_BREAK
 case 21:
 YY_RULE_SETUP
-#line 87 "src/parser/Lexer.l"
+#line 85 "src/parser/Lexer.l"
 { return(T_NODE); }
 	YY_BREAK
 case 22:
 YY_RULE_SETUP
-#line 88 "src/parser/Lexer.l"
+#line 86 "src/parser/Lexer.l"
 { return(T_EDGE); }
 	YY_BREAK
 case 23:
 YY_RULE_SETUP
-#line 89 "src/parser/Lexer.l"
-{ //any_name_s = malloc(sizeof(yytext)+1);
-                  strcpy(any_name_s, yytext);
-                  yylval->name = any_name_s;
+#line 87 "src/parser/Lexer.l"
+{ yylval->name = string_pool_intern(yyextra, yytext, yyleng);
                   return(T_ID); }
 	YY_BREAK
 case 24:
 YY_RULE_SETUP
-#line 94 "src/parser/Lexer.l"
+#line 91 "src/parser/Lexer.l"
 ECHO;
 	YY_BREAK
-#line 959 "src/parser/Lexer.c"
+#line 955 "src/parser/Lexer.c"
 case YY_STATE_EOF(INITIAL):
 	yyterminate();
 
@@ -2099,7 +2095,7 @@ void yyfree (void * ptr , yyscan_t yyscanner)
 
 #define YYTABLES_NAME "yytables"
 
-#line 94 "src/parser/Lexer.l"
+#line 91 "src/parser/Lexer.l"
 
 
 
@@ -73,7 +73,7 @@
  * @file Parser.l
  * @author Vincent Penelle (vincent.penelle@u-bordeaux.fr)
  * @brief  Parser for a graphviz parser, intended to serve for a master's project at University of Bordeaux. Adapted from gvizparse by Nikolaos Kavvadias (https://github.com/nkkav/gvizparse v1.0.0).
- *         Convert a .dot file into a GraphList structure.
+ *         Convert a .dot file into a Graph, through a GraphBuilder.
            Does not support subgraphs for now.
            This version supports automata with custom syntax (nodes are declared initial (resp. final) with an option of the form "[initial=N]" (resp. "[final=N]"), with N standing for any string), and stores the color of the node (if any).
  * @version 2
@@ -83,19 +83,23 @@
  * 
  */
  
-#include "GraphList.h"
+#include "GraphBuilder.h"
 #include "Parser.h"
 #include "Lexer.h"
 #include "Graph.h"
+#include "DotScanner.h"
 
-int yyerror(GraphList *expression, yyscan_t scanner, const char *msg) {
+/* The scanner given to yyparse is a DotInput, which reads either a mapped file or a flex scanner. */
+#define yylex dot_input_lex
+
+int yyerror(GraphBuilder builder, yyscan_t scanner, const char *msg) {
     /* Add error handling routine as needed */
     printf("Erreur: %s\n",msg);
     return 0;
 }
  
 
-#line 99 "src/parser/Parser.c"
+#line 103 "src/parser/Parser.c"
 
 # ifndef YY_CAST
 #  ifdef __cplusplus
@@ -558,10 +562,10 @@ static const yytype_uint8 yyrline[] =
 {
        0,    91,    91,    94,    95,    98,    99,   102,   103,   106,
      107,   109,   110,   113,   114,   115,   116,   117,   120,   121,
-     122,   125,   126,   127,   130,   133,   134,   137,   142,   147,
-     149,   153,   154,   160,   164,   170,   171,   172,   173,   176,
-     177,   180,   183,   187,   191,   192,   195,   198,   205,   206,
-     207,   210,   211
+     122,   125,   126,   127,   128,   131,   132,   133,   136,   141,
+     142,   145,   146,   151,   154,   159,   160,   161,   162,   165,
+     166,   169,   172,   175,   178,   179,   182,   185,   191,   192,
+     193,   196,   197
 };
 #endif
 
@@ -742,7 +746,7 @@ enum { YYENOMEM = -2 };
       }                                                           \
     else                                                          \
       {                                                           \
-        yyerror (graph, scanner, YY_("syntax error: cannot back up")); \
+        yyerror (builder, scanner, YY_("syntax error: cannot back up")); \
         YYERROR;                                                  \
       }                                                           \
   while (0)
@@ -775,7 +779,7 @@ do {                                                                      \
     {                                                                     \
       YYFPRINTF (stderr, "%s ", Title);                                   \
       yy_symbol_print (stderr,                                            \
-                  Kind, Value, graph, scanner); \
+                  Kind, Value, builder, scanner); \
       YYFPRINTF (stderr, "\n");                                           \
     }                                                                     \
 } while (0)
@@ -787,11 +791,11 @@ do {                                                                      \
 
 static void
 yy_symbol_value_print (FILE *yyo,
-                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, GraphList *graph, yyscan_t scanner)
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, GraphBuilder builder, yyscan_t scanner)
 {
   FILE *yyoutput = yyo;
   YY_USE (yyoutput);
-  YY_USE (graph);
+  YY_USE (builder);
   YY_USE (scanner);
   if (!yyvaluep)
     return;
@@ -807,12 +811,12 @@ yy_symbol_value_print (FILE *yyo,
 
 static void
 yy_symbol_print (FILE *yyo,
-                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, GraphList *graph, yyscan_t scanner)
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, GraphBuilder builder, yyscan_t scanner)
 {
   YYFPRINTF (yyo, "%s %s (",
              yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyo, yykind, yyvaluep, graph, scanner);
+  yy_symbol_value_print (yyo, yykind, yyvaluep, builder, scanner);
   YYFPRINTF (yyo, ")");
 }
 
@@ -846,7 +850,7 @@ do {                                                            \
 
 static void
 yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
-                 int yyrule, GraphList *graph, yyscan_t scanner)
+                 int yyrule, GraphBuilder builder, yyscan_t scanner)
 {
   int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
@@ -859,7 +863,7 @@ yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
       yy_symbol_print (stderr,
                        YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
-                       &yyvsp[(yyi + 1) - (yynrhs)], graph, scanner);
+                       &yyvsp[(yyi + 1) - (yynrhs)], builder, scanner);
       YYFPRINTF (stderr, "\n");
     }
 }
@@ -867,7 +871,7 @@ yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
 # define YY_REDUCE_PRINT(Rule)          \
 do {                                    \
   if (yydebug)                          \
-    yy_reduce_print (yyssp, yyvsp, Rule, graph, scanner); \
+    yy_reduce_print (yyssp, yyvsp, Rule, builder, scanner); \
 } while (0)
 
 /* Nonzero means print parse trace.  It is left uninitialized so that
@@ -908,10 +912,10 @@ int yydebug;
 
 static void
 yydestruct (const char *yymsg,
-            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, GraphList *graph, yyscan_t scanner)
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, GraphBuilder builder, yyscan_t scanner)
 {
   YY_USE (yyvaluep);
-  YY_USE (graph);
+  YY_USE (builder);
   YY_USE (scanner);
   if (!yymsg)
     yymsg = "Deleting";
@@ -932,7 +936,7 @@ yydestruct (const char *yymsg,
 `----------*/
 
 int
-yyparse (GraphList *graph, yyscan_t scanner)
+yyparse (GraphBuilder builder, yyscan_t scanner)
 {
 /* Lookahead token kind.  */
 int yychar;
@@ -1188,163 +1192,131 @@ yyreduce:
     {
   case 2: /* input: strict graph_type idrhs T_LBRACE stmt_list T_RBRACE  */
 #line 91 "src/parser/Parser.y"
-                                                            {graph->name = (yyvsp[-3].name);}
-#line 1193 "src/parser/Parser.c"
+                                                            {graph_builder_set_name(builder,(yyvsp[-3].name));}
+#line 1197 "src/parser/Parser.c"
     break;
 
   case 5: /* graph_type: T_DIGRAPH  */
 #line 98 "src/parser/Parser.y"
-                        { graph->directed = true;}
-#line 1199 "src/parser/Parser.c"
+                        { graph_builder_set_directed(builder,true);}
+#line 1203 "src/parser/Parser.c"
     break;
 
   case 6: /* graph_type: T_GRAPH  */
 #line 99 "src/parser/Parser.y"
-                        { graph->directed = false;}
-#line 1205 "src/parser/Parser.c"
-    break;
-
-  case 21: /* attr_list: T_LBRACKET a_list T_RBRACKET  */
-#line 125 "src/parser/Parser.y"
-                                                { (yyval.parameterInfo) = (yyvsp[-1].parameterInfo); }
-#line 1211 "src/parser/Parser.c"
-    break;
-
-  case 22: /* attr_list: T_LBRACKET T_RBRACKET  */
-#line 126 "src/parser/Parser.y"
-                                                { (yyval.parameterInfo).parameters=NULL;}
-#line 1217 "src/parser/Parser.c"
-    break;
-
-  case 23: /* attr_list: T_LBRACKET a_list T_RBRACKET attr_list  */
-#line 127 "src/parser/Parser.y"
-                                                { 
-                                                (yyval.parameterInfo).parameters = parameter_lists_merge((yyvsp[-2].parameterInfo).parameters,(yyvsp[0].parameterInfo).parameters);
-                                                }
-#line 1225 "src/parser/Parser.c"
+                        { graph_builder_set_directed(builder,false);}
+#line 1209 "src/parser/Parser.c"
     break;
 
-  case 24: /* attr_list: T_LBRACKET T_RBRACKET attr_list  */
-#line 130 "src/parser/Parser.y"
-                                                { (yyval.parameterInfo) = (yyvsp[0].parameterInfo); }
-#line 1231 "src/parser/Parser.c"
+  case 17: /* stmt1: attr_assignment  */
+#line 117 "src/parser/Parser.y"
+                            { graph_builder_drop_attrs(builder); }
+#line 1215 "src/parser/Parser.c"
     break;
 
-  case 25: /* a_list: attr_assignment  */
-#line 133 "src/parser/Parser.y"
-                                        { (yyval.parameterInfo) = (yyvsp[0].parameterInfo);}
-#line 1237 "src/parser/Parser.c"
+  case 18: /* attr_stmt: T_GRAPH attr_list  */
+#line 120 "src/parser/Parser.y"
+                                { graph_builder_drop_attrs(builder); }
+#line 1221 "src/parser/Parser.c"
     break;
 
-  case 26: /* a_list: attr_assignment T_COMMA a_list  */
-#line 134 "src/parser/Parser.y"
-                                        { 
-                                            (yyval.parameterInfo).parameters = parameter_lists_merge((yyvsp[-2].parameterInfo).parameters,(yyvsp[0].parameterInfo).parameters);
-                                          }
-#line 1245 "src/parser/Parser.c"
+  case 19: /* attr_stmt: T_NODE attr_list  */
+#line 121 "src/parser/Parser.y"
+                                { graph_builder_drop_attrs(builder); }
+#line 1227 "src/parser/Parser.c"
     break;
 
-  case 27: /* a_list: attr_assignment a_list  */
-#line 137 "src/parser/Parser.y"
-                                        { 
-                                            (yyval.parameterInfo).parameters = parameter_lists_merge((yyvsp[-1].parameterInfo).parameters,(yyvsp[0].parameterInfo).parameters);
-                                          }
-#line 1253 "src/parser/Parser.c"
+  case 20: /* attr_stmt: T_EDGE attr_list  */
+#line 122 "src/parser/Parser.y"
+                                { graph_builder_drop_attrs(builder); }
+#line 1233 "src/parser/Parser.c"
     break;
 
   case 28: /* attr_assignment: idrhs T_EQ idrhs  */
-#line 142 "src/parser/Parser.y"
+#line 136 "src/parser/Parser.y"
                                      { 
-      (yyval.parameterInfo).parameters = parameter_list_add_parameter(NULL,(yyvsp[-2].name),(yyvsp[0].name));
-             free((yyvsp[-2].name)); free((yyvsp[0].name));}
-#line 1261 "src/parser/Parser.c"
+      graph_builder_add_attr(builder,(yyvsp[-2].name),(yyvsp[0].name));
+             }
+#line 1241 "src/parser/Parser.c"
     break;
 
   case 29: /* idrhs: T_ID  */
-#line 147 "src/parser/Parser.y"
-                    { (yyval.name) = (char*)malloc((strlen((yyvsp[0].name))+1)*sizeof(char)); strcpy((yyval.name),(yyvsp[0].name));
-                    }
-#line 1268 "src/parser/Parser.c"
+#line 141 "src/parser/Parser.y"
+                    { (yyval.name) = (yyvsp[0].name); }
+#line 1247 "src/parser/Parser.c"
     break;
 
   case 30: /* idrhs: T_STRING  */
-#line 149 "src/parser/Parser.y"
-                    { (yyval.name) = (char*)malloc((strlen((yyvsp[0].name))+1)*sizeof(char)); strcpy((yyval.name),(yyvsp[0].name));
-                    }
-#line 1275 "src/parser/Parser.c"
-    break;
-
-  case 31: /* node_stmt: node_id  */
-#line 153 "src/parser/Parser.y"
-                            { free((yyvsp[0].name)); }
-#line 1281 "src/parser/Parser.c"
+#line 142 "src/parser/Parser.y"
+                    { (yyval.name) = (yyvsp[0].name); }
+#line 1253 "src/parser/Parser.c"
     break;
 
   case 32: /* node_stmt: node_id attr_list  */
-#line 154 "src/parser/Parser.y"
+#line 146 "src/parser/Parser.y"
                             {   
-                                add_parameters_to_node((yyvsp[-1].name),(yyvsp[0].parameterInfo).parameters,graph->nodes);
-                                free((yyvsp[-1].name));
+                                graph_builder_attach_attrs(builder,(yyvsp[-1].node));
                             }
-#line 1290 "src/parser/Parser.c"
+#line 1261 "src/parser/Parser.c"
     break;
 
   case 33: /* node_id: T_ID  */
-#line 160 "src/parser/Parser.y"
+#line 151 "src/parser/Parser.y"
                     { 
-                      (yyval.name) = (char*)malloc((strlen((yyvsp[0].name))+1)*sizeof(char)); strcpy((yyval.name),(yyvsp[0].name));
-                      if(graph->nodes == NULL) graph->nodes = addNode((yyvsp[0].name),NULL); else addOrUpdateNode((yyvsp[0].name),graph->nodes);
+                      (yyval.node) = graph_builder_add_node(builder,(yyvsp[0].name));
                     }
-#line 1299 "src/parser/Parser.c"
+#line 1269 "src/parser/Parser.c"
     break;
 
   case 34: /* node_id: T_ID port  */
-#line 164 "src/parser/Parser.y"
+#line 154 "src/parser/Parser.y"
                     { 
-                      (yyval.name) = (char*)malloc((strlen((yyvsp[-1].name))+1)*sizeof(char)); strcpy((yyval.name),(yyvsp[-1].name));
-                      if(graph->nodes == NULL) graph->nodes = addNode((yyvsp[-1].name),NULL); else addOrUpdateNode((yyvsp[-1].name),graph->nodes);
+                      (yyval.node) = graph_builder_add_node(builder,(yyvsp[-1].name));
                     }
-#line 1308 "src/parser/Parser.c"
+#line 1277 "src/parser/Parser.c"
     break;
 
   case 42: /* edge_stmt: node_id edgerhs  */
-#line 183 "src/parser/Parser.y"
+#line 172 "src/parser/Parser.y"
                                     { //printf("edge seen: (%s,%s)\n",$1,$2);
-                                      graph->edges = addEdge((yyvsp[-1].name),(yyvsp[0].name),graph->edges,NULL);
-                                      free((yyvsp[-1].name)); free((yyvsp[0].name));
+                                      graph_builder_add_edge(builder,(yyvsp[-1].node),(yyvsp[0].node));
                                     }
-#line 1317 "src/parser/Parser.c"
+#line 1285 "src/parser/Parser.c"
     break;
 
   case 43: /* edge_stmt: node_id edgerhs attr_list  */
-#line 187 "src/parser/Parser.y"
+#line 175 "src/parser/Parser.y"
                                     { //printf("edge seen: (%s,%s)\n",$1,$2);
-                                      graph->edges = addEdge((yyvsp[-2].name),(yyvsp[-1].name),graph->edges,(yyvsp[0].parameterInfo).parameters);
-                                      free((yyvsp[-2].name)); free((yyvsp[-1].name));
+                                      graph_builder_add_edge(builder,(yyvsp[-2].node),(yyvsp[-1].node));
                                     }
-#line 1326 "src/parser/Parser.c"
+#line 1293 "src/parser/Parser.c"
+    break;
+
+  case 45: /* edge_stmt: subgraph edgerhs attr_list  */
+#line 179 "src/parser/Parser.y"
+                                    { graph_builder_drop_attrs(builder); }
+#line 1299 "src/parser/Parser.c"
     break;
 
   case 46: /* edgerhs: edgeop node_id  */
-#line 195 "src/parser/Parser.y"
+#line 182 "src/parser/Parser.y"
                                 { //printf("edge end seen\n");
-                                  (yyval.name) = (yyvsp[0].name);
+                                  (yyval.node) = (yyvsp[0].node);
                                 }
-#line 1334 "src/parser/Parser.c"
+#line 1307 "src/parser/Parser.c"
     break;
 
   case 47: /* edgerhs: edgeop node_id edgerhs  */
-#line 198 "src/parser/Parser.y"
+#line 185 "src/parser/Parser.y"
                                 {
-                                  graph->edges = addEdge((yyvsp[-1].name),(yyvsp[0].name),graph->edges,NULL);
-                                  free((yyvsp[0].name));
-                                  (yyval.name) = (yyvsp[-1].name);
+                                  graph_builder_add_edge(builder,(yyvsp[-1].node),(yyvsp[0].node));
+                                  (yyval.node) = (yyvsp[-1].node);
                                 }
-#line 1344 "src/parser/Parser.c"
+#line 1316 "src/parser/Parser.c"
     break;
 
 
-#line 1348 "src/parser/Parser.c"
+#line 1320 "src/parser/Parser.c"
 
       default: break;
     }
@@ -1391,7 +1363,7 @@ yyerrlab:
   if (!yyerrstatus)
     {
       ++yynerrs;
-      yyerror (graph, scanner, YY_("syntax error"));
+      yyerror (builder, scanner, YY_("syntax error"));
     }
 
   if (yyerrstatus == 3)
@@ -1408,7 +1380,7 @@ yyerrlab:
       else
         {
           yydestruct ("Error: discarding",
-                      yytoken, &yylval, graph, scanner);
+                      yytoken, &yylval, builder, scanner);
           yychar = YYEMPTY;
         }
     }
@@ -1464,7 +1436,7 @@ yyerrlab1:
 
 
       yydestruct ("Error: popping",
-                  YY_ACCESSING_SYMBOL (yystate), yyvsp, graph, scanner);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, builder, scanner);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
@@ -1502,7 +1474,7 @@ yyabortlab:
 | yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
 `-----------------------------------------------------------*/
 yyexhaustedlab:
-  yyerror (graph, scanner, YY_("memory exhausted"));
+  yyerror (builder, scanner, YY_("memory exhausted"));
   yyresult = 2;
   goto yyreturnlab;
 
@@ -1517,7 +1489,7 @@ yyreturnlab:
          user semantic actions for why this is necessary.  */
       yytoken = YYTRANSLATE (yychar);
       yydestruct ("Cleanup: discarding lookahead",
-                  yytoken, &yylval, graph, scanner);
+                  yytoken, &yylval, builder, scanner);
     }
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYABORT or YYACCEPT.  */
@@ -1526,7 +1498,7 @@ yyreturnlab:
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, graph, scanner);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, builder, scanner);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
@@ -1537,7 +1509,7 @@ yyreturnlab:
   return yyresult;
 }
 
-#line 214 "src/parser/Parser.y"
+#line 200 "src/parser/Parser.y"
 
 
 #include <stdio.h>
@@ -1547,8 +1519,6 @@ yyreturnlab:
 #include <fcntl.h>
 #include <errno.h>
 
-extern int column;
-//extern FILE *yyin; //remove for version 3.0.4 and g++ v6.3.0
 
 /*int yyerror(char *s)
 {
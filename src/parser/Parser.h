@@ -45,14 +45,12 @@
 extern int yydebug;
 #endif
 /* "%code requires" blocks.  */
-#line 29 "src/parser/Parser.y"
+#line 33 "src/parser/Parser.y"
 
   typedef void* yyscan_t;
-  typedef struct {
-      parameterList* parameters;
-  } parameterInformation;
+  #include "GraphBuilder.h"
 
-#line 56 "src/parser/Parser.h"
+#line 54 "src/parser/Parser.h"
 
 /* Token kinds.  */
 #ifndef YYTOKENTYPE
@@ -92,12 +90,12 @@ extern int yydebug;
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
 union YYSTYPE
 {
-#line 47 "src/parser/Parser.y"
+#line 49 "src/parser/Parser.y"
 
-    char* name;
-    parameterInformation parameterInfo;
+    const char* name; /* interned in graph_builder_strings(builder), never freed by the actions. */
+    int node;         /* a node of the builder. */
 
-#line 101 "src/parser/Parser.h"
+#line 99 "src/parser/Parser.h"
 
 };
 typedef union YYSTYPE YYSTYPE;
@@ -108,7 +106,7 @@ typedef union YYSTYPE YYSTYPE;
 
 
 
-int yyparse (GraphList *graph, yyscan_t scanner);
+int yyparse (GraphBuilder builder, yyscan_t scanner);
 
 
 #endif /* !YY_YY_SRC_PARSER_PARSER_H_INCLUDED  */
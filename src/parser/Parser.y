@@ -3,7 +3,7 @@
  * @file Parser.l
  * @author Vincent Penelle (vincent.penelle@u-bordeaux.fr)
  * @brief  Parser for a graphviz parser, intended to serve for a master's project at University of Bordeaux. Adapted from gvizparse by Nikolaos Kavvadias (https://github.com/nkkav/gvizparse v1.0.0).
- *         Convert a .dot file into a GraphList structure.
+ *         Convert a .dot file into a Graph, through a GraphBuilder.
            Does not support subgraphs for now.
            This version supports automata with custom syntax (nodes are declared initial (resp. final) with an option of the form "[initial=N]" (resp. "[final=N]"), with N standing for any string), and stores the color of the node (if any).
  * @version 2
@@ -13,12 +13,16 @@
  * 
  */
  
-#include "GraphList.h"
+#include "GraphBuilder.h"
 #include "Parser.h"
 #include "Lexer.h"
 #include "Graph.h"
+#include "DotScanner.h"
 
-int yyerror(GraphList *expression, yyscan_t scanner, const char *msg) {
+/* The scanner given to yyparse is a DotInput, which reads either a mapped file or a flex scanner. */
+#define yylex dot_input_lex
+
+int yyerror(GraphBuilder builder, yyscan_t scanner, const char *msg) {
     /* Add error handling routine as needed */
     printf("Erreur: %s\n",msg);
     return 0;
@@ -28,9 +32,7 @@ int yyerror(GraphList *expression, yyscan_t scanner, const char *msg) {
 
 %code requires {
   typedef void* yyscan_t;
-  typedef struct {
-      parameterList* parameters;
-  } parameterInformation;
+  #include "GraphBuilder.h"
 }
 
 /* for normal Make.
@@ -40,13 +42,13 @@ int yyerror(GraphList *expression, yyscan_t scanner, const char *msg) {
  
 %define api.pure
 %lex-param   { yyscan_t scanner }
-%parse-param { GraphList *graph }
+%parse-param { GraphBuilder builder }
 %parse-param { yyscan_t scanner }
 
 
 %union {
-    char* name;
-    parameterInformation parameterInfo;
+    const char* name; /* interned in graph_builder_strings(builder), never freed by the actions. */
+    int node;         /* a node of the builder. */
 }
 
 
@@ -76,11 +78,9 @@ int yyerror(GraphList *expression, yyscan_t scanner, const char *msg) {
 /*declare non-terminal symbols here.*/
 //%type <expression> edgeDescription
 
-%type <name> node_id;
-%type <name> edgerhs;
-%type <parameterInfo> attr_assignment;
-%type <parameterInfo> a_list;
-%type <parameterInfo> attr_list;
+/* Attributes are pending in the builder once their list is read: node and edge statements attach them, the other statements drop them. */
+%type <node> node_id;
+%type <node> edgerhs;
 %type <name> idrhs;
 
 
@@ -88,15 +88,15 @@ int yyerror(GraphList *expression, yyscan_t scanner, const char *msg) {
  
 %%
  
-input : strict graph_type idrhs T_LBRACE stmt_list T_RBRACE {graph->name = $3;}
+input : strict graph_type idrhs T_LBRACE stmt_list T_RBRACE {graph_builder_set_name(builder,$3);}
     ;
 
 strict : /* empty */ 
     | T_STRICT
     ;
 
-graph_type : T_DIGRAPH  { graph->directed = true;}
-    | T_GRAPH           { graph->directed = false;}
+graph_type : T_DIGRAPH  { graph_builder_set_directed(builder,true);}
+    | T_GRAPH           { graph_builder_set_directed(builder,false);}
     ;
 
 stmt_list	:	stmt_list1
@@ -114,56 +114,45 @@ stmt1 : attr_stmt
     | node_stmt
     | edge_stmt
     | subgraph
-    | attr_assignment
+    | attr_assignment       { graph_builder_drop_attrs(builder); }
     ;
 
-attr_stmt : T_GRAPH attr_list
-    | T_NODE attr_list
-    | T_EDGE attr_list
+attr_stmt : T_GRAPH attr_list   { graph_builder_drop_attrs(builder); }
+    | T_NODE attr_list          { graph_builder_drop_attrs(builder); }
+    | T_EDGE attr_list          { graph_builder_drop_attrs(builder); }
     ;
 
-attr_list : T_LBRACKET a_list T_RBRACKET        { $$ = $2; }
-    | T_LBRACKET T_RBRACKET                     { $$.parameters=NULL;}
-    | T_LBRACKET a_list T_RBRACKET attr_list    { 
-                                                $$.parameters = parameter_lists_merge($2.parameters,$4.parameters);
-                                                }
-    | T_LBRACKET T_RBRACKET attr_list           { $$ = $3; }
+attr_list : T_LBRACKET a_list T_RBRACKET
+    | T_LBRACKET T_RBRACKET
+    | T_LBRACKET a_list T_RBRACKET attr_list
+    | T_LBRACKET T_RBRACKET attr_list
     ;
 
-a_list : attr_assignment                { $$ = $1;}
-    | attr_assignment T_COMMA a_list    { 
-                                            $$.parameters = parameter_lists_merge($1.parameters,$3.parameters);
-                                          }
-    | attr_assignment a_list            { 
-                                            $$.parameters = parameter_lists_merge($1.parameters,$2.parameters);
-                                          }
+a_list : attr_assignment
+    | attr_assignment T_COMMA a_list
+    | attr_assignment a_list
     ;
 
 attr_assignment : idrhs T_EQ idrhs   { 
-      $$.parameters = parameter_list_add_parameter(NULL,$1,$3);
-             free($1); free($3);}
+      graph_builder_add_attr(builder,$1,$3);
+             }
     ;
 								
-idrhs : T_ID        { $$ = (char*)malloc((strlen($1)+1)*sizeof(char)); strcpy($$,$1);
-                    }
-    | T_STRING      { $$ = (char*)malloc((strlen($1)+1)*sizeof(char)); strcpy($$,$1);
-                    }
+idrhs : T_ID        { $$ = $1; }
+    | T_STRING      { $$ = $1; }
 		;        
 
-node_stmt : node_id         { free($1); }
+node_stmt : node_id
     | node_id attr_list     {   
-                                add_parameters_to_node($1,$2.parameters,graph->nodes);
-                                free($1);
+                                graph_builder_attach_attrs(builder,$1);
                             }
     ;
 
 node_id : T_ID      { 
-                      $$ = (char*)malloc((strlen($1)+1)*sizeof(char)); strcpy($$,$1);
-                      if(graph->nodes == NULL) graph->nodes = addNode($1,NULL); else addOrUpdateNode($1,graph->nodes);
+                      $$ = graph_builder_add_node(builder,$1);
                     }
     | T_ID port     { 
-                      $$ = (char*)malloc((strlen($1)+1)*sizeof(char)); strcpy($$,$1);
-                      if(graph->nodes == NULL) graph->nodes = addNode($1,NULL); else addOrUpdateNode($1,graph->nodes);
+                      $$ = graph_builder_add_node(builder,$1);
                     }
     ;
 
@@ -181,23 +170,20 @@ port_angle : T_AT T_ID
     ;
 
 edge_stmt : node_id edgerhs         { //printf("edge seen: (%s,%s)\n",$1,$2);
-                                      graph->edges = addEdge($1,$2,graph->edges,NULL);
-                                      free($1); free($2);
+                                      graph_builder_add_edge(builder,$1,$2);
                                     }
     | node_id edgerhs attr_list     { //printf("edge seen: (%s,%s)\n",$1,$2);
-                                      graph->edges = addEdge($1,$2,graph->edges,$3.parameters);
-                                      free($1); free($2);
+                                      graph_builder_add_edge(builder,$1,$2);
                                     }
     | subgraph edgerhs 
-    | subgraph edgerhs attr_list 
+    | subgraph edgerhs attr_list    { graph_builder_drop_attrs(builder); }
     ;
 
 edgerhs : edgeop node_id        { //printf("edge end seen\n");
                                   $$ = $2;
                                 }
     | edgeop node_id edgerhs    {
-                                  graph->edges = addEdge($2,$3,graph->edges,NULL);
-                                  free($3);
+                                  graph_builder_add_edge(builder,$2,$3);
                                   $$ = $2;
                                 }
     ;
@@ -220,8 +206,6 @@ edgeop   : T_UEDGE
 #include <fcntl.h>
 #include <errno.h>
 
-extern int column;
-//extern FILE *yyin; //remove for version 3.0.4 and g++ v6.3.0
 
 /*int yyerror(char *s)
 {
@@ -0,0 +1,91 @@
+/**
+ * @file DotScanner.h
+ * @brief Hand-written scanner for the graphviz format, working on a memory buffer (usually a memory-mapped file).
+ *        It recognises exactly the tokens of Lexer.l, but returns them as slices (offset, length) of the buffer instead of copying them, so that the parser only copies the identifiers it keeps, once, in a StringPool.
+ *        The parser reads its tokens through a DotInput, which uses either this scanner or the flex lexer (for inputs that cannot be mapped).
+ * @version 1
+ * @date 2026-10-18
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef COCA_DOTSCANNER_H_
+#define COCA_DOTSCANNER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "GraphBuilder.h"
+#include "Parser.h"
+#include "StringPool.h"
+
+/**
+ * @brief A scanner over a buffer of characters.
+ *
+ */
+typedef struct
+{
+    const char *data; ///< The characters to scan.
+    size_t size;      ///< Their number.
+    size_t offset;    ///< Position of the next character to scan.
+    bool mapped;      ///< True if data is a mapping of a file, to unmap on release.
+} DotScanner;
+
+/**
+ * @brief Initialises @p scanner to scan the @p size characters of @p data (which are not copied).
+ *
+ * @param scanner A scanner.
+ * @param data The characters.
+ * @param size Their number.
+ */
+void dot_scanner_init(DotScanner *scanner, const char *data, size_t size);
+
+/**
+ * @brief Maps the file @p path in memory and initialises @p scanner to scan it.
+ *
+ * @param scanner A scanner.
+ * @param path The name of a file.
+ * @return true If the file has been mapped.
+ * @return false If the file cannot be opened or mapped (for instance if it is empty or is not a regular file). @p scanner is then left unchanged.
+ */
+bool dot_scanner_map_file(DotScanner *scanner, const char *path);
+
+/**
+ * @brief Releases the mapping of @p scanner, if any.
+ *
+ * @param scanner A scanner.
+ */
+void dot_scanner_release(DotScanner *scanner);
+
+/**
+ * @brief Scans the next token. Characters that start no token are echoed on the standard output and skipped, as flex does.
+ *
+ * @param scanner A scanner.
+ * @param start Filled with the offset of the token in the buffer.
+ * @param length Filled with the length of the token.
+ * @return int The token (one of the T_ tokens of the parser), or 0 at the end of the buffer.
+ */
+int dot_scanner_next(DotScanner *scanner, size_t *start, size_t *length);
+
+/**
+ * @brief Source of the tokens of the parser: either a DotScanner, or a flex scanner if flex is not NULL.
+ *        Identifiers and strings are interned in strings in both cases.
+ *
+ */
+typedef struct
+{
+    yyscan_t flex;      ///< A flex scanner whose extra data is strings, or NULL to use scanner.
+    DotScanner scanner; ///< The scanner used if flex is NULL.
+    StringPool strings; ///< The pool in which identifiers and strings are interned.
+} DotInput;
+
+/**
+ * @brief The lexing function called by the parser.
+ *
+ * @param value Filled with the interned name of identifiers and strings.
+ * @param input A DotInput.
+ * @return int The next token, or 0 at the end of the input.
+ */
+int dot_input_lex(YYSTYPE *value, yyscan_t input);
+
+#endif
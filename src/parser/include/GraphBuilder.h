@@ -0,0 +1,106 @@
+/**
+ * @file GraphBuilder.h
+ * @brief Streaming construction of a Graph. The parser adds nodes, edges and attributes as it reads them; they are appended to growable arrays, and the final Graph (with its edges in compressed sparse rows) is built in one step at the end.
+ *        Attributes are added before the element they belong to is known (the parser reads the attribute list of a statement after its nodes): they stay pending until they are attached to a node, consumed by the next edge, or dropped.
+ * @version 1
+ * @date 2026-10-18
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef COCA_GRAPHBUILDER_H_
+#define COCA_GRAPHBUILDER_H_
+
+#include <stdbool.h>
+#include "Graph.h"
+#include "StringPool.h"
+
+/**
+ * @brief A graph under construction. This is an opaque pointer.
+ *
+ */
+typedef struct GraphBuilder_s *GraphBuilder;
+
+/**
+ * @brief Creates an empty builder (of an undirected graph without name).
+ *
+ * @return GraphBuilder The builder.
+ */
+GraphBuilder graph_builder_create(void);
+
+/**
+ * @brief Returns the pool in which the names given to @p builder must be interned (nodes are identified by the pointer of their name).
+ *
+ * @param builder A builder.
+ * @return StringPool Its pool (in the arena of the future graph).
+ */
+StringPool graph_builder_strings(GraphBuilder builder);
+
+/**
+ * @brief Sets the name of the graph.
+ *
+ * @param builder A builder.
+ * @param name The name (copied in the graph).
+ */
+void graph_builder_set_name(GraphBuilder builder, const char *name);
+
+/**
+ * @brief Sets whether the graph is directed. Edges of undirected graphs are stored in both directions.
+ *
+ * @param builder A builder.
+ * @param directed True for a directed graph.
+ */
+void graph_builder_set_directed(GraphBuilder builder, bool directed);
+
+/**
+ * @brief Adds the node @p name if it is not already present. Nodes are numbered in the order of their first addition.
+ *
+ * @param builder A builder.
+ * @param name The name of the node, interned in graph_builder_strings(@p builder).
+ * @return int The number of the node.
+ */
+int graph_builder_add_node(GraphBuilder builder, const char *name);
+
+/**
+ * @brief Adds the pending attribute @p key = @p value.
+ *
+ * @param builder A builder.
+ * @param key The key, interned in graph_builder_strings(@p builder).
+ * @param value The value, interned in graph_builder_strings(@p builder).
+ */
+void graph_builder_add_attr(GraphBuilder builder, const char *key, const char *value);
+
+/**
+ * @brief Attaches the pending attributes to @p node, after those it already has.
+ *
+ * @param builder A builder.
+ * @param node A node returned by graph_builder_add_node.
+ */
+void graph_builder_attach_attrs(GraphBuilder builder, int node);
+
+/**
+ * @brief Forgets the pending attributes.
+ *
+ * @param builder A builder.
+ */
+void graph_builder_drop_attrs(GraphBuilder builder);
+
+/**
+ * @brief Adds the edge (@p source, @p target), with the pending attributes. If the edge is added several times, its attributes are concatenated.
+ *
+ * @param builder A builder.
+ * @param source A node returned by graph_builder_add_node.
+ * @param target A node returned by graph_builder_add_node.
+ */
+void graph_builder_add_edge(GraphBuilder builder, int source, int target);
+
+/**
+ * @brief Builds the Graph described by @p builder, and frees @p builder. The graph is allocated in the arena of @p builder, which already holds its strings.
+ *
+ * @param builder A builder.
+ * @return Graph The graph.
+ */
+Graph graph_builder_finish(GraphBuilder builder);
+
+#endif
@@ -0,0 +1,216 @@
+#include "DotScanner.h"
+#include "Lexer.h"
+#include <stdio.h>
+#include <strings.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * @brief The keywords of the format (case insensitive).
+ *
+ */
+static const struct
+{
+    const char *word;
+    size_t length;
+    int token;
+} dot_keywords[] = {
+    {"digraph", 7, T_DIGRAPH},
+    {"graph", 5, T_GRAPH},
+    {"subgraph", 8, T_SUBGRAPH},
+    {"at", 2, T_AT},
+    {"strict", 6, T_STRICT},
+    {"node", 4, T_NODE},
+    {"edge", 4, T_EDGE}};
+
+#define NumDotKeywords (sizeof(dot_keywords) / sizeof(dot_keywords[0]))
+
+static bool is_name_start(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static bool is_name_char(char c)
+{
+    return is_name_start(c) || c == '.';
+}
+
+/**
+ * @brief Returns the offset just after the string starting at @p start (on a double quote), or 0 if it is not terminated.
+ *
+ */
+static size_t scan_string(const char *data, size_t size, size_t start)
+{
+    size_t i = start + 1;
+    while (i < size)
+    {
+        if (data[i] == '"')
+            return i + 1;
+        if (data[i] == '\\')
+        {
+            // as in Lexer.l, an escaped character cannot be a newline.
+            if (i + 1 >= size || data[i + 1] == '\n')
+                return 0;
+            i += 2;
+        }
+        else
+            i++;
+    }
+    return 0;
+}
+
+void dot_scanner_init(DotScanner *scanner, const char *data, size_t size)
+{
+    scanner->data = data;
+    scanner->size = size;
+    scanner->offset = 0;
+    scanner->mapped = false;
+}
+
+bool dot_scanner_map_file(DotScanner *scanner, const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat status;
+    if (fstat(fd, &status) != 0 || !S_ISREG(status.st_mode) || status.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+    void *data = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+    madvise(data, status.st_size, MADV_SEQUENTIAL);
+    dot_scanner_init(scanner, (const char *)data, status.st_size);
+    scanner->mapped = true;
+    return true;
+}
+
+void dot_scanner_release(DotScanner *scanner)
+{
+    if (scanner->mapped)
+        munmap((void *)scanner->data, scanner->size);
+    scanner->data = NULL;
+    scanner->size = 0;
+    scanner->mapped = false;
+}
+
+int dot_scanner_next(DotScanner *scanner, size_t *start, size_t *length)
+{
+    const char *data = scanner->data;
+    size_t size = scanner->size;
+    size_t pos = scanner->offset;
+
+    while (pos < size)
+    {
+        char c = data[pos];
+        *start = pos;
+
+        if (c == ' ' || c == '\t' || c == '\n')
+        {
+            pos++;
+            continue;
+        }
+
+        if (c == '/' && pos + 1 < size && data[pos + 1] == '/')
+        {
+            while (pos < size && data[pos] != '\n')
+                pos++;
+            continue;
+        }
+
+        if (is_name_start(c))
+        {
+            size_t end = pos + 1;
+            while (end < size && is_name_char(data[end]))
+                end++;
+            *length = end - pos;
+            scanner->offset = end;
+            for (size_t k = 0; k < NumDotKeywords; k++)
+                if (dot_keywords[k].length == *length && strncasecmp(dot_keywords[k].word, data + pos, *length) == 0)
+                    return dot_keywords[k].token;
+            return T_ID;
+        }
+
+        if (c == '"')
+        {
+            size_t end = scan_string(data, size, pos);
+            if (end != 0)
+            {
+                *length = end - pos;
+                scanner->offset = end;
+                return T_STRING;
+            }
+        }
+
+        if (c == '-' && pos + 1 < size && (data[pos + 1] == '>' || data[pos + 1] == '-'))
+        {
+            *length = 2;
+            scanner->offset = pos + 2;
+            return data[pos + 1] == '>' ? T_DEDGE : T_UEDGE;
+        }
+
+        int token = 0;
+        switch (c)
+        {
+        case '[':
+            token = T_LBRACKET;
+            break;
+        case ']':
+            token = T_RBRACKET;
+            break;
+        case '(':
+            token = T_LPAREN;
+            break;
+        case ')':
+            token = T_RPAREN;
+            break;
+        case '{':
+            token = T_LBRACE;
+            break;
+        case '}':
+            token = T_RBRACE;
+            break;
+        case ',':
+            token = T_COMMA;
+            break;
+        case ':':
+            token = T_COLON;
+            break;
+        case ';':
+            token = T_SEMI;
+            break;
+        case '=':
+            token = T_EQ;
+            break;
+        default:
+            // no rule matches: flex echoes the character.
+            putchar(c);
+            pos++;
+            continue;
+        }
+        *length = 1;
+        scanner->offset = pos + 1;
+        return token;
+    }
+
+    scanner->offset = pos;
+    return 0;
+}
+
+int dot_input_lex(YYSTYPE *value, yyscan_t input)
+{
+    DotInput *source = (DotInput *)input;
+    if (source->flex != NULL)
+        return yylex(value, source->flex);
+
+    size_t start, length;
+    int token = dot_scanner_next(&source->scanner, &start, &length);
+    if (token == T_ID || token == T_STRING)
+        value->name = string_pool_intern(source->strings, source->scanner.data + start, length);
+    return token;
+}
@@ -0,0 +1,280 @@
+#include "GraphBuilder.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Makes room for one more element of type @p type in @p array, which holds @p count elements out of @p capacity.
+ *
+ */
+#define BuilderReserve(array, count, capacity, type)                              \
+    do                                                                            \
+    {                                                                             \
+        if ((count) == (capacity))                                                \
+        {                                                                         \
+            (capacity) = (capacity) == 0 ? 64 : 2 * (capacity);                   \
+            (array) = (type *)realloc((array), (capacity) * sizeof(type));        \
+        }                                                                         \
+    } while (0)
+
+/**
+ * @brief An attribute. Owner is a node number, or -1 while the attribute is pending or attached to an edge.
+ *
+ */
+typedef struct
+{
+    const char *key;   ///< The key of the attribute.
+    const char *value; ///< Its value.
+    int owner;         ///< The node having this attribute (-1 if none).
+} builder_attr;
+
+/**
+ * @brief An edge, with the range of its attributes.
+ *
+ */
+typedef struct
+{
+    int source;     ///< The source of the edge.
+    int target;     ///< The target of the edge.
+    int attr_first; ///< Its first attribute.
+    int attr_count; ///< Its number of attributes.
+} builder_edge;
+
+struct GraphBuilder_s
+{
+    Arena arena;        ///< The arena of the graph (which holds strings).
+    StringPool strings; ///< The pool of the names.
+    const char *name;   ///< The name of the graph.
+    bool directed;      ///< True if the graph is directed.
+
+    const char **nodes; ///< Names of the nodes.
+    int num_nodes;      ///< Number of nodes.
+    int nodes_capacity; ///< Size of nodes.
+
+    int *node_table;     ///< Open addressing table from names to nodes (-1 for empty slots).
+    int table_capacity;  ///< Size of node_table (a power of 2).
+
+    builder_edge *edges; ///< The edges, in the order they were added.
+    int num_edges;       ///< Number of edges.
+    int edges_capacity;  ///< Size of edges.
+
+    builder_attr *attrs; ///< The attributes, in the order they were added.
+    int num_attrs;       ///< Number of attributes.
+    int attrs_capacity;  ///< Size of attrs.
+    int pending;         ///< First pending attribute (attributes from pending to num_attrs-1 are pending).
+};
+
+/**
+ * @brief Returns the slot of @p name in the node table of @p builder (either its slot, or the empty slot where it should be).
+ *
+ */
+static int node_slot(GraphBuilder builder, const char *name)
+{
+    uintptr_t hash = (uintptr_t)name;
+    hash ^= hash >> 17;
+    hash *= 0x9E3779B1u;
+    int mask = builder->table_capacity - 1;
+    int slot = (int)(hash & mask);
+    while (builder->node_table[slot] != -1 && builder->nodes[builder->node_table[slot]] != name)
+        slot = (slot + 1) & mask;
+    return slot;
+}
+
+/**
+ * @brief Doubles the size of the node table of @p builder.
+ *
+ */
+static void grow_node_table(GraphBuilder builder)
+{
+    free(builder->node_table);
+    builder->table_capacity *= 2;
+    builder->node_table = (int *)malloc(builder->table_capacity * sizeof(int));
+    memset(builder->node_table, -1, builder->table_capacity * sizeof(int));
+    for (int node = 0; node < builder->num_nodes; node++)
+        builder->node_table[node_slot(builder, builder->nodes[node])] = node;
+}
+
+GraphBuilder graph_builder_create(void)
+{
+    GraphBuilder builder = (GraphBuilder)calloc(1, sizeof(struct GraphBuilder_s));
+    builder->arena = arena_create();
+    builder->strings = string_pool_create_in(builder->arena);
+    builder->table_capacity = 1024;
+    builder->node_table = (int *)malloc(builder->table_capacity * sizeof(int));
+    memset(builder->node_table, -1, builder->table_capacity * sizeof(int));
+    return builder;
+}
+
+StringPool graph_builder_strings(GraphBuilder builder)
+{
+    return builder->strings;
+}
+
+void graph_builder_set_name(GraphBuilder builder, const char *name)
+{
+    builder->name = name;
+}
+
+void graph_builder_set_directed(GraphBuilder builder, bool directed)
+{
+    builder->directed = directed;
+}
+
+int graph_builder_add_node(GraphBuilder builder, const char *name)
+{
+    int slot = node_slot(builder, name);
+    if (builder->node_table[slot] != -1)
+        return builder->node_table[slot];
+
+    BuilderReserve(builder->nodes, builder->num_nodes, builder->nodes_capacity, const char *);
+    int node = builder->num_nodes++;
+    builder->nodes[node] = name;
+    builder->node_table[slot] = node;
+    if (2 * builder->num_nodes > builder->table_capacity)
+        grow_node_table(builder);
+    return node;
+}
+
+void graph_builder_add_attr(GraphBuilder builder, const char *key, const char *value)
+{
+    BuilderReserve(builder->attrs, builder->num_attrs, builder->attrs_capacity, builder_attr);
+    builder_attr *attr = &builder->attrs[builder->num_attrs++];
+    attr->key = key;
+    attr->value = value;
+    attr->owner = -1;
+}
+
+void graph_builder_attach_attrs(GraphBuilder builder, int node)
+{
+    for (int attr = builder->pending; attr < builder->num_attrs; attr++)
+        builder->attrs[attr].owner = node;
+    builder->pending = builder->num_attrs;
+}
+
+void graph_builder_drop_attrs(GraphBuilder builder)
+{
+    builder->num_attrs = builder->pending;
+}
+
+void graph_builder_add_edge(GraphBuilder builder, int source, int target)
+{
+    BuilderReserve(builder->edges, builder->num_edges, builder->edges_capacity, builder_edge);
+    builder_edge *edge = &builder->edges[builder->num_edges++];
+    edge->source = source;
+    edge->target = target;
+    edge->attr_first = builder->pending;
+    edge->attr_count = builder->num_attrs - builder->pending;
+    builder->pending = builder->num_attrs;
+}
+
+/**
+ * @brief An edge in one direction, as sorted in the rows of the graph.
+ *
+ */
+typedef struct
+{
+    int target; ///< The target.
+    int edge;   ///< The number of the edge in the builder.
+} builder_arc;
+
+static int compare_arcs(const void *first, const void *second)
+{
+    const builder_arc *a = (const builder_arc *)first, *b = (const builder_arc *)second;
+    if (a->target != b->target)
+        return a->target < b->target ? -1 : 1;
+    return a->edge < b->edge ? -1 : (a->edge > b->edge);
+}
+
+Graph graph_builder_finish(GraphBuilder builder)
+{
+    Graph graph;
+    Arena arena = builder->arena;
+    int num_nodes = builder->num_nodes;
+    graph.arena = arena;
+    // the names are interned in the arena, and the graph is never modified: they are used as they are.
+    graph.name = (char *)builder->name;
+    graph.numNodes = num_nodes;
+    graph.nodes = (char **)arena_memdup(arena, builder->nodes, num_nodes * sizeof(char *));
+
+    // attributes of the nodes, grouped by node (counting sort, keeping their order).
+    graph.strings = builder->strings;
+    graph.attributeOffsets = (int *)arena_calloc(arena, (num_nodes + 1) * sizeof(int));
+    for (int attr = 0; attr < builder->num_attrs; attr++)
+        if (builder->attrs[attr].owner >= 0)
+            graph.attributeOffsets[builder->attrs[attr].owner + 1]++;
+    for (int node = 0; node < num_nodes; node++)
+        graph.attributeOffsets[node + 1] += graph.attributeOffsets[node];
+    graph.attributes = (graphAttribute *)arena_alloc(arena, graph.attributeOffsets[num_nodes] * sizeof(graphAttribute));
+    int *fill = (int *)malloc((num_nodes + 1) * sizeof(int));
+    memcpy(fill, graph.attributeOffsets, (num_nodes + 1) * sizeof(int));
+    for (int attr = 0; attr < builder->num_attrs; attr++)
+    {
+        builder_attr *a = &builder->attrs[attr];
+        if (a->owner >= 0)
+            graph.attributes[fill[a->owner]++] = (graphAttribute){a->key, a->value};
+    }
+
+    // arcs of each edge, sorted by source (counting sort), then by target and order of addition in each row.
+    int *offsets = (int *)calloc(num_nodes + 1, sizeof(int));
+    for (int edge = 0; edge < builder->num_edges; edge++)
+    {
+        builder_edge *e = &builder->edges[edge];
+        offsets[e->source + 1]++;
+        if (!builder->directed && e->source != e->target)
+            offsets[e->target + 1]++;
+    }
+    for (int node = 0; node < num_nodes; node++)
+        offsets[node + 1] += offsets[node];
+    int num_arcs = offsets[num_nodes];
+    builder_arc *arcs = (builder_arc *)malloc(num_arcs * sizeof(builder_arc));
+    memcpy(fill, offsets, (num_nodes + 1) * sizeof(int));
+    for (int edge = 0; edge < builder->num_edges; edge++)
+    {
+        builder_edge *e = &builder->edges[edge];
+        arcs[fill[e->source]++] = (builder_arc){e->target, edge};
+        if (!builder->directed && e->source != e->target)
+            arcs[fill[e->target]++] = (builder_arc){e->source, edge};
+    }
+    free(fill);
+
+    // duplicated edges are merged into one arc, whose attributes are those of all its copies.
+    graph.edgeOffsets = (int *)arena_alloc(arena, (num_nodes + 1) * sizeof(int));
+    graph.successors = (int *)arena_alloc(arena, num_arcs * sizeof(int));
+    graph.edgeAttributeOffsets = (int *)arena_alloc(arena, (num_arcs + 1) * sizeof(int));
+    int num_edge_attrs = 0;
+    for (int i = 0; i < num_arcs; i++)
+        num_edge_attrs += builder->edges[arcs[i].edge].attr_count;
+    graph.edgeAttributes = (graphAttribute *)arena_alloc(arena, num_edge_attrs * sizeof(graphAttribute));
+    int arc = 0, edge_attr = 0;
+    graph.numEdges = 0;
+    for (int node = 0; node < num_nodes; node++)
+    {
+        graph.edgeOffsets[node] = arc;
+        qsort(arcs + offsets[node], offsets[node + 1] - offsets[node], sizeof(builder_arc), compare_arcs);
+        for (int i = offsets[node]; i < offsets[node + 1]; i++)
+        {
+            if (i == offsets[node] || arcs[i].target != arcs[i - 1].target)
+            {
+                graph.successors[arc] = arcs[i].target;
+                graph.edgeAttributeOffsets[arc] = edge_attr;
+                if (builder->directed || node <= arcs[i].target)
+                    graph.numEdges++;
+                arc++;
+            }
+            builder_edge *e = &builder->edges[arcs[i].edge];
+            for (int attr = e->attr_first; attr < e->attr_first + e->attr_count; attr++)
+                graph.edgeAttributes[edge_attr++] = (graphAttribute){builder->attrs[attr].key, builder->attrs[attr].value};
+        }
+    }
+    graph.edgeOffsets[num_nodes] = arc;
+    graph.edgeAttributeOffsets[arc] = edge_attr;
+    free(arcs);
+    free(offsets);
+
+    free(builder->nodes);
+    free(builder->node_table);
+    free(builder->edges);
+    free(builder->attrs);
+    free(builder);
+    return graph;
+}
@@ -1,100 +1,171 @@
 #include "Parsing.h"
 #include "Parser.h"
 #include "Lexer.h"
-#include "GraphListToGraph.h"
+#include "GraphBuilder.h"
+#include "DotScanner.h"
+#include "Metrics.h"
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
 
-int yyparse(GraphList *expression, yyscan_t scanner);
+int yyparse(GraphBuilder builder, yyscan_t scanner);
 
 /**
- * @brief Parses a string and return the GraphList described by it.
- * 
- * @param expr A string in graphviz format.
- * @return GraphList The parsed GraphList.
+ * @brief Parses the tokens of @p input and builds the Graph described by them in @p builder. The strings of @p input must be interned in graph_builder_strings(@p builder).
+ *
+ * @param input The source of the tokens.
+ * @param builder An empty builder.
  */
-GraphList getGraphList(const char *expr)
+static void parseInput(DotInput *input, GraphBuilder builder)
 {
-    GraphList expression;
-    yyscan_t scanner;
-    YY_BUFFER_STATE state;
-
-    expression.nodes = NULL;
-    expression.edges = NULL;
-
-    if (yylex_init(&scanner))
-    {
-        /* could not initialize */
-        printf("Error initialization\n");
-        return expression;
-    }
-
-    state = yy_scan_string(expr, scanner);
-
-    if (yyparse(&expression, scanner))
+    if (yyparse(builder, input))
     {
         /* error parsing */
         printf("Error parsing\n");
-        return expression;
     }
+}
 
-    yy_delete_buffer(state, scanner);
+Graph get_graph_from_string(const char *expr)
+{
+    DotInput input;
+    GraphBuilder builder = graph_builder_create();
 
-    yylex_destroy(scanner);
+    input.flex = NULL;
+    input.strings = graph_builder_strings(builder);
+    dot_scanner_init(&input.scanner, expr, strlen(expr));
 
-    return expression;
+    parseInput(&input, builder);
+    return graph_builder_finish(builder);
 }
 
 /**
- * @brief Parses a file and return the GraphList described by it.
+ * @brief Parses a file with the flex lexer in @p builder. Used for the files that cannot be mapped in memory.
  * 
- * @param toRead A file in graphviz format.
- * @return GraphList The parsed GraphList.
+ * @param toRead A file in graphviz format (closed by this function).
+ * @param builder An empty builder.
  */
-GraphList getGraphListFromFile(FILE *toRead)
+static void parseStream(FILE *toRead, GraphBuilder builder)
 {
-    GraphList expression;
-    yyscan_t scanner;
+    DotInput input;
     YY_BUFFER_STATE state;
 
-    expression.nodes = NULL;
-    expression.edges = NULL;
+    input.strings = graph_builder_strings(builder);
 
-    if (yylex_init(&scanner))
+    if (yylex_init_extra(input.strings, &input.flex))
     {
         /* could not initialize */
         printf("Error initialization\n");
-        return expression;
+        fclose(toRead);
+        return;
     }
 
-    state = yy_create_buffer(toRead, YY_BUF_SIZE, scanner);
-    yy_switch_to_buffer(state, scanner);
+    state = yy_create_buffer(toRead, YY_BUF_SIZE, input.flex);
+    yy_switch_to_buffer(state, input.flex);
 
-    if (yyparse(&expression, scanner))
-    {
-        /* error parsing */
-        printf("Error parsing\n");
-        return expression;
-    }
+    parseInput(&input, builder);
 
-    yy_delete_buffer(state, scanner);
+    yy_delete_buffer(state, input.flex);
 
-    yylex_destroy(scanner);
+    yylex_destroy(input.flex);
 
     fclose(toRead);
+}
 
-    return expression;
+/**
+ * @brief Parses a file mapped in memory in @p builder.
+ * 
+ * @param toRead The name of a file in graphviz format.
+ * @param builder An empty builder.
+ * @return true If the file could be mapped (and has been parsed).
+ * @return false Otherwise (nothing is done).
+ */
+static bool parseMappedFile(char *toRead, GraphBuilder builder)
+{
+    DotInput input;
+
+    input.flex = NULL;
+    if (!dot_scanner_map_file(&input.scanner, toRead))
+        return false;
+    input.strings = graph_builder_strings(builder);
+
+    parseInput(&input, builder);
+
+    dot_scanner_release(&input.scanner);
+    return true;
 }
 
 Graph get_graph_from_file(char *toRead)
 {
-    FILE *file = fopen(toRead, "r");
-    if (file == NULL)
+    GraphBuilder builder = graph_builder_create();
+    metrics_phase_start(metrics_parse);
+    if (!parseMappedFile(toRead, builder))
     {
-        printf("file %s does not exist. Exiting.\n", toRead);
-        exit(-1);
+        FILE *file = fopen(toRead, "r");
+        if (file == NULL)
+        {
+            printf("file %s does not exist. Exiting.\n", toRead);
+            exit(-1);
+        }
+        parseStream(file, builder);
     }
-    GraphList e = getGraphListFromFile(file);
-    Graph graph = createGraph(e);
-    deleteExpression(e.edges);
-    deleteNodeList(e.nodes);
+    metrics_phase_stop(metrics_parse);
+    metrics_phase_start(metrics_create_graph);
+    Graph graph = graph_builder_finish(builder);
+    metrics_phase_stop(metrics_create_graph);
     return graph;
 }
+
+/**
+ * @brief The work shared by the threads of get_graphs_from_files.
+ *
+ */
+typedef struct
+{
+    char **toRead;   ///< The files to parse.
+    int num_files;   ///< Their number.
+    Graph *graphs;   ///< The parsed graphs.
+    atomic_int next; ///< The next file to parse.
+} parsing_work;
+
+/**
+ * @brief Parses files of @p work until there are none left.
+ *
+ * @param work A parsing_work.
+ * @return void* NULL.
+ */
+static void *parseFiles(void *work)
+{
+    parsing_work *shared = (parsing_work *)work;
+    int file;
+    while ((file = atomic_fetch_add(&shared->next, 1)) < shared->num_files)
+    {
+        if (shared->toRead[file] != NULL)
+            shared->graphs[file] = get_graph_from_file(shared->toRead[file]);
+    }
+    return NULL;
+}
+
+void get_graphs_from_files(char **toRead, int num_files, Graph *graphs, int num_threads)
+{
+    parsing_work work;
+    work.toRead = toRead;
+    work.num_files = num_files;
+    work.graphs = graphs;
+    atomic_init(&work.next, 0);
+
+    if (num_threads > num_files)
+        num_threads = num_files;
+    if (num_threads <= 1)
+    {
+        parseFiles(&work);
+        return;
+    }
+
+    pthread_t threads[num_threads - 1];
+    int started = 0;
+    while (started < num_threads - 1 && pthread_create(&threads[started], NULL, parseFiles, &work) == 0)
+        started++;
+    parseFiles(&work);
+    for (int thread = 0; thread < started; thread++)
+        pthread_join(threads[thread], NULL);
+}